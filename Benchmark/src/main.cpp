@@ -0,0 +1,353 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+/*
+Measures the time taken to load a map, and the peak memory used by the
+process while doing so. As peak memory is measured for the entire process
+each parse mode should be measured in a separate run, for example:
+
+tmxlite_benchmark --mode document map.json
+tmxlite_benchmark --mode streaming map.json
+
+Adding --mapped loads the map with tmx::enableFileMapping set, and
+--lazy loads it with tmx::Map::TileDecoding::Lazy so that tile layers
+are not decoded. --threads sets the number of threads used to decode
+tile layers and external files, where 0 uses one per hardware thread.
+The load time of each external tile set or template is printed for the
+final iteration. --cache loads external tile sets through a tmx::TilesetCache
+shared by every iteration, so that only the first iteration reads them.
+--compiled writes the map with tmx::Map::saveCompiled() first, and then
+measures loading the compiled map instead.
+
+If no map is given a large synthetic map is generated and used instead.
+*/
+
+#include <tmxlite/FreeFuncs.hpp>
+#include <tmxlite/Map.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    struct Options final
+    {
+        std::string mapPath;
+        tmx::Map::ParseMode mode = tmx::Map::ParseMode::Streaming;
+        std::size_t iterations = 5;
+        std::uint32_t generateSize = 1024;
+        bool mapped = false;
+        bool lazy = false;
+        std::size_t threads = 1;
+        bool cache = false;
+        bool compiled = false;
+    };
+
+    //returns the peak resident memory of the process in bytes
+    std::size_t getPeakMemory()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        {
+            return counters.PeakWorkingSetSize;
+        }
+        return 0;
+#else
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+        {
+            return 0;
+        }
+#ifdef __APPLE__
+        return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+        return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+    }
+
+    std::string base64Encode(const std::vector<std::uint32_t>& ids)
+    {
+        static const char chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        std::vector<unsigned char> bytes;
+        bytes.reserve(ids.size() * 4);
+        for (auto id : ids)
+        {
+            bytes.push_back(static_cast<unsigned char>(id & 0xff));
+            bytes.push_back(static_cast<unsigned char>((id >> 8) & 0xff));
+            bytes.push_back(static_cast<unsigned char>((id >> 16) & 0xff));
+            bytes.push_back(static_cast<unsigned char>((id >> 24) & 0xff));
+        }
+
+        std::string output;
+        output.reserve(((bytes.size() + 2) / 3) * 4);
+        for (auto i = 0u; i < bytes.size(); i += 3)
+        {
+            std::uint32_t block = bytes[i] << 16;
+            if (i + 1 < bytes.size()) block |= bytes[i + 1] << 8;
+            if (i + 2 < bytes.size()) block |= bytes[i + 2];
+
+            output.push_back(chars[(block >> 18) & 0x3f]);
+            output.push_back(chars[(block >> 12) & 0x3f]);
+            output.push_back(i + 1 < bytes.size() ? chars[(block >> 6) & 0x3f] : '=');
+            output.push_back(i + 2 < bytes.size() ? chars[block & 0x3f] : '=');
+        }
+        return output;
+    }
+
+    //writes a map with a CSV layer, a base64 layer and an object
+    //layer, each size x size tiles, to the given path
+    bool generateMap(const std::string& path, std::uint32_t size)
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        const std::uint32_t tileCount = 256;
+        std::uint32_t seed = 1234567;
+        auto nextID = [&seed, tileCount]()
+        {
+            seed = seed * 1103515245u + 12345u;
+            std::uint32_t id = (seed >> 8) % (tileCount + 1);
+            //flip some tiles to include the flag bits
+            if (id != 0 && (seed & 0x70000000) == 0)
+            {
+                id |= 0x80000000;
+            }
+            return id;
+        };
+
+        file << "{\"compressionlevel\":-1,\"height\":" << size << ",\"infinite\":false,\"layers\":[";
+
+        file << "{\"data\":[";
+        for (auto i = 0u; i < size * size; ++i)
+        {
+            file << (i ? "," : "") << nextID();
+        }
+        file << "],\"height\":" << size << ",\"id\":1,\"name\":\"csv\",\"opacity\":1,\"type\":\"tilelayer\","
+            << "\"visible\":true,\"width\":" << size << ",\"x\":0,\"y\":0},";
+
+        std::vector<std::uint32_t> ids(size * size);
+        std::generate(ids.begin(), ids.end(), nextID);
+        file << "{\"data\":\"" << base64Encode(ids) << "\",\"encoding\":\"base64\",\"height\":" << size
+            << ",\"id\":2,\"name\":\"base64\",\"opacity\":1,\"type\":\"tilelayer\",\"visible\":true,\"width\":"
+            << size << ",\"x\":0,\"y\":0},";
+
+        file << "{\"draworder\":\"topdown\",\"id\":3,\"name\":\"objects\",\"objects\":[";
+        for (auto i = 0u; i < size; ++i)
+        {
+            file << (i ? "," : "") << "{\"height\":16,\"id\":" << (i + 1) << ",\"name\":\"object" << i
+                << "\",\"properties\":[{\"name\":\"value\",\"type\":\"int\",\"value\":" << i << "}],"
+                << "\"rotation\":0,\"type\":\"\",\"visible\":true,\"width\":16,\"x\":" << (i * 16)
+                << ",\"y\":" << (i * 8) << "}";
+        }
+        file << "],\"opacity\":1,\"type\":\"objectgroup\",\"visible\":true,\"x\":0,\"y\":0}],";
+
+        file << "\"nextlayerid\":4,\"nextobjectid\":" << (size + 1) << ",\"orientation\":\"orthogonal\","
+            << "\"renderorder\":\"right-down\",\"tiledversion\":\"1.10.2\",\"tileheight\":16,"
+            << "\"tilesets\":[{\"columns\":16,\"firstgid\":1,\"image\":\"tiles.png\",\"imageheight\":256,"
+            << "\"imagewidth\":256,\"margin\":0,\"name\":\"tiles\",\"spacing\":0,\"tilecount\":" << tileCount
+            << ",\"tileheight\":16,\"tilewidth\":16}],\"tilewidth\":16,\"type\":\"map\",\"version\":\"1.10\","
+            << "\"width\":" << size << "}";
+
+        return file.good();
+    }
+
+    void printUsage()
+    {
+        std::cout << "Usage: tmxlite_benchmark [--mode document|streaming] [--mapped] [--lazy] [--threads n] [--cache] [--compiled] [--iterations n] [--size n] [map]\n"
+            << "If no map is given a map of size x size tiles is generated (default 1024)\n";
+    }
+
+    bool parseOptions(int argc, char** argv, Options& options)
+    {
+        for (auto i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "--mode" && i + 1 < argc)
+            {
+                std::string mode = argv[++i];
+                if (mode == "document")
+                {
+                    options.mode = tmx::Map::ParseMode::Document;
+                }
+                else if (mode == "streaming")
+                {
+                    options.mode = tmx::Map::ParseMode::Streaming;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+            else if (arg == "--mapped")
+            {
+                options.mapped = true;
+            }
+            else if (arg == "--lazy")
+            {
+                options.lazy = true;
+            }
+            else if (arg == "--threads" && i + 1 < argc)
+            {
+                options.threads = std::strtoul(argv[++i], nullptr, 10);
+            }
+            else if (arg == "--cache")
+            {
+                options.cache = true;
+            }
+            else if (arg == "--compiled")
+            {
+                options.compiled = true;
+            }
+            else if (arg == "--iterations" && i + 1 < argc)
+            {
+                options.iterations = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (arg == "--size" && i + 1 < argc)
+            {
+                options.generateSize = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (!arg.empty() && arg[0] != '-')
+            {
+                options.mapPath = arg;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage();
+        return 1;
+    }
+
+    if (options.mapPath.empty())
+    {
+        options.mapPath = "benchmark_map.json";
+        std::cout << "Generating " << options.generateSize << "x" << options.generateSize
+            << " map " << options.mapPath << "\n";
+        if (!generateMap(options.mapPath, options.generateSize))
+        {
+            std::cout << "Failed to write " << options.mapPath << "\n";
+            return 1;
+        }
+    }
+
+    if (options.compiled)
+    {
+        tmx::Map map;
+        const auto compiledPath = options.mapPath + ".tmxb";
+        if (!map.load(options.mapPath) || !map.saveCompiled(compiledPath))
+        {
+            std::cout << "Failed to compile " << options.mapPath << "\n";
+            return 1;
+        }
+        options.mapPath = compiledPath;
+    }
+
+    tmx::enableFileMapping = options.mapped;
+    tmx::TilesetCache tilesetCache;
+    const auto baseMemory = getPeakMemory();
+
+    double bestTime = 0.0;
+    double totalTime = 0.0;
+    double totalUnloadTime = 0.0;
+    std::vector<tmx::Map::ExternalFile> externalFiles;
+    for (auto i = 0u; i < options.iterations; ++i)
+    {
+        auto map = std::make_unique<tmx::Map>();
+        map->setParseMode(options.mode);
+        map->setTileDecoding(options.lazy ? tmx::Map::TileDecoding::Lazy : tmx::Map::TileDecoding::Eager);
+        map->setWorkerThreadCount(options.threads);
+        map->setTilesetCache(options.cache ? &tilesetCache : nullptr);
+
+        auto start = std::chrono::steady_clock::now();
+        bool loaded = map->load(options.mapPath);
+        auto end = std::chrono::steady_clock::now();
+
+        if (!loaded)
+        {
+            std::cout << "Failed to load " << options.mapPath << "\n";
+            return 1;
+        }
+
+        double time = std::chrono::duration<double, std::milli>(end - start).count();
+        bestTime = (i == 0) ? time : std::min(bestTime, time);
+        totalTime += time;
+
+        externalFiles = map->getExternalFiles();
+
+        start = std::chrono::steady_clock::now();
+        map.reset();
+        end = std::chrono::steady_clock::now();
+        totalUnloadTime += std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    const auto peakMemory = getPeakMemory();
+
+    std::cout << "Mode: " << (options.mode == tmx::Map::ParseMode::Document ? "document" : "streaming")
+        << (options.mapped ? " (mapped)" : "") << (options.lazy ? " (lazy)" : "")
+        << (options.cache ? " (cached tile sets)" : "") << (options.compiled ? " (compiled)" : "")
+        << ", " << options.threads << " thread(s)\n"
+        << "Load time (best): " << bestTime << "ms\n"
+        << "Load time (mean): " << (totalTime / options.iterations) << "ms\n"
+        << "Unload time (mean): " << (totalUnloadTime / options.iterations) << "ms\n"
+        << "Peak memory: " << (peakMemory / 1024) << "KB"
+        << " (" << ((peakMemory - std::min(peakMemory, baseMemory)) / 1024) << "KB above baseline)\n";
+
+    for (const auto& file : externalFiles)
+    {
+        std::cout << (file.type == tmx::Map::ExternalFile::Type::Tileset ? "Tile set " : "Template ")
+            << file.path << ": " << file.loadTime << "ms" << (file.loaded ? "" : " (failed)") << "\n";
+    }
+
+    return 0;
+}
@@ -28,6 +28,7 @@ source distribution.
 #include "MapLayer.hpp"
 
 #include <tmxlite/TileLayer.hpp>
+#include <tmxlite/UVTable.hpp>
 
 #include <iostream>
 #include <array>
@@ -63,12 +64,8 @@ bool MapLayer::create(const tmx::Map& map, std::uint32_t layerIndex, const std::
         const auto& ts = tileSets[i];
         const auto& tileIDs = layer.getTiles();
 
-        const auto texSize = textures[i]->getSize();
-        const auto tileCountX = texSize.x / mapTileSize.x;
-        const auto tileCountY = texSize.y / mapTileSize.y;
-
-        const float uNorm = static_cast<float>(mapTileSize.x) / texSize.x;
-        const float vNorm = static_cast<float>(mapTileSize.y) / texSize.y;
+        //texture coordinates of every tile, including flipped ones
+        const tmx::UVTable uvTable(ts);
 
         std::vector<SDL_Vertex> verts;
         for (auto y = 0u; y < mapSize.y; ++y)
@@ -80,15 +77,11 @@ bool MapLayer::create(const tmx::Map& map, std::uint32_t layerIndex, const std::
                     && tileIDs[idx].ID < (ts.getFirstGID() + ts.getTileCount()))
                 {
                     //tex coords
-                    auto idIndex = (tileIDs[idx].ID - ts.getFirstGID());
-                    float u = static_cast<float>(idIndex % tileCountX);
-                    float v = static_cast<float>(idIndex / tileCountY);
-                    u *= mapTileSize.x; //TODO we should be using the tile set size, as this may be different from the map's grid size
-                    v *= mapTileSize.y;
-
-                    //normalise the UV
-                    u /= textures[i]->getSize().x;
-                    v /= textures[i]->getSize().y;
+                    const auto* uv = uvTable.getQuad(tileIDs[idx].ID - ts.getFirstGID(), tileIDs[idx].flipFlags);
+                    if (!uv)
+                    {
+                        continue;
+                    }
 
                     //vert pos
                     const float tilePosX = static_cast<float>(x) * mapTileSize.x;
@@ -96,18 +89,18 @@ bool MapLayer::create(const tmx::Map& map, std::uint32_t layerIndex, const std::
 
 
                     //push back to vert array
-                    SDL_Vertex vert = { { tilePosX, tilePosY }, vertColour, {u, v} };
+                    SDL_Vertex vert = { { tilePosX, tilePosY }, vertColour, {uv[0], uv[1]} };
                     verts.emplace_back(vert);
-                    vert = { { tilePosX + mapTileSize.x, tilePosY }, vertColour, {u + uNorm, v} };
+                    vert = { { tilePosX + mapTileSize.x, tilePosY }, vertColour, {uv[2], uv[3]} };
                     verts.emplace_back(vert);
-                    vert = { { tilePosX, tilePosY + mapTileSize.y}, vertColour, {u, v + vNorm} };
+                    vert = { { tilePosX, tilePosY + mapTileSize.y}, vertColour, {uv[6], uv[7]} };
                     verts.emplace_back(vert);
                     
-                    vert = { { tilePosX, tilePosY +mapTileSize.y}, vertColour, {u, v + vNorm} };
+                    vert = { { tilePosX, tilePosY +mapTileSize.y}, vertColour, {uv[6], uv[7]} };
                     verts.emplace_back(vert);
-                    vert = { { tilePosX + mapTileSize.x, tilePosY }, vertColour, {u + uNorm, v} };
+                    vert = { { tilePosX + mapTileSize.x, tilePosY }, vertColour, {uv[2], uv[3]} };
                     verts.emplace_back(vert);
-                    vert = { { tilePosX + mapTileSize.x, tilePosY + mapTileSize.y }, vertColour, {u + uNorm, v + vNorm} };
+                    vert = { { tilePosX + mapTileSize.x, tilePosY + mapTileSize.y }, vertColour, {uv[4], uv[5]} };
                     verts.emplace_back(vert);
                 }
             }
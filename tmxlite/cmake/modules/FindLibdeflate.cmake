@@ -0,0 +1,27 @@
+#
+# - Try to find the libdeflate library
+# This will define
+# LIBDEFLATE_FOUND
+# LIBDEFLATE_INCLUDE_DIR
+# LIBDEFLATE_LIBRARY
+#
+
+find_path(LIBDEFLATE_INCLUDE_DIR NAMES libdeflate.h)
+
+find_library(LIBDEFLATE_LIBRARY_DEBUG NAMES deflated deflatestaticd)
+find_library(LIBDEFLATE_LIBRARY_RELEASE NAMES deflate deflatestatic)
+
+include(SelectLibraryConfigurations)
+SELECT_LIBRARY_CONFIGURATIONS(LIBDEFLATE)
+
+include(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(
+    LIBDEFLATE DEFAULT_MSG
+    LIBDEFLATE_LIBRARY LIBDEFLATE_INCLUDE_DIR
+)
+
+if (LIBDEFLATE_FOUND)
+    message(STATUS "Found libdeflate: ${LIBDEFLATE_LIBRARY}")
+endif()
+
+mark_as_advanced(LIBDEFLATE_INCLUDE_DIR LIBDEFLATE_LIBRARY)
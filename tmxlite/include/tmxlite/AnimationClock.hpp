@@ -0,0 +1,109 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#pragma once
+
+#include <tmxlite/Config.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tmx
+{
+    class AnimationTable;
+
+    /*!
+    \brief Plays all of the animations in an AnimationTable from a single
+    shared time.
+    Each call to update() advances the time and works out the current
+    frame of every animation at once, so that the current GID of any
+    animated tile can then be read without any further work. The table
+    must outlive the clock, and the clock must be reset() if the table
+    is rebuilt, for example by loading another map.
+    \see Map::getAnimationTable()
+    */
+    class TMXLITE_EXPORT_API AnimationClock final
+    {
+    public:
+        AnimationClock();
+        explicit AnimationClock(const AnimationTable&);
+
+        /*!
+        \brief Sets the table of animations to play, and sets the time
+        back to 0
+        */
+        void reset(const AnimationTable&);
+
+        /*!
+        \brief Advances the time by the given number of milliseconds and
+        updates the current frame of every animation
+        */
+        void update(double elapsed);
+
+        /*!
+        \brief Sets the time, in milliseconds, and updates the current
+        frame of every animation
+        */
+        void setTime(double time);
+
+        /*!
+        \brief Returns the current time in milliseconds
+        */
+        double getTime() const { return m_time; }
+
+        /*!
+        \brief Returns the GID currently shown by the tile with the given
+        GID. The GID is returned unchanged if the tile is not animated,
+        and any flip flags in it are kept.
+        */
+        std::uint32_t getGID(std::uint32_t GID) const;
+
+        /*!
+        \brief Returns the GID currently shown by each animation, in the
+        same order as AnimationTable::getAnimations()
+        */
+        const std::vector<std::uint32_t>& getCurrentGIDs() const { return m_currentGIDs; }
+
+        /*!
+        \brief Returns the indices of the animations whose frame changed
+        during the last call to update() or setTime()
+        */
+        const std::vector<std::uint32_t>& getChangedAnimations() const { return m_changed; }
+
+    private:
+        const AnimationTable* m_table;
+        double m_time;
+        std::vector<std::uint32_t> m_currentGIDs;
+        std::vector<std::uint32_t> m_changed;
+
+        //the time at which the current frame of each animation ends,
+        //before which the animation needs no update
+        std::vector<double> m_frameEnds;
+
+        //returns true if the animation's frame changed
+        bool updateAnimation(std::size_t index);
+    };
+}
@@ -0,0 +1,123 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#pragma once
+
+#include <tmxlite/Config.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tmx
+{
+    class Map;
+
+    /*!
+    \brief The tile animations of a map, stored as flat arrays.
+    Each animated GID has a range of frames in getFrameGIDs(), and the
+    time from the start of the animation at which each frame ends is
+    stored at the same index in getFrameEnds(), so the frame shown at
+    any time is found with a binary search of the range.
+    The table is built when a map is loaded and returned by
+    Map::getAnimationTable(). Use an AnimationClock to play the
+    animations.
+    \see AnimationClock
+    */
+    class TMXLITE_EXPORT_API AnimationTable final
+    {
+    public:
+        /*!
+        \brief The frames of one animated tile
+        */
+        struct Animation final
+        {
+            std::uint32_t GID = 0; //!< GID of the animated tile
+            std::uint32_t firstFrame = 0; //!< index of the first frame in getFrameGIDs() and getFrameEnds()
+            std::uint32_t frameCount = 0; //!< number of frames in the animation
+            std::uint32_t duration = 0; //!< total duration of the frames, in milliseconds
+        };
+
+        /*!
+        \brief Builds the table from the animated tiles of the given
+        map's tile sets, replacing any existing animations
+        */
+        void build(const Map&);
+
+        /*!
+        \brief Returns the animations, sorted by GID
+        */
+        const std::vector<Animation>& getAnimations() const { return m_animations; }
+
+        /*!
+        \brief Returns the GID of every frame of every animation
+        */
+        const std::vector<std::uint32_t>& getFrameGIDs() const { return m_frameGIDs; }
+
+        /*!
+        \brief Returns the time in milliseconds, from the start of its
+        animation, at which each frame ends
+        */
+        const std::vector<std::uint32_t>& getFrameEnds() const { return m_frameEnds; }
+
+        /*!
+        \brief Returns the index in getAnimations() of the animation of
+        the given GID, or -1 if the tile is not animated. Any flip flags
+        in the GID are ignored.
+        */
+        std::int32_t findAnimation(std::uint32_t GID) const;
+
+        /*!
+        \brief Returns the index in getFrameGIDs() of the frame of the
+        given animation shown at the given time, in milliseconds.
+        Animations loop, starting from a time of 0.
+        */
+        std::uint32_t getFrameIndex(const Animation&, double time) const;
+
+        /*!
+        \brief Returns the GID of the frame of the given animation shown
+        at the given time, in milliseconds. Animations loop, starting
+        from a time of 0.
+        */
+        std::uint32_t getFrameGID(const Animation&, double time) const;
+
+        /*!
+        \brief Returns the GID of the frame shown at the given time, in
+        milliseconds, by the animated tile with the given GID. The GID
+        is returned unchanged if the tile is not animated, and any flip
+        flags in it are kept.
+        */
+        std::uint32_t getFrameGID(std::uint32_t GID, double time) const;
+
+        bool empty() const { return m_animations.empty(); }
+
+        void clear();
+
+    private:
+        std::vector<Animation> m_animations;
+        std::vector<std::uint32_t> m_frameGIDs;
+        std::vector<std::uint32_t> m_frameEnds;
+    };
+}
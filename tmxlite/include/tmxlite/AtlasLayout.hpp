@@ -0,0 +1,137 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#pragma once
+
+#include <tmxlite/Config.hpp>
+#include <tmxlite/Types.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tmx
+{
+    class Map;
+
+    /*!
+    \brief Calculates the layout of a texture atlas containing the images
+    of all of a map's tile sets, so that a layer using any number of tile
+    sets can be drawn in a single batch.
+    Each tile set image, and each image of a tile in an image collection
+    tile set, is placed once on one of the atlas pages. Images used by
+    more than one tile set are placed only once. Copying the pixels of
+    each image to its position is left to the caller, who can then look
+    up the area of any tile in the atlas by its GID.
+    Tile sets used by templates are not included as their GIDs are
+    separate from those of the map.
+    */
+    class TMXLITE_EXPORT_API AtlasLayout final
+    {
+    public:
+        /*!
+        \brief An image to be copied to the atlas
+        */
+        struct Image final
+        {
+            std::string path; //!< path to the image, as returned by the tile set
+            Vector2u size; //!< size of the image in pixels
+            Vector2u position; //!< position of the image on its page, in pixels
+            std::uint32_t page = 0; //!< index of the page containing the image
+        };
+
+        /*!
+        \brief The area of a tile in the atlas
+        */
+        struct TileRect final
+        {
+            IntRect rect; //!< area of the tile on its page, in pixels
+            std::uint32_t page = 0; //!< index of the page containing the tile
+        };
+
+        AtlasLayout();
+
+        /*!
+        \brief Sets the largest size of an atlas page. Images are placed
+        on another page once a page is full. Defaults to 4096x4096.
+        */
+        void setMaxPageSize(Vector2u size) { m_maxPageSize = size; }
+        Vector2u getMaxPageSize() const { return m_maxPageSize; }
+
+        /*!
+        \brief Sets the number of pixels left between the images on a
+        page. Defaults to 1.
+        */
+        void setPadding(std::uint32_t padding) { m_padding = padding; }
+        std::uint32_t getPadding() const { return m_padding; }
+
+        /*!
+        \brief Calculates the layout of the given map's tile set images,
+        replacing any existing layout.
+        \returns false if an image is larger than the maximum page size,
+        in which case the layout is left empty
+        */
+        bool build(const Map&);
+
+        /*!
+        \brief Returns the images to copy to the atlas, and where to
+        copy them
+        */
+        const std::vector<Image>& getImages() const { return m_images; }
+
+        /*!
+        \brief Returns the size in pixels of each page of the atlas
+        */
+        const std::vector<Vector2u>& getPageSizes() const { return m_pageSizes; }
+
+        /*!
+        \brief Returns the area of every tile in the atlas, indexed by
+        GID, so that it can be used as a remap table when drawing. The
+        table has an entry for every GID up to the last one used by a
+        tile set, and entries for GIDs which are not part of any tile
+        set have a width and height of 0.
+        */
+        const std::vector<TileRect>& getTileRects() const { return m_tileRects; }
+
+        /*!
+        \brief Returns the area of the tile with the given GID in the
+        atlas, or nullptr if it is not part of any tile set. Any flip
+        flags in the GID are ignored.
+        */
+        const TileRect* getTileRect(std::uint32_t GID) const;
+
+        void clear();
+
+    private:
+        Vector2u m_maxPageSize;
+        std::uint32_t m_padding;
+
+        std::vector<Image> m_images;
+        std::vector<Vector2u> m_pageSizes;
+        std::vector<TileRect> m_tileRects;
+
+        bool pack();
+    };
+}
@@ -25,30 +25,6 @@ and must not be misrepresented as being the original software.
 source distribution.
 *********************************************************************/
 
-/*********************************************************************
-base64_decode
-
-Copyright (C) 2004-2008 René Nyffenegger
-This source code is provided 'as-is', without any express or implied
-warranty. In no event will the author be held liable for any damages
-arising from the use of this software.
-
-Permission is granted to anyone to use this software for any purpose,
-including commercial applications, and to alter it and redistribute it
-freely, subject to the following restrictions:
-
-1. The origin of this source code must not be misrepresented; you must not
-claim that you wrote the original source code. If you use this source code
-in a product, an acknowledgment in the product documentation would be
-appreciated but is not required.
-
-2. Altered source versions must be plainly marked as such, and must not be
-misrepresented as being the original source code.
-3. This notice may not be removed or altered from any source distribution.
-
-René Nyffenegger rene.nyffenegger@adp-gmbh.ch
-*********************************************************************/
-
 #pragma once
 
 #include <tmxlite/detail/Android.hpp>
@@ -67,69 +43,18 @@ namespace tmx
     //using inline here just to supress unused warnings on gcc (TODO: can say "(void)x" instead)
     bool decompress(const char* source, std::vector<unsigned char>& dest, std::size_t inSize, std::size_t expectedSize);
 
+    /*!
+    \brief Decodes 'length' characters of base64 text from 'source' into
+    'dest', which must have space for at least ((length + 3) / 4) * 3 bytes.
+    Decoding stops at the first padding or other non base64 character.
+    \returns The number of bytes written to 'dest'
+    */
+    TMXLITE_EXPORT_API std::size_t base64_decode(const char* source, std::size_t length, unsigned char* dest);
+
     static inline std::string base64_decode(std::string const& encoded_string)
     {
-        static const std::string base64_chars =
-            "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-            "abcdefghijklmnopqrstuvwxyz"
-            "0123456789+/";            
-            
-        std::function<bool(unsigned char)> is_base64 = 
-            [](unsigned char c)->bool
-        {
-            return (isalnum(c) || (c == '+') || (c == '/'));
-        };
-
-        auto in_len = encoded_string.size();
-        int i = 0;
-        int j = 0;
-        int in_ = 0;
-        unsigned char char_array_4[4], char_array_3[3];
-        std::string ret;
-
-        while (in_len-- && (encoded_string[in_] != '=') && is_base64(encoded_string[in_]))
-        {
-            char_array_4[i++] = encoded_string[in_]; in_++;
-            if (i == 4)
-            {
-                for (i = 0; i < 4; i++)
-                {
-                    char_array_4[i] = static_cast<unsigned char>(base64_chars.find(char_array_4[i]));
-                }
-                char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-                char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-                char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
-
-                for (i = 0; (i < 3); i++)
-                {
-                    ret += char_array_3[i];
-                }
-                i = 0;
-            }
-        }
-
-        if (i)
-        {
-            for (j = i; j < 4; j++)
-            {
-                char_array_4[j] = 0;
-            }
-
-            for (j = 0; j < 4; j++)
-            {
-                char_array_4[j] = static_cast<unsigned char>(base64_chars.find(char_array_4[j]));
-            }
-
-            char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-            char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-            char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
-
-            for (j = 0; (j < i - 1); j++)
-            {
-                ret += char_array_3[j];
-            }
-        }
-
+        std::string ret(((encoded_string.size() + 3) / 4) * 3, '\0');
+        ret.resize(base64_decode(encoded_string.data(), encoded_string.size(), reinterpret_cast<unsigned char*>(&ret[0])));
         return ret;
     }
 
@@ -179,6 +104,14 @@ namespace tmx
     */
     extern TMXLITE_CONSTINIT bool enableWindowsPathHandling;
 
+    /*!
+    \brief When true Map::load() and Tileset::loadWithoutMap() map files
+    directly into memory and parse the mapped bytes, rather than first
+    reading them into a string. Files which cannot be mapped are read
+    as normal. Defaults to false.
+    */
+    extern TMXLITE_CONSTINIT bool enableFileMapping;
+
     /*!
     \brief Returns whether 'path' is absolute, and optionally writes its
     prefix (e.g. '/' or 'c:\\') in 'prefix'.
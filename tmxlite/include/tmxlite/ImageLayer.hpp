@@ -41,12 +41,13 @@ namespace tmx
     class TMXLITE_EXPORT_API ImageLayer final : public Layer
     {
     protected:
-        virtual bool parseChild(const struct cJSON &child, tmx::Map *map);
+        virtual bool parseChild(tmx::detail::Key key, const struct cJSON &child, tmx::Map* map);
     public:
         explicit ImageLayer(const std::string&);
 
         Type getType() const override { return Layer::Type::Image; }
         virtual bool parse(const struct cJSON&, Map*) override;
+        virtual bool parseStream(tmx::detail::JsonReader&, Map*) override;
 
         /*!
         \brief Returns the path, relative to the working directory,
@@ -84,6 +85,8 @@ namespace tmx
         bool hasRepeatY() const { return m_hasRepeatY; }
 
     private:
+        friend class detail::CompiledMap;
+
         std::string m_workingDir;
         std::string m_filePath;
         Colour m_transparencyColour;
@@ -91,6 +94,8 @@ namespace tmx
         Vector2u m_imageSize;
         bool m_hasRepeatX;
         bool m_hasRepeatY;
+
+        bool parseComplete(bool);
     };
 
     template <>
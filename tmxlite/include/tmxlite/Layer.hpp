@@ -53,7 +53,7 @@ namespace tmx
     class TMXLITE_EXPORT_API Layer : public Parsable
     {
     protected:
-        virtual bool parseChild(const struct cJSON &child, tmx::Map* map = nullptr) override;
+        virtual bool parseChild(tmx::detail::Key key, const struct cJSON &child, tmx::Map* map = nullptr) override;
     public:
         using Ptr = std::unique_ptr<Layer>;
 
@@ -62,6 +62,13 @@ namespace tmx
 
         static std::unique_ptr<tmx::Layer> readLayer(const struct cJSON &node, tmx::Map* map = nullptr);
         static std::vector<std::unique_ptr<tmx::Layer>> readLayers(const struct cJSON &node, tmx::Map* map = nullptr);
+
+        /*!
+        \brief Streaming versions of readLayer() and readLayers() which read
+        the layer data directly from the reader's current position.
+        */
+        static std::unique_ptr<tmx::Layer> readLayer(tmx::detail::JsonReader& reader, tmx::Map* map = nullptr);
+        static std::vector<std::unique_ptr<tmx::Layer>> readLayers(tmx::detail::JsonReader& reader, tmx::Map* map = nullptr);
         /*!
         \brief Layer type as returned by getType()
         Tile: this layer is a TileLayer type
@@ -87,7 +94,7 @@ namespace tmx
         /*!
         \brief Returns the class of the Layer, as defined in the editor Tiled 1.9+
         */
-        const std::string& getClass() const { return m_class; }
+        const String& getClass() const { return m_class; }
 
         /*!
         \brief Use this to get a reference to the concrete layer type
@@ -105,7 +112,7 @@ namespace tmx
         /*!
         \brief Returns the name of the layer
         */
-        const std::string& getName() const { return m_name; }
+        const String& getName() const { return m_name; }
 
         /*!
         \brief Returns the opacity value for the layer
@@ -145,14 +152,14 @@ namespace tmx
         /*!
         \brief Returns the list of properties of this layer
         */
-        const std::vector<Property>& getProperties() const { return m_properties; }
+        const Vector<Property>& getProperties() const { return m_properties; }
 
         int getId() { return m_id; }
 
     protected:
 
-        void setName(const std::string& name) { m_name = name; }
-        void setClass(const std::string& cls) { m_class = cls; }
+        void setName(const std::string& name) { m_name.assign(name.data(), name.size()); }
+        void setClass(const std::string& cls) { m_class.assign(cls.data(), cls.size()); }
         void setOpacity(float opacity) { m_opacity = opacity; }
         void setVisible(bool visible) { m_visible = visible; }
         void setOffset(std::int32_t x, std::int32_t y) { m_offset = Vector2i(x, y); }
@@ -161,9 +168,11 @@ namespace tmx
         //void addProperty(const pugi::xml_node& node) { m_properties.emplace_back(); m_properties.back().parse(node); }
 
     private:
+        friend class detail::CompiledMap;
+
         int m_id;
-        std::string m_name;
-        std::string m_class;
+        String m_name;
+        String m_class;
         float m_opacity;
         bool m_visible;
         Vector2i m_offset;
@@ -172,6 +181,6 @@ namespace tmx
         Colour m_tintColour = { 255,255,255,255 };
         Vector2u m_size;
 
-        std::vector<Property> m_properties;
+        Vector<Property> m_properties;
     };
 }
@@ -42,7 +42,8 @@ namespace tmx
     class TMXLITE_EXPORT_API LayerGroup final : public Layer
     {
     protected:
-        virtual bool parseChild(const struct cJSON &child, tmx::Map* map) override;
+        virtual bool parseChild(tmx::detail::Key key, const struct cJSON &child, tmx::Map* map) override;
+        virtual bool parseChildStream(tmx::detail::Key key, tmx::detail::JsonReader& reader, tmx::Map* map) override;
     public:
 
         LayerGroup();
@@ -64,6 +65,8 @@ namespace tmx
         const std::vector<Layer::Ptr>& getLayers() const { return m_layers; }
         virtual bool parse(const cJSON &node, tmx::Map *map) override;
     private:
+        friend class detail::CompiledMap;
+
         const cJSON* m_layerNode = nullptr;
         std::vector<Layer::Ptr> m_layers;
     };
@@ -28,20 +28,36 @@ source distribution.
 #pragma once
 
 #include <tmxlite/Tileset.hpp>
+#include <tmxlite/TilesetCache.hpp>
+#include <tmxlite/ZstdDictionary.hpp>
 #include <tmxlite/Layer.hpp>
 #include <tmxlite/Property.hpp>
 #include <tmxlite/Types.hpp>
 #include <tmxlite/Object.hpp>
+#include <tmxlite/AnimationTable.hpp>
+#include <tmxlite/detail/Arena.hpp>
 
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
 #include <string>
 #include <vector>
 #include <map>
 #include <unordered_map>
+#include <unordered_set>
 
 struct cJSON;
 
 namespace tmx
 {
+    namespace detail
+    {
+        class JsonReader;
+        class CompiledMap;
+        enum class Key : std::uint16_t;
+    }
+
     /*!
     \brief Holds the xml version of the loaded map
     */
@@ -90,11 +106,132 @@ namespace tmx
     class before calling load() providing a path to the *.tmx file to be
     loaded. Then layers or objects can be requested from the Map class
     to be interpreted as needed.
+    When tmxlite is built with USE_ARENA the strings and vectors belonging
+    to the map are allocated from a single arena owned by the Map, which is
+    freed in one go when the map is reset, reloaded or destroyed. Data
+    moved out of a map must not be used after this happens, copies are
+    allocated normally.
     \see https://doc.mapeditor.org/en/stable/reference/tmx-map-format/#map
     */
     class TMXLITE_EXPORT_API Map final
     {
     public:
+
+        /*!
+        \brief Selects how map documents are parsed.
+        Streaming reads the map data directly from the loaded text,
+        filling in the map as it goes, without first building a
+        document tree of the entire file. This is the default, and
+        uses considerably less memory when loading large maps.
+        Document parses the entire file into a cJSON tree before
+        reading it, and is kept as a fallback.
+        */
+        enum class ParseMode
+        {
+            Document,
+            Streaming
+        };
+
+        /*!
+        \brief Selects when the tile data of tile layers is decoded.
+        Eager decodes every layer while the map is loaded. Lazy keeps
+        the encoded data of each layer and decodes it the first time
+        TileLayer::getTiles() or TileLayer::getChunks() is called, so
+        that layers which are never read are never decoded.
+        \see decodeAll()
+        */
+        enum class TileDecoding
+        {
+            Eager,
+            Lazy
+        };
+
+        /*!
+        \brief Selects how the tiles of tile layers are stored once decoded.
+        Tiles stores a list of TileLayer::Tile for each layer and chunk.
+        Arrays stores the tile IDs and flip flags in two separate arrays,
+        which use less memory for large layers and can be read with no
+        stride. GIDs stores the GIDs as decoded from the map data, with
+        the flip flags in their top bits, for example to be uploaded to
+        a GPU buffer as they are. Palette stores a list of the distinct
+        tiles used by each layer and chunk, and an 8, 16 or 32 bit index
+        into it for each tile, which uses the least memory for layers
+        made from few distinct tiles. TileLayer::getTiles() still works
+        with any of these, creating the list of tiles when it is first
+        called.
+        \see TileLayer::getTileIDs()
+        \see TileLayer::getGIDs()
+        \see TileLayer::getPalette()
+        */
+        enum class TileStorage
+        {
+            Tiles,
+            Arrays,
+            GIDs,
+            Palette
+        };
+
+        /*!
+        \brief The phases of loading a map, as reported to a ProgressCallback.
+        Phases are reported in this order, except for templates, which are
+        loaded as the objects using them are parsed so that their progress
+        is reported between layers. When the worker thread count is not 1
+        external tile sets and templates are loaded before the map is
+        parsed, and are reported once the Parse phase has started.
+        With ParseMode::Streaming the document is read as the map is built,
+        so the Parse phase spans the whole load: it is completed only once
+        the end of the document has been reached, after the Tilesets, Layers
+        and Templates phases it contains.
+        \see setProgressCallback()
+        */
+        enum class LoadPhase
+        {
+            FileRead,
+            Parse,
+            Tilesets,
+            Layers,
+            Templates
+        };
+
+        /*!
+        \brief Called as a map is loaded with the current phase, and the
+        number of steps completed out of the total steps in that phase. The
+        total is 0 when it isn't known in advance, such as the number of
+        layers when using ParseMode::Streaming.
+        Callbacks are made on the thread loading the map.
+        */
+        using ProgressCallback = std::function<void(LoadPhase phase, std::size_t completed, std::size_t total)>;
+
+        /*!
+        \brief Describes an external tile set or template file
+        loaded as part of the map, and how long it took to load.
+        \see getExternalFiles()
+        */
+        struct ExternalFile final
+        {
+            enum class Type
+            {
+                Tileset,
+                Template
+            };
+
+            std::string path; //!< path as it appears in the map
+            Type type = Type::Tileset;
+            bool loaded = false; //!< false if the file could not be read or parsed
+            double loadTime = 0.0; //!< time taken to read and parse the file, in milliseconds
+        };
+
+        /*!
+        \brief The tile set containing a GID, and the ID of the tile
+        within it.
+        \see findTile()
+        */
+        struct TileLocation final
+        {
+            const Tileset* tileset = nullptr; //!< nullptr if no tile set contains the GID
+            std::int32_t index = -1; //!< index of the tile set in getTilesets(), or -1 for template tile sets
+            std::uint32_t tileID = 0; //!< GID less the first GID of the tile set
+        };
             
         Map();
         ~Map() = default;
@@ -105,12 +242,52 @@ namespace tmx
 
         /*!
         \brief Attempts to parse the tilemap at the given location.
+        Maps written by saveCompiled() are detected and loaded directly.
         \param std::string Path to map file to try to parse
         \returns true if map was parsed successfully else returns false.
         In debug mode this will attempt to log any errors to the console.
         */
         bool load(const std::string&);
 
+        /*!
+        \brief Writes the loaded map to the given path in a compiled binary
+        format, which can be loaded with load() or loadFromMemory() without
+        parsing or decompressing anything.
+        The compiled map contains the fully parsed map, including its tile
+        sets and templates, so does not refer to any other map files. Asset
+        paths such as images are stored as they were resolved when the map
+        was loaded. Compiled maps can only be loaded by the same version of
+        tmxlite on a machine with the same byte order.
+        Any tile layers not yet decoded are decoded first.
+        \returns false if the file could not be written
+        */
+        bool saveCompiled(const std::string& path) const;
+
+        /*!
+        \brief Loads the map at the given location on a new thread.
+        The map must not be used, moved or destroyed until the returned
+        future is ready, other than to call cancelLoad().
+        \returns A future which holds the result of load()
+        \see setProgressCallback()
+        */
+        std::future<bool> loadAsync(const std::string& path);
+
+        /*!
+        \brief Requests that the load in progress stops. Loading stops
+        between layers or phases, after which the map is left empty and the
+        load returns false. The request is cleared when the load returns,
+        and applies to the next load if none is in progress.
+        This can be safely called from any thread.
+        */
+        void cancelLoad() { m_cancelRequested->store(true); }
+
+        /*!
+        \brief Sets a function which is called with the progress of
+        subsequent loads, or an empty function to remove it.
+        \see ProgressCallback
+        */
+        void setProgressCallback(ProgressCallback callback) { m_progressCallback = std::move(callback); }
+
         /*!
         \brief Loads a map from a document stored in a string
         \param data A std::string containing the map data to load
@@ -120,6 +297,123 @@ namespace tmx
         */
         bool loadFromString(const std::string& data, const std::string& workingDir);
 
+        /*!
+        \brief Loads a map from a document stored in memory.
+        The data is parsed in place and does not need to be null terminated.
+        \param data Pointer to the map data to load
+        \param size Size of the data in bytes
+        \param workingDir A std::string containing the working directory
+        in which to find assets such as tile sets or images
+        \returns true if successful, else false
+        \see enableFileMapping
+        */
+        bool loadFromMemory(const char* data, std::size_t size, const std::string& workingDir);
+
+        /*!
+        \brief Sets the ParseMode used by subsequent calls to load()
+        or loadFromString(). Defaults to ParseMode::Streaming
+        */
+        void setParseMode(ParseMode mode) { m_parseMode = mode; }
+
+        /*!
+        \brief Returns the ParseMode used when loading maps
+        */
+        ParseMode getParseMode() const { return m_parseMode; }
+
+        /*!
+        \brief Sets when the tile data of subsequently loaded maps is
+        decoded. Defaults to TileDecoding::Eager
+        */
+        void setTileDecoding(TileDecoding decoding) { m_tileDecoding = decoding; }
+
+        /*!
+        \brief Returns when tile data is decoded for loaded maps
+        */
+        TileDecoding getTileDecoding() const { return m_tileDecoding; }
+
+        /*!
+        \brief Sets how the tiles of subsequently loaded maps are stored.
+        Defaults to TileStorage::Tiles
+        */
+        void setTileStorage(TileStorage storage) { m_tileStorage = storage; }
+
+        /*!
+        \brief Returns how the tiles of loaded maps are stored
+        */
+        TileStorage getTileStorage() const { return m_tileStorage; }
+
+        /*!
+        \brief Sets the proportion of non-empty tiles, from 0 to 1, below
+        which the tile layers of subsequently loaded maps are stored as
+        TileLayer::SparseTiles instead of the set TileStorage. Layers are
+        counted together with their chunks once decoded.
+        Defaults to 0, which stores no layers as sparse tiles.
+        \see TileLayer::getSparseTiles()
+        */
+        void setSparseThreshold(float threshold) { m_sparseThreshold = threshold; }
+
+        /*!
+        \brief Returns the proportion of non-empty tiles below which
+        tile layers are stored as sparse tiles
+        */
+        float getSparseThreshold() const { return m_sparseThreshold; }
+
+        /*!
+        \brief Decodes the tile data of all tile layers, including those
+        inside layer groups, which have not yet been decoded. This only
+        needs to be called when TileDecoding::Lazy is used, to move the
+        cost of decoding to a time of the caller's choosing.
+        */
+        void decodeAll() const;
+
+        /*!
+        \brief Sets the number of threads used to load maps, including
+        the calling thread. When greater than one the tile layers and
+        chunks of a map are decoded concurrently once it has been parsed,
+        as are any layers decoded by decodeAll(). The results are the
+        same as decoding on a single thread.
+        Unless the count is 1 any external tile sets and templates
+        referenced by the map are also found before the map is parsed,
+        and loaded concurrently.
+        \param count Number of threads to use, or 0 to use one per
+        hardware thread. Defaults to 1
+        */
+        void setWorkerThreadCount(std::size_t count) { m_workerThreadCount = count; }
+
+        /*!
+        \brief Returns the number of threads used to load maps
+        \see setWorkerThreadCount()
+        */
+        std::size_t getWorkerThreadCount() const { return m_workerThreadCount; }
+
+        /*!
+        \brief Sets a cache through which external tile sets are loaded,
+        so that maps using the same tile set files share a single copy of
+        them. The cache must outlive any call to load(). Pass nullptr to
+        load tile sets without a cache, which is the default.
+        \see TilesetCache
+        */
+        void setTilesetCache(TilesetCache* cache) { m_tilesetCache = cache; }
+
+        /*!
+        \brief Returns the cache used to load external tile sets, if any
+        */
+        TilesetCache* getTilesetCache() const { return m_tilesetCache; }
+
+        /*!
+        \brief Sets the dictionary used to decompress zstd compressed tile
+        data which was compressed with one. The dictionary must outlive any
+        call to load(), and with TileDecoding::Lazy any layers which are
+        not yet decoded. Pass nullptr, the default, to use no dictionary.
+        \see ZstdDictionary
+        */
+        void setZstdDictionary(const ZstdDictionary* dictionary) { m_zstdDictionary = dictionary; }
+
+        /*!
+        \brief Returns the dictionary used to decompress zstd tile data, if any
+        */
+        const ZstdDictionary* getZstdDictionary() const { return m_zstdDictionary; }
+
         /*!
         \brief Returns the version of the tile map last parsed.
         If no tile map has yet been parsed the version will read 0, 0
@@ -187,7 +481,7 @@ namespace tmx
         /*!
         \brief Returns a reference to the vector of tile sets used by the map
         */
-        const std::vector<Tileset>& getTilesets() const { return m_tilesets; }
+        const Vector<Tileset>& getTilesets() const { return m_tilesets; }
 
         /*!
         \brief Returns a reference to the vector containing the layer data.
@@ -200,18 +494,45 @@ namespace tmx
         /*!
         \brief Returns the class of the Map, as defined in the editor Tiled 1.9+
         */
-        const std::string& getClass() const { return m_class; }
+        const String& getClass() const { return m_class; }
 
         /*!
         \brief Returns a vector of Property objects loaded by the map
         */
-        const std::vector<Property>& getProperties() const { return m_properties; } 
+        const Vector<Property>& getProperties() const { return m_properties; } 
 
         /*!
         \brief Returns a Hashmap of all animated tiles accessible by TileID
         */
         const std::map<std::uint32_t, Tileset::Tile>& getAnimatedTiles() const { return m_animTiles; }
 
+        /*!
+        \brief Returns the animations of all the animated tiles in the
+        map's tile sets, stored as flat arrays.
+        \see AnimationClock
+        */
+        const AnimationTable& getAnimationTable() const { return m_animationTable; }
+
+        /*!
+        \brief Returns the tile set containing the given GID, along with
+        its index in getTilesets() and the ID of the tile within it.
+        Any flip flags in the GID are ignored. The result is looked up in
+        a table built when the map is loaded, rather than by searching
+        the tile sets.
+        \returns A TileLocation whose tileset is nullptr if none of the
+        map's tile sets contains the GID
+        */
+        TileLocation findTile(std::uint32_t GID) const;
+
+        /*!
+        \brief Returns the tile set used to draw the given tile object.
+        Objects created from a template are looked up in the tile sets
+        returned by getTemplateTilesets(), other objects in the map's
+        own tile sets.
+        \see findTile(std::uint32_t)
+        */
+        TileLocation findTile(const Object&) const;
+
         /*!
         \brief Returns the current working directory of the map. Images and
         other resources are loaded relative to this.
@@ -233,6 +554,13 @@ namespace tmx
         std::unordered_map<std::string, Tileset>& getTemplateTilesets() { return m_templateTilesets; }
         const std::unordered_map<std::string, Tileset>& getTemplateTilesets() const { return m_templateTilesets; }
 
+        /*!
+        \brief Returns the external tile sets and templates loaded
+        with the map, in the order in which they finished loading, along
+        with the time taken to load each of them.
+        */
+        const std::vector<ExternalFile>& getExternalFiles() const { return m_externalFiles; }
+
         /*!
         \brief Returns true if this is in infinite tile map.
         Infinite maps store their tile data in for tile layers in chunks. If
@@ -248,9 +576,23 @@ namespace tmx
         Vector2f getParallaxOrigin() const { return m_parallaxOrigin; }
 
     private:
+        //declared first so that it outlives everything allocated from it
+        detail::Arena m_arena;
+
+        ParseMode m_parseMode;
+        TileDecoding m_tileDecoding;
+        TileStorage m_tileStorage;
+        float m_sparseThreshold;
+        std::size_t m_workerThreadCount;
+        TilesetCache* m_tilesetCache;
+        const ZstdDictionary* m_zstdDictionary;
+        ProgressCallback m_progressCallback;
+
+        //allocated so that the map remains movable
+        std::unique_ptr<std::atomic<bool>> m_cancelRequested;
         int m_compressionLevel;
         Version m_version;
-        std::string m_class;
+        String m_class;
         Orientation m_orientation;
         RenderOrder m_renderOrder;
         bool m_infinite;
@@ -268,15 +610,52 @@ namespace tmx
 
         std::string m_workingDirectory;
 
-        std::vector<Tileset> m_tilesets;
+        Vector<Tileset> m_tilesets;
         std::vector<Layer::Ptr> m_layers;
-        std::vector<Property> m_properties;
+        Vector<Property> m_properties;
         std::map<std::uint32_t, Tileset::Tile> m_animTiles;
+        AnimationTable m_animationTable;
+
+        //GID to tile set lookup built by buildGIDTable(). When the GIDs
+        //in use are dense enough the table holds the tile set index + 1
+        //for every GID, else the ranges are searched.
+        struct GIDRange final
+        {
+            std::uint32_t first = 0;
+            std::uint32_t last = 0;
+            std::uint32_t index = 0;
+        };
+        std::vector<std::uint16_t> m_gidTable;
+        std::vector<GIDRange> m_gidRanges;
 
         std::unordered_map<std::string, Object> m_templateObjects;
         std::unordered_map<std::string, Tileset> m_templateTilesets;
 
+        friend class detail::CompiledMap;
+
+        //external files loaded ahead of parsing by preloadExternalFiles()
+        friend class Tileset;
+        friend class Object;
+        struct PreloadedTileset final
+        {
+            Tileset tileset;
+            bool loaded = false;
+        };
+        std::unordered_map<std::string, PreloadedTileset> m_preloadedTilesets;
+        std::unordered_set<std::string> m_failedTemplates;
+        std::vector<ExternalFile> m_externalFiles;
+
+        void preloadExternalFiles(const std::vector<std::string>& tilesets, const std::vector<std::string>& templates);
+
+        bool loadDocument(const char* data, std::size_t size, const std::string& workingDir);
+        void reportProgress(LoadPhase, std::size_t completed, std::size_t total) const;
+        bool loadCancelled() const;
+
         bool parseMapNode(const cJSON&);
+        bool parseMapStream(tmx::detail::JsonReader&);
+        bool parseMapAttribute(tmx::detail::Key, const cJSON&);
+        bool parseComplete();
+        void buildGIDTable();
 
         //always returns false so we can return this
         //on load failure
@@ -40,13 +40,14 @@ struct cJSON;
 namespace tmx
 {
     class Map;
+    class Tileset;
 
     /*!
     \brief Contains the text information stored in a Text object.
     */
     struct TMXLITE_EXPORT_API Text final
     {
-        std::string fontFamily;
+        String fontFamily;
         std::uint32_t pixelSize = 16; //!< pixels, not points
         bool wrap = false;
         Colour colour;
@@ -66,7 +67,7 @@ namespace tmx
             Top, Centre, Bottom
         }vAlign = VAlign::Top;
 
-        std::string content; //!< actual string content
+        String content; //!< actual string content
     };
     
     /*!
@@ -81,7 +82,7 @@ namespace tmx
     class TMXLITE_EXPORT_API Object final : public Parsable 
     {
     protected:
-        virtual bool parseChild(const struct cJSON &child, tmx::Map* map) override;
+        virtual bool parseChild(tmx::detail::Key key, const struct cJSON &child, tmx::Map* map) override;
     public:
         enum class Shape
         {
@@ -100,6 +101,7 @@ namespace tmx
         read the Object properties if it is valid.
         */
         bool parse(const cJSON&, Map*) override;
+        bool parseStream(tmx::detail::JsonReader&, Map*) override;
 
         /*!
         \brief Returns the unique ID of the Object
@@ -109,17 +111,17 @@ namespace tmx
         /*!
         \brief Returns the name of the Object
         */
-        const std::string& getName() const { return m_name; }
+        const String& getName() const { return m_name; }
         
         /*!
         \brief Returns the type (equal to class) of the Object, as defined in the editor Tiled < 1.9
         */
-        const std::string& getType() const { return m_class; }
+        const String& getType() const { return m_class; }
 
         /*!
         \brief Returns the class (equal to type) of the Object, as defined in the editor Tiled 1.9+
         */
-        const std::string& getClass() const { return m_class; }
+        const String& getClass() const { return m_class; }
 
         /*!
         \brief Returns the position of the Object in pixels
@@ -169,13 +171,13 @@ namespace tmx
         then the vector will be empty. Point coordinates are in pixels,
         relative to the object position.
         */
-        const std::vector<Vector2f>& getPoints() const { return m_points; }
+        const Vector<Vector2f>& getPoints() const { return m_points; }
         
         /*!
         \brief Returns a reference to the vector of properties belonging to
         the Object.
         */
-        const std::vector<Property>& getProperties() const { return m_properties; }
+        const Vector<Property>& getProperties() const { return m_properties; }
 
         /*!
         \brief Returns a Text struct containing information about any text
@@ -193,12 +195,14 @@ namespace tmx
         If the string is not empty use it to index the unordered_map returned
         by Map::getTemplateTilesets()
         */
-        const std::string& getTilesetName() const { return m_tilesetName; }
+        const String& getTilesetName() const { return m_tilesetName; }
 
     private:
+        friend class detail::CompiledMap;
+
         std::uint32_t m_UID;
-        std::string m_name;
-        std::string m_class;
+        String m_name;
+        String m_class;
         std::string m_template;
         Vector2f m_position;
         FloatRect m_AABB;
@@ -208,15 +212,22 @@ namespace tmx
         bool m_visible;
 
         Shape m_shape;
-        std::vector<Vector2f> m_points;
-        std::vector<Property> m_properties;
+        Vector<Vector2f> m_points;
+        Vector<Property> m_properties;
 
         Text m_textData;
 
-        std::string m_tilesetName;
+        String m_tilesetName;
 
         void parsePoints(const struct cJSON&);
         void parseText(const cJSON&);
         void parseTemplate(const std::string&, Map*);
+        void parseComplete(Map*);
+
+        //loads a template file into the given object, along with its tile
+        //set if it has one. This doesn't touch the map so that templates
+        //can be loaded on worker threads
+        friend class Map;
+        static bool loadTemplate(const std::string& path, const std::string& workingDir, Object&, Tileset&);
     };
 }
\ No newline at end of file
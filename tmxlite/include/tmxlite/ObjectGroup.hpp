@@ -42,7 +42,8 @@ namespace tmx
     class TMXLITE_EXPORT_API ObjectGroup final : public Layer
     {
     protected:
-        virtual bool parseChild(const struct cJSON &child, tmx::Map* map = nullptr) override;
+        virtual bool parseChild(tmx::detail::Key key, const struct cJSON &child, tmx::Map* map = nullptr) override;
+        virtual bool parseChildStream(tmx::detail::Key key, tmx::detail::JsonReader& reader, tmx::Map* map) override;
         
     public:
         enum class DrawOrder
@@ -70,19 +71,21 @@ namespace tmx
         \brief Returns a reference to the vector of properties for
         the ObjectGroup
         */
-        const std::vector<Property>& getProperties() const { return m_properties; }
+        const Vector<Property>& getProperties() const { return m_properties; }
 
         /*!
         \brief Returns a reference to the vector of Objects which belong to the group
         */
-        const std::vector<Object>& getObjects() const { return m_objects; }
+        const Vector<Object>& getObjects() const { return m_objects; }
 
     private:
+        friend class detail::CompiledMap;
+
         Colour m_colour;
         DrawOrder m_drawOrder;
 
-        std::vector<Property> m_properties;
-        std::vector<Object> m_objects;
+        Vector<Property> m_properties;
+        Vector<Object> m_objects;
     };
 
     template <>
@@ -48,7 +48,7 @@ namespace tmx
         {
             std::string name;
             Colour colour;
-            std::vector<Property> properties;
+            Vector<Property> properties;
         };
 
         /*!
@@ -2,15 +2,43 @@
 
 #include "Config.hpp"
 
+#include <cstdint>
+
 namespace tmx
 {
     class Map;
+
+    namespace detail
+    {
+        class JsonReader;
+        class CompiledMap;
+        enum class Key : std::uint16_t;
+    }
 }
 
 class TMXLITE_EXPORT_API Parsable
 {
 protected:
-    virtual bool parseChild(const struct cJSON &child, tmx::Map* map) = 0;
+    /*!
+    \brief Parses a single child of the node passed to parse().
+    \param key The child's name, already classified so that overrides
+    can switch on it rather than comparing strings.
+    */
+    virtual bool parseChild(tmx::detail::Key key, const struct cJSON &child, tmx::Map* map) = 0;
+
+    /*!
+    \brief Streaming counterpart of parseChild(), called with the reader
+    positioned at the value of the current key. Overrides must consume
+    the value. By default the value is read into a temporary node and
+    passed to parseChild().
+    */
+    virtual bool parseChildStream(tmx::detail::Key key, tmx::detail::JsonReader& reader, tmx::Map* map);
 public:
     virtual bool parse(const struct cJSON &node, tmx::Map* map);
-};
\ No newline at end of file
+
+    /*!
+    \brief Parses the object at the reader's current position directly
+    from the token stream, without building a document tree.
+    */
+    virtual bool parseStream(tmx::detail::JsonReader& reader, tmx::Map* map);
+};
@@ -29,6 +29,7 @@ source distribution.
 
 #include <tmxlite/Config.hpp>
 #include <tmxlite/Types.hpp>
+#include <tmxlite/detail/Arena.hpp>
 
 #include <string>
 #include <cassert>
@@ -39,6 +40,11 @@ struct cJSON;
 
 namespace tmx
 {
+    namespace detail
+    {
+        class CompiledMap;
+    }
+
     /*!
     \brief Represents a custom property.
     Tiles, objects and layers of a tmx map may have custom
@@ -49,7 +55,7 @@ namespace tmx
     class TMXLITE_EXPORT_API Property final
     {
     public:
-        static std::vector<Property> readProperties(const cJSON &node);
+        static Vector<Property> readProperties(const cJSON &node);
         enum class Type
         {
             Boolean,
@@ -90,7 +96,7 @@ namespace tmx
         /*!
         \brief Returns the name of this property
         */
-        const std::string& getName() const { return m_name; }
+        const String& getName() const { return m_name; }
 
         /*!
         \brief Returns the property's value as a boolean
@@ -110,7 +116,7 @@ namespace tmx
         /*!
         \brief Returns the property's value as a string
         */
-        const std::string& getStringValue() const { assert(m_type == Type::String); return m_stringValue; }
+        const String& getStringValue() const { assert(m_type == Type::String); return m_stringValue; }
 
         /*!
         \brief Returns the property's value as a Colour struct
@@ -120,17 +126,17 @@ namespace tmx
         /*!
         \brief Returns the file path property as a string, relative to the map file
         */
-        const std::string& getFileValue() const { assert(m_type == Type::File); return m_stringValue; }
+        const String& getFileValue() const { assert(m_type == Type::File); return m_stringValue; }
 
         /*!
         \brief Returns an array of properties
         */
-        const std::vector<Property>& getClassValue() const {assert(m_type == Type::Class); return m_classValue; }
+        const Vector<Property>& getClassValue() const {assert(m_type == Type::Class); return m_classValue; }
 
         /*!
         \brief Returns an the propertytype value
         */
-        const std::string getPropertyType() const {assert(m_type == Type::Class); return m_propertyType; }
+        const String getPropertyType() const {assert(m_type == Type::Class); return m_propertyType; }
         
         /*!
         \brief Returns the property's value as an integer object handle
@@ -139,18 +145,20 @@ namespace tmx
 
 
     private:
+        friend class detail::CompiledMap;
+
         union
         {
             bool m_boolValue;
             float m_floatValue;
             int m_intValue;
         };
-        std::string m_stringValue;
-        std::string m_name;
-        std::string m_propertyType;
+        String m_stringValue;
+        String m_name;
+        String m_propertyType;
         
         Colour m_colourValue;
-        std::vector<Property> m_classValue;
+        Vector<Property> m_classValue;
 
         Type m_type;
     };
@@ -30,15 +30,23 @@ source distribution.
 #include <tmxlite/Layer.hpp>
 #include <tmxlite/Types.hpp>
 
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 namespace tmx
 {
+    class ZstdDictionary;
+
     /*!
     \brief A layer made up from a series of tile sets
     */
     class TMXLITE_EXPORT_API TileLayer final : public Layer
     {
     protected:
-        virtual bool parseChild(const struct cJSON &child, tmx::Map* map = nullptr) override;
+        virtual bool parseChild(tmx::detail::Key key, const struct cJSON &child, tmx::Map* map = nullptr) override;
+        virtual bool parseChildStream(tmx::detail::Key key, tmx::detail::JsonReader& reader, tmx::Map* map) override;
     public:
 
         enum class CompressionType
@@ -59,14 +67,199 @@ namespace tmx
         };
 
         /*!
-        \brief Represents a chunk of tile data, if this is an infinite map
+        \brief Tiles stored as indices into a list of the distinct tiles
+        they use, when loaded with Map::TileStorage::Palette.
+        Each index is 8, 16 or 32 bits, whichever is the smallest to
+        hold the number of distinct tiles, so that a layer using fewer
+        than 256 tiles needs a single byte for each.
+        */
+        class TMXLITE_EXPORT_API Palette final
+        {
+        public:
+            /*!
+            \brief Returns the number of tiles
+            */
+            std::size_t size() const { return m_indices8.size() + m_indices16.size() + m_indices32.size(); }
+
+            bool empty() const { return size() == 0; }
+
+            /*!
+            \brief Returns the distinct tiles, in the order they first appear
+            */
+            const std::vector<Tile>& getEntries() const { return m_entries; }
+
+            /*!
+            \brief Returns the size in bytes of each index, either 1, 2 or 4
+            */
+            std::size_t getIndexSize() const { return m_indexSize; }
+
+            /*!
+            \brief Returns the index into getEntries() of the tile at the given position
+            */
+            std::uint32_t getIndex(std::size_t position) const
+            {
+                switch (m_indexSize)
+                {
+                case 1:
+                    return m_indices8[position];
+                case 2:
+                    return m_indices16[position];
+                default:
+                    return m_indices32[position];
+                }
+            }
+
+            /*!
+            \brief Returns the tile at the given position
+            */
+            const Tile& operator [] (std::size_t position) const { return m_entries[getIndex(position)]; }
+
+            /*!
+            \brief Returns the indices of all the tiles, where T is the
+            unsigned integer type matching getIndexSize(). The span is
+            empty if T is any other size.
+            */
+            template <typename T>
+            Span<T> getIndices() const;
+
+            /*!
+            \brief Calls func with each tile in order, choosing the size of
+            the indices once rather than for each tile.
+            func takes a const Tile& as its only argument.
+            */
+            template <typename Func>
+            void forEach(Func&& func) const
+            {
+                switch (m_indexSize)
+                {
+                case 1:
+                    for (auto i : m_indices8) func(m_entries[i]);
+                    break;
+                case 2:
+                    for (auto i : m_indices16) func(m_entries[i]);
+                    break;
+                default:
+                    for (auto i : m_indices32) func(m_entries[i]);
+                    break;
+                }
+            }
+
+        private:
+            friend class TileLayer;
+            friend class detail::CompiledMap;
+
+            std::vector<Tile> m_entries;
+            std::vector<std::uint8_t> m_indices8;
+            std::vector<std::uint16_t> m_indices16;
+            std::vector<std::uint32_t> m_indices32;
+            std::size_t m_indexSize = 1;
+
+            //the index of each GID in m_entries, only used while decoding
+            std::unordered_map<std::uint32_t, std::uint32_t> m_lookup;
+
+            void reserve(std::size_t count);
+            void append(const std::uint32_t* GIDs, std::size_t count);
+            void finish();
+            void clear();
+        };
+
+        /*!
+        \brief Tiles stored as runs of non-empty tiles, used for layers
+        with fewer non-empty tiles than the sparse threshold set with
+        Map::setSparseThreshold(). Memory use, and the time taken to
+        iterate the tiles, depend only on the number of non-empty tiles
+        and runs rather than on the size of the layer.
+        A tile is empty if both its ID and flip flags are 0.
+        */
+        class TMXLITE_EXPORT_API SparseTiles final
+        {
+        public:
+            /*!
+            \brief A run of consecutive non-empty tiles
+            */
+            struct Run final
+            {
+                std::uint32_t start = 0; //!< Position of the first tile of the run
+                std::uint32_t count = 0; //!< Number of tiles in the run
+                std::uint32_t first = 0; //!< Index into getTiles() of the first tile of the run
+            };
+
+            /*!
+            \brief Returns the number of tiles, including the empty ones
+            */
+            std::size_t size() const { return m_size; }
+
+            bool empty() const { return m_size == 0; }
+
+            /*!
+            \brief Returns the non-empty tiles in order
+            */
+            const std::vector<Tile>& getTiles() const { return m_tiles; }
+
+            /*!
+            \brief Returns the runs of non-empty tiles, sorted by position
+            */
+            const std::vector<Run>& getRuns() const { return m_runs; }
+
+            /*!
+            \brief Returns the tile at the given position, which is an
+            empty tile if the position is not in any run.
+            This is a binary search of the runs.
+            */
+            Tile getTile(std::size_t position) const;
+
+            /*!
+            \brief Calls func with the position and tile of each non-empty
+            tile in order. func takes a std::size_t and a const Tile&.
+            */
+            template <typename Func>
+            void forEach(Func&& func) const
+            {
+                for (const auto& run : m_runs)
+                {
+                    for (auto i = 0u; i < run.count; ++i)
+                    {
+                        func(std::size_t(run.start) + i, m_tiles[run.first + i]);
+                    }
+                }
+            }
+
+        private:
+            friend class TileLayer;
+            friend class detail::CompiledMap;
+
+            std::vector<Run> m_runs;
+            std::vector<Tile> m_tiles;
+            std::size_t m_size = 0;
+
+            void append(const std::uint32_t* GIDs, std::size_t count);
+            void finish();
+            void pack(std::size_t first, std::size_t count, std::uint32_t* dest) const;
+        };
+
+        /*!
+        \brief Represents a chunk of tile data, if this is an infinite map.
+        The tiles are stored in tiles, in tileIDs and flipFlags if the
+        map was loaded with Map::TileStorage::Arrays, in GIDs if it
+        was loaded with Map::TileStorage::GIDs, or in palette if it was
+        loaded with Map::TileStorage::Palette, leaving the other forms
+        empty. If the layer was stored as sparse tiles, because it has
+        few enough non-empty tiles, they are instead all in sparse.
+        \see hasTileArrays()
+        \see hasGIDs()
+        \see hasPalette()
+        \see isSparse()
         */
         struct Chunk final
         {
             Vector2i position; //<! coordinate in tiles, not pixels
             Vector2i size; //!< size in tiles, not pixels
             std::vector<Tile> tiles;
-            const cJSON *dataNode;
+            std::vector<std::uint32_t> tileIDs; //!< Global IDs of the tiles when stored as arrays
+            std::vector<std::uint8_t> flipFlags; //!< Flip flags of the tiles when stored as arrays
+            std::vector<std::uint32_t> GIDs; //!< Global IDs with the flip flags in the top bits, when stored as GIDs
+            Palette palette; //!< Tiles when stored as a palette
+            SparseTiles sparse; //!< Tiles when stored as sparse tiles
         };
 
         /*!
@@ -83,15 +276,110 @@ namespace tmx
 
         Type getType() const override { return Layer::Type::Tile; }
         virtual bool parse(const struct cJSON&, Map*) override;
+        virtual bool parseStream(tmx::detail::JsonReader&, Map*) override;
         std::vector<uint32_t> parseTileIds(const struct cJSON& node, std::size_t tileCount);
         bool parseChunks(const struct cJSON& chunksNode);
         /*!
         \brief Returns the list of tiles used to make up the layer
         If this is empty then the map is most likely infinite, in
         which case the tile data is stored in chunks.
+        If the map was loaded with Map::TileDecoding::Lazy the tile
+        data is decoded by the first call to this or getChunks().
+        If the map was loaded with any other Map::TileStorage the list
+        is created from the stored form by the first call, after which the
+        layer holds both. This does not apply to the tiles of chunks.
         \see getChunks()
         */
-        const std::vector<Tile>& getTiles() const { return m_tiles; }
+        const std::vector<Tile>& getTiles() const { requireTiles(); return m_tiles; }
+
+        /*!
+        \brief Returns the global IDs of the tiles of the layer, without
+        their flip flags, in the same order as getTiles().
+        These are stored separately from the flip flags if the map was
+        loaded with Map::TileStorage::Arrays, otherwise they are created
+        from the stored tiles by the first call to this or getFlipFlags().
+        \see getFlipFlags()
+        */
+        Span<std::uint32_t> getTileIDs() const { requireArrays(); return { m_tileIDs.data(), m_tileIDs.size() }; }
+
+        /*!
+        \brief Returns the flip flags of each tile of the layer, in the
+        same order as getTileIDs().
+        \see FlipFlag
+        */
+        Span<std::uint8_t> getFlipFlags() const { requireArrays(); return { m_flipFlags.data(), m_flipFlags.size() }; }
+
+        /*!
+        \brief Returns true if the tiles of this layer, and of its chunks,
+        are stored in separate arrays of IDs and flip flags rather than
+        in lists of Tile.
+        \see Map::TileStorage
+        */
+        bool hasTileArrays() const { if (!isDecoded()) decodeAll(); return m_storage == Storage::Arrays; }
+
+        /*!
+        \brief Returns the GIDs of the tiles of the layer as they appear in
+        the map data, with the flip flags in the top four bits, in the
+        same order as getTiles().
+        These are stored as decoded if the map was loaded with
+        Map::TileStorage::GIDs, in which case no list of tiles is created,
+        otherwise they are created from the stored tiles by the first call.
+        \see decodeGIDs()
+        */
+        Span<std::uint32_t> getGIDs() const { require(Storage::GIDs); return { m_GIDs.data(), m_GIDs.size() }; }
+
+        /*!
+        \brief Writes up to count GIDs of the layer, with the flip flags in
+        the top four bits, to dest and returns the number written.
+        If the layer has not yet been decoded, because the map was loaded
+        with Map::TileDecoding::Lazy, the GIDs are decoded from the map data
+        straight into dest, for example a mapped GPU buffer, and the layer
+        is left undecoded. Otherwise they are copied from the stored tiles.
+        This does not include the tiles of chunks.
+        \returns The number of GIDs written, which is less than count if
+        the layer has fewer tiles, or 0 if the data could not be decoded.
+        \see getGIDs()
+        */
+        std::size_t decodeGIDs(std::uint32_t* dest, std::size_t count) const;
+
+        /*!
+        \brief Returns true if the tiles of this layer, and of its chunks,
+        are stored as the GIDs read from the map rather than as lists of Tile.
+        \see Map::TileStorage
+        */
+        bool hasGIDs() const { if (!isDecoded()) decodeAll(); return m_storage == Storage::GIDs; }
+
+        /*!
+        \brief Returns the tiles of the layer as a palette of distinct tiles
+        and an index for each tile, in the same order as getTiles().
+        These are stored as decoded if the map was loaded with
+        Map::TileStorage::Palette, otherwise they are created from the
+        stored tiles by the first call.
+        */
+        const Palette& getPalette() const { require(Storage::Palette); return m_palette; }
+
+        /*!
+        \brief Returns true if the tiles of this layer, and of its chunks,
+        are stored as a Palette rather than as lists of Tile.
+        \see Map::TileStorage
+        */
+        bool hasPalette() const { if (!isDecoded()) decodeAll(); return m_storage == Storage::Palette; }
+
+        /*!
+        \brief Returns the tiles of the layer as runs of non-empty tiles.
+        These are stored as decoded if the proportion of non-empty tiles
+        in the layer and its chunks is below Map::getSparseThreshold(),
+        in which case no other form is stored, otherwise they are created
+        from the stored tiles by the first call.
+        */
+        const SparseTiles& getSparseTiles() const { require(Storage::Sparse); return m_sparse; }
+
+        /*!
+        \brief Returns true if the tiles of this layer, and of its chunks,
+        are stored as SparseTiles.
+        \see Map::setSparseThreshold()
+        */
+        bool isSparse() const { if (!isDecoded()) decodeAll(); return m_storage == Storage::Sparse; }
 
         /*!
         \brief Returns a vector of chunks which make up this layer
@@ -99,25 +387,194 @@ namespace tmx
         is not infinite.
         \see getTiles()
         */
-        const std::vector<Chunk>& getChunks() const { return m_chunks; }
+        const std::vector<Chunk>& getChunks() const { if (!isDecoded()) decodeAll(); return m_chunks; }
+
+        /*!
+        \brief Returns the chunk containing the tile at the given
+        coordinates, in tiles, or nullptr if there is none.
+        Chunks are found with an index built when the layer is decoded,
+        in constant time if all the chunks are the same size and lie on
+        a grid of that size, as they do when saved by Tiled.
+        \see getChunks()
+        */
+        const Chunk* getChunk(int x, int y) const;
+
+        /*!
+        \brief Returns the tile at the given coordinates, in tiles, in the
+        same way for finite layers and for the chunks of infinite layers,
+        and whichever form the tiles are stored in.
+        Coordinates outside the layer, or outside any chunk, return an
+        empty tile. This is constant time except for sparse layers, which
+        search the runs of their tiles.
+        */
+        Tile getTile(int x, int y) const;
+
+        /*!
+        \brief Decodes the tile data of this layer if it has not yet been
+        decoded, releasing the encoded data. Safe to call from multiple threads.
+        \see Map::TileDecoding
+        */
+        void decodeAll() const;
+
+        /*!
+        \brief Returns true once the tile data of the layer has been decoded
+        */
+        bool isDecoded() const { return m_decoded.load(std::memory_order_acquire); }
 
         const Vector2u &getSize() const { return m_size; }
 
     private:
-        const struct cJSON* m_dataNode = nullptr;
-        const struct cJSON* m_chunkNode = nullptr;
+        friend class detail::CompiledMap;
+
         EncodingType m_encoding;
         Vector2u m_size;
         std::vector<Tile> m_tiles;
+        std::vector<std::uint32_t> m_tileIDs;
+        std::vector<std::uint8_t> m_flipFlags;
+        std::vector<std::uint32_t> m_GIDs;
+        Palette m_palette;
+        SparseTiles m_sparse;
         std::vector<Chunk> m_chunks;
         std::size_t m_tileCount;
         CompressionType m_compression;
-        void parseBase64(const cJSON&);
-        void parseCSV(const cJSON&);
+        const ZstdDictionary* m_zstdDictionary;
 
-        void createTiles(const std::vector<std::uint32_t>&, std::vector<Tile>& destination);
+        //tile data as read from the map, which is kept until
+        //the layer is decoded. The data is either a base64
+        //string or a list of IDs depending on the encoding.
+        struct PendingChunk final
+        {
+            Chunk chunk;
+            std::string encoded;
+            std::vector<std::uint32_t> IDs;
+        };
+        std::string m_encodedData;
+        std::vector<std::uint32_t> m_pendingIDs;
+        std::vector<PendingChunk> m_pendingChunks;
+        bool m_hasData;
+
+        mutable std::atomic<bool> m_decoded;
+        mutable std::mutex m_decodeMutex;
+
+        //the form the tiles are stored in, as set by Map::TileStorage,
+        //or Sparse once the layer is found to be below the threshold.
+        //m_forms has the bit of each form which the layer holds, as
+        //other forms are created from the stored one when requested
+        enum class Storage : std::uint8_t
+        {
+            Tiles = 0x1,
+            Arrays = 0x2,
+            GIDs = 0x4,
+            Palette = 0x8,
+            Sparse = 0x10
+        };
+        Storage m_storage;
+        Storage m_denseStorage;
+        float m_sparseThreshold;
+        mutable std::atomic<std::uint8_t> m_forms;
+        void require(Storage form) const
+        {
+            if (!isDecoded()) decodeAll();
+            if ((m_forms.load(std::memory_order_acquire) & static_cast<std::uint8_t>(form)) == 0) convertStorage(form);
+        }
+        void requireTiles() const { require(Storage::Tiles); }
+        void requireArrays() const { require(Storage::Arrays); }
+        void convertStorage(Storage) const;
+        void setStorage(Storage, float sparseThreshold);
+        static Storage getStorage(const Map&);
+
+        void readTileData(const cJSON&, std::vector<std::uint32_t>& IDs, std::string& encoded);
+        void readChunks(const cJSON&);
+        bool readTileData(tmx::detail::JsonReader&, std::size_t expectedCount,
+            std::vector<std::uint32_t>& IDs, std::string& encoded);
+        bool readChunks(tmx::detail::JsonReader&);
+        void parseComplete(Map*);
+        void decode();
+
+        //decoding is split into independent tasks, one for each chunk
+        //and one for the layer data, so that the Map can run the tasks
+        //of all its layers concurrently
+        friend class Map;
+        std::size_t getDecodeTaskCount() const;
+        void decodeTask(std::size_t index);
+        void finishDecode();
+        std::vector<std::uint32_t> decodeBase64(const char* data, std::size_t length, std::size_t tileCount);
+
+        //number of GIDs decoded at a time when reading base64 data
+        static constexpr std::size_t DecodeBlockSize = 1024;
+
+        //the containers the tiles of the layer or of a chunk are
+        //stored in, of which only those matching m_storage are used
+        struct TileStore final
+        {
+            std::vector<Tile>& tiles;
+            std::vector<std::uint32_t>& tileIDs;
+            std::vector<std::uint8_t>& flipFlags;
+            std::vector<std::uint32_t>& GIDs;
+            Palette& palette;
+            SparseTiles& sparse;
+        };
+        TileStore getStore() { return { m_tiles, m_tileIDs, m_flipFlags, m_GIDs, m_palette, m_sparse }; }
+        static TileStore getStore(Chunk& chunk) { return { chunk.tiles, chunk.tileIDs, chunk.flipFlags, chunk.GIDs, chunk.palette, chunk.sparse }; }
+
+        //the number of tiles in the store, and their GIDs from
+        //the given position, read from the stored form
+        std::size_t getStoredCount(const TileStore&) const;
+        void packGIDs(const TileStore&, std::size_t first, std::size_t count, std::uint32_t* dest) const;
+
+        //stores the layer and its chunks, decoded as SparseTiles,
+        //in the set form instead if they are above the threshold
+        void applySparseThreshold();
+        void storeDense();
+        void reserveTiles(const TileStore&, std::size_t count);
+
+        //the tile at the given index of the store, read from the stored form
+        Tile getStoredTile(const TileStore&, std::size_t index) const;
+
+        //chunks indexed by the cell they occupy on a grid of the chunk
+        //size, built once decoded. m_chunkGrid holds the index of the
+        //chunk in each cell within their bounds, or -1, if they fill
+        //enough of them, otherwise m_chunkMap holds the index of each
+        //occupied cell. m_chunkSize is 0 if the chunks don't lie on such
+        //a grid, in which case they are searched instead
+        Vector2i m_chunkOrigin;
+        Vector2i m_chunkSize;
+        Vector2i m_chunkGridStart;
+        Vector2i m_chunkGridSize;
+        std::vector<std::int32_t> m_chunkGrid;
+        std::unordered_map<std::uint64_t, std::uint32_t> m_chunkMap;
+        void buildChunkIndex();
+
+        void decodeTiles(const char* data, std::size_t length, std::size_t tileCount, const TileStore& store);
+
+        //appends the GIDs to the store in the form given by m_storage
+        void createTiles(const std::uint32_t* source, std::size_t count, const TileStore& store);
     };
 
+    template <typename T>
+    Span<T> TileLayer::Palette::getIndices() const
+    {
+        return {};
+    }
+
+    template <>
+    inline Span<std::uint8_t> TileLayer::Palette::getIndices<std::uint8_t>() const
+    {
+        return { m_indices8.data(), m_indices8.size() };
+    }
+
+    template <>
+    inline Span<std::uint16_t> TileLayer::Palette::getIndices<std::uint16_t>() const
+    {
+        return { m_indices16.data(), m_indices16.size() };
+    }
+
+    template <>
+    inline Span<std::uint32_t> TileLayer::Palette::getIndices<std::uint32_t>() const
+    {
+        return { m_indices32.data(), m_indices32.size() };
+    }
+
     template <>
     inline TileLayer& Layer::getLayerAs<TileLayer>()
     {
@@ -34,12 +34,21 @@ source distribution.
 #include <string>
 #include <vector>
 #include <array>
+#include <memory>
 
 struct cJSON;
 
 namespace tmx
 {
     class Map;
+    class TilesetCache;
+    class UVTable;
+    namespace detail
+    {
+        class JsonReader;
+        class CompiledMap;
+        enum class Key : std::uint16_t;
+    }
 
     /*!
     \brief Represents a Tileset node as loaded
@@ -50,7 +59,6 @@ namespace tmx
     {
     public:
         explicit Tileset(const std::string& workingDir = "");
-        ~Tileset();
 
         /*!
         \brief Any tiles within a tile set which have special
@@ -87,17 +95,71 @@ namespace tmx
                         return !(*this == other);
                     }
                 };
-                std::vector<Frame> frames;
+                Vector<Frame> frames;
             }animation;
-            std::vector<Property> properties;
+            Vector<Property> properties;
             ObjectGroup objectGroup;
-            std::string imagePath;
+            String imagePath;
             Vector2u imageSize;
             /*!
             \brief The position of the tile within the image.
             */
             Vector2u imagePosition;
-            std::string className;
+            String className;
+        };
+
+        /*!
+        \brief A lightweight view of a tile in the tile set, as returned
+        by getTile().
+        Only tiles which are declared in the tile set, for example to
+        give them properties or an animation, are stored as a Tile. The
+        image position, size and path of any other tile are calculated
+        from the tile set when they are requested.
+        */
+        class TMXLITE_EXPORT_API TileView final
+        {
+        public:
+            TileView() = default;
+
+            /*!
+            \brief Returns false if the view does not refer to a tile,
+            because the requested ID was not part of the tile set
+            */
+            explicit operator bool() const { return m_tileset != nullptr; }
+
+            /*!
+            \brief Returns the ID of the tile within the tile set
+            */
+            std::uint32_t getID() const { return m_ID; }
+
+            /*!
+            \brief Returns the data stored for the tile, or nullptr if
+            the tile set declares nothing for this tile other than its
+            image.
+            */
+            const Tile* getData() const { return m_tile; }
+
+            /*!
+            \brief Returns the position of the tile within the image
+            */
+            Vector2u getImagePosition() const;
+
+            /*!
+            \brief Returns the size of the tile's image in pixels
+            */
+            Vector2u getImageSize() const;
+
+            /*!
+            \brief Returns the path to the image containing the tile
+            */
+            const String& getImagePath() const;
+
+        private:
+            friend class Tileset;
+
+            const Tileset* m_tileset = nullptr;
+            const Tile* m_tile = nullptr;
+            std::uint32_t m_ID = 0;
         };
             
         /*!
@@ -106,9 +168,9 @@ namespace tmx
         */
         struct Terrain final
         {
-            std::string name;
+            String name;
             std::uint32_t tileID = -1;
-            std::vector<Property> properties;
+            Vector<Property> properties;
         };
 
         /*!
@@ -144,6 +206,15 @@ namespace tmx
         */
         bool loadWithoutMapFromString(const std::string& xmlStr);
 
+        /**
+        \brief Loads the tilemap from data stored in memory, which does
+        not need to be null terminated.
+        This does not set the first GID.
+        This does not support templates.
+        Usually tilemaps are loaded automatically as part of a Map instead.
+        */
+        bool loadWithoutMapFromMemory(const char* data, std::size_t size);
+
         /*!
         \brief Attempts to parse the given xml node as part of a map.
         If node parsing fails, an error is printed in the console
@@ -151,6 +222,13 @@ namespace tmx
         */
         bool parse(const cJSON&, Map*);
 
+        /*!
+        \brief Parses the tile set at the reader's current position as
+        part of a map, without building a document tree.
+        \see parse()
+        */
+        bool parse(tmx::detail::JsonReader&, Map*);
+
         /*!
         \brief Returns the first GID of this tile set.
         This the ID of the first tile in the tile set, so that
@@ -173,39 +251,39 @@ namespace tmx
         /*!
         \brief Returns the name of this tile set.
         */
-        const std::string& getName() const { return m_name; }
+        const String& getName() const { return data().m_name; }
 
         /*!
         \brief Returns the class of the Tileset, as defined in the editor Tiled 1.9+
         */
-        const std::string& getClass() const { return m_class; }
+        const String& getClass() const { return data().m_class; }
 
         /*!
         \brief Returns the width and height of a tile in the
         tile set, in pixels.
         */
-        const Vector2u& getTileSize() const { return m_tileSize; }
+        const Vector2u& getTileSize() const { return data().m_tileSize; }
 
         /*!
         \brief Returns the spacing, in pixels, between each tile in the set
         */
-        std::uint32_t getSpacing() const { return m_spacing; }
+        std::uint32_t getSpacing() const { return data().m_spacing; }
 
         /*!
         \brief Returns the margin, in pixels, around each tile in the set
         */
-        std::uint32_t getMargin() const { return m_margin; }
+        std::uint32_t getMargin() const { return data().m_margin; }
 
         /*!
         \brief Returns the number of tiles in the tile set
         */
-        std::uint32_t getTileCount() const { return m_tileCount; }
+        std::uint32_t getTileCount() const { return data().m_tileCount; }
 
         /*!
         \brief Returns the number of columns which make up the tile set.
         This is used when rendering collection of images sets
         */
-        std::uint32_t getColumnCount() const { return m_columnCount; }
+        std::uint32_t getColumnCount() const { return data().m_columnCount; }
 
         /*!
         \brief Returns the alignment of tile objects.
@@ -214,55 +292,57 @@ namespace tmx
         orthogonal mode and Bottom in isometric mode.
         \see ObjectAlignment
         */
-        ObjectAlignment getObjectAlignment() const { return m_objectAlignment; }
+        ObjectAlignment getObjectAlignment() const { return data().m_objectAlignment; }
 
         /*!
         \brief Returns the tile offset in pixels.
         Tile will draw tiles offset from the top left using this value.
         */
-        const Vector2u& getTileOffset() const { return m_tileOffset; }
+        const Vector2u& getTileOffset() const { return data().m_tileOffset; }
 
         /*!
         \brief Returns a reference to the list of Property objects for this
         tile set
         */
-        const std::vector<Property>& getProperties() const { return m_properties; }
+        const Vector<Property>& getProperties() const { return data().m_properties; }
 
         /*!
         \brief Returns the file path to the tile set image, relative to the
         working directory. Use this to load the texture required by whichever
         method you choose to render the map.
         */
-        const std::string& getImagePath() const { return m_imagePath; }
+        const String& getImagePath() const { return data().m_imagePath; }
 
         /*!
         \brief Returns the size of the tile set image in pixels.
          */
-        const Vector2u& getImageSize() const { return m_imageSize; }
+        const Vector2u& getImageSize() const { return data().m_imageSize; }
 
         /*!
         \brief Returns the colour used by the tile map image to represent transparency.
         By default this is a transparent colour (0, 0, 0, 0)
         */
-        const Colour& getTransparencyColour() const { return m_transparencyColour; }
+        const Colour& getTransparencyColour() const { return data().m_transparencyColour; }
 
         /*!
         \brief Returns true if the image used by this tileset specifically requests
         a colour to use as transparency.
         */
-        bool hasTransparency() const { return m_hasTransparency; }
+        bool hasTransparency() const { return data().m_hasTransparency; }
 
         /*!
         \brief Returns a vector of Terrain types associated with one
         or more tiles within this tile set
         */
-        const std::vector<Terrain>& getTerrainTypes() const { return m_terrainTypes; }
+        const Vector<Terrain>& getTerrainTypes() const { return data().m_terrainTypes; }
 
         /*!
         \brief Returns a reference to the vector of tile data used by
         tiles which make up this tile set.
+        Only the tiles which are declared in the tile set are stored,
+        use getTile() to read the image details of any other tile.
         */
-        const std::vector<Tile>& getTiles() const { return m_tiles; }
+        const Vector<Tile>& getTiles() const { return data().m_tiles; }
 
         /*!
          \brief Checks if a tiled ID is in the range of the first ID and the last ID
@@ -274,21 +354,26 @@ namespace tmx
         /*!
          \brief queries tiles and returns a tile with the given ID. Checks if the TileID is part of the Tileset with `hasTile(id)`
          \param id Tile ID. The Tile ID will be corrected internally.
-         \return In case of a success it returns the correct tile. In terms of failure it will return a nullptr.
+         \return In case of a success it returns a view of the tile. In terms of failure the view converts to false.
          */
-        const Tile* getTile(std::uint32_t id) const;
+        TileView getTile(std::uint32_t id) const;
 
         static Tileset readTileset(const cJSON& node, tmx::Map* map, bool &parseSuccess);
-        static std::vector<Tileset> readTilesets(const cJSON& node, tmx::Map* map);
+        static Vector<Tileset> readTilesets(const cJSON& node, tmx::Map* map);
+        static Vector<Tileset> readTilesets(tmx::detail::JsonReader& reader, tmx::Map* map);
 
     private:
+        friend class Map;
+        friend class TilesetCache;
+        friend class UVTable;
+        friend class detail::CompiledMap;
 
         std::string m_workingDir;
 
         std::uint32_t m_firstGID;
-        std::string m_source;
-        std::string m_name;
-        std::string m_class;
+        String m_source;
+        String m_name;
+        String m_class;
         Vector2u m_tileSize;
         std::uint32_t m_spacing;
         std::uint32_t m_margin;
@@ -297,25 +382,40 @@ namespace tmx
         ObjectAlignment m_objectAlignment;
         Vector2u m_tileOffset;
 
-        std::vector<Property> m_properties;
-        std::string m_imagePath;
+        Vector<Property> m_properties;
+        String m_imagePath;
         Vector2u m_imageSize;
         Colour m_transparencyColour;
         bool m_hasTransparency;
-        cJSON *m_doc;
 
-        std::vector<Terrain> m_terrainTypes;
-        std::vector<std::uint32_t> m_tileIndex;
-        std::vector<Tile> m_tiles;
+        Vector<Terrain> m_terrainTypes;
+        Vector<std::uint32_t> m_tileIndex;
+        Vector<Tile> m_tiles;
+
+        //tile sets loaded through a TilesetCache refer to the
+        //shared data instead of storing their own copy
+        std::shared_ptr<const Tileset> m_shared;
+        const Tileset& data() const { return m_shared ? *m_shared : *this; }
 
         //always returns false so we can return this
         //on load failure
         bool reset();
 
+        //loads the external tile set file referred to by a map,
+        //unless the map has already loaded it ahead of parsing
+        bool loadExternal(const std::string& path, Map&);
+
+        //loads a tile set file with its animation frames offset by
+        //the given first GID, through the cache if there is one
+        bool loadFile(const std::string& path, TilesetCache*, std::uint32_t firstGID);
+        void offsetFrames(std::uint32_t firstGID);
+
+        void parseAttribute(tmx::detail::Key, const cJSON&);
+        bool parseComplete(const cJSON* tilesNode, Map*);
         void parseOffsetNode(const cJSON&);
         void parseTerrainNode(const cJSON&);
         Tile& newTile(std::uint32_t ID);
         void parseTileNode(const cJSON&, Map*);
-        void createMissingTile(std::uint32_t ID);
+        Vector2u getImagePosition(std::uint32_t ID) const;
     };
 }
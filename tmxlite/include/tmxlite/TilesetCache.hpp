@@ -0,0 +1,97 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#pragma once
+
+#include <tmxlite/Config.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace tmx
+{
+    class Tileset;
+
+    /*!
+    \brief Shares the external tile sets loaded by any number of maps.
+    A cache is opt-in, and is used by passing it to Map::setTilesetCache()
+    before loading a map. Tile sets are stored by their resolved path and
+    are loaded only once, after which each map refers to the same
+    immutable data with its own first GID.
+    A single cache may be used by maps loading on any thread, and must
+    outlive any map which is loading with it. Maps which have finished
+    loading keep their tile sets alive even if the cache is cleared or
+    destroyed.
+    */
+    class TMXLITE_EXPORT_API TilesetCache final
+    {
+    public:
+        TilesetCache() = default;
+
+        TilesetCache(const TilesetCache&) = delete;
+        TilesetCache& operator = (const TilesetCache&) = delete;
+
+        /*!
+        \brief Returns the tile set loaded from the given path, loading it
+        if it is not already in the cache.
+        \param path Resolved path to the tile set file
+        \param firstGID The first GID the tile set is used with. Tile sets
+        containing animations store the tile IDs of each frame as GIDs, so
+        a copy of these is kept for each first GID they are used with.
+        \returns nullptr if the tile set failed to load
+        */
+        std::shared_ptr<const Tileset> get(const std::string& path, std::uint32_t firstGID = 0);
+
+        /*!
+        \brief Returns the number of tile set files in the cache
+        */
+        std::size_t size() const;
+
+        /*!
+        \brief Removes any tile sets which are no longer used by a map
+        \returns The number of tile set files removed
+        */
+        std::size_t removeUnused();
+
+        /*!
+        \brief Removes all tile sets from the cache
+        */
+        void clear();
+
+    private:
+        struct Entry final
+        {
+            std::shared_ptr<const Tileset> tileset;
+            bool animated = false;
+            std::unordered_map<std::uint32_t, std::shared_ptr<const Tileset>> offsetTilesets;
+        };
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::string, Entry> m_entries;
+    };
+}
@@ -29,6 +29,7 @@ source distribution.
 
 #include <tmxlite/Config.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <ostream>
 
@@ -103,6 +104,32 @@ namespace tmx
     using FloatRect = Rectangle<float>;
     using IntRect = Rectangle<int>;
 
+    /*!
+    \brief A read only view of contiguous values, such as the tile IDs
+    of a tile layer. A span does not own its values, which remain valid
+    only as long as the object which returned the span.
+    */
+    template <class T>
+    class Span final
+    {
+    public:
+        Span() : m_data(nullptr), m_size(0) {}
+        Span(const T* data, std::size_t size) : m_data(data), m_size(size) {}
+
+        const T* data() const { return m_data; }
+        std::size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+
+        const T* begin() const { return m_data; }
+        const T* end() const { return m_data + m_size; }
+
+        const T& operator [] (std::size_t index) const { return m_data[index]; }
+
+    private:
+        const T* m_data;
+        std::size_t m_size;
+    };
+
     /*!
     \brief Contains the red, green, blue and alpha values of a colour
     in the range 0 - 255.
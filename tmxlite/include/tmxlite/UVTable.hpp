@@ -0,0 +1,108 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#pragma once
+
+#include <tmxlite/Config.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tmx
+{
+    class Tileset;
+
+    /*!
+    \brief Normalised texture coordinates for every tile of a tile set,
+    calculated once from the tile set's image size, tile size, margin
+    and spacing.
+    Each tile has a quad for each of the 8 combinations of the
+    TileLayer::FlipFlag values, so that flipped and rotated tiles need no
+    work when they are drawn. A quad is 8 floats, the u and v coordinates
+    of the top left, top right, bottom right and bottom left corners of
+    the tile as it appears on screen. Quads are stored contiguously, by
+    tile ID then by flip flags, so the whole table can be uploaded to
+    the GPU with getData() and indexed with getIndex().
+    Tiles with an image of their own, as in image collection tile sets,
+    are normalised to the size of that image.
+    */
+    class TMXLITE_EXPORT_API UVTable final
+    {
+    public:
+        static constexpr std::size_t QuadSize = 8; //!< floats in each quad
+        static constexpr std::size_t VariantCount = 8; //!< quads for each tile
+
+        UVTable() = default;
+        explicit UVTable(const Tileset&);
+
+        /*!
+        \brief Calculates the quads of every tile in the given tile set,
+        replacing any existing ones
+        */
+        void build(const Tileset&);
+
+        /*!
+        \brief Returns the number of tiles in the table
+        */
+        std::size_t getTileCount() const { return m_tileCount; }
+
+        bool empty() const { return m_tileCount == 0; }
+
+        void clear();
+
+        /*!
+        \brief Returns the index in getData() of the quad for the given
+        tile ID and flip flags.
+        \param tileID ID of the tile within the tile set, ie the GID less
+        the tile set's first GID
+        \param flipFlags The tile's TileLayer::FlipFlag values. Any other
+        bits are ignored.
+        */
+        static std::size_t getIndex(std::uint32_t tileID, std::uint8_t flipFlags)
+        {
+            return (std::size_t(tileID) * VariantCount + ((flipFlags >> 1) & 0x7)) * QuadSize;
+        }
+
+        /*!
+        \brief Returns the 8 floats of the quad for the given tile ID and
+        flip flags, or nullptr if the tile ID is not in the table
+        \see getIndex()
+        */
+        const float* getQuad(std::uint32_t tileID, std::uint8_t flipFlags = 0) const
+        {
+            return tileID < m_tileCount ? &m_uvs[getIndex(tileID, flipFlags)] : nullptr;
+        }
+
+        /*!
+        \brief Returns the quads of all the tiles
+        */
+        const std::vector<float>& getData() const { return m_uvs; }
+
+    private:
+        std::vector<float> m_uvs;
+        std::size_t m_tileCount = 0;
+    };
+}
@@ -0,0 +1,94 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#include <tmxlite/Config.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct ZSTD_DDict_s;
+
+namespace tmx
+{
+    namespace detail
+    {
+        class TileDataReader;
+    }
+
+    /*!
+    \brief A zstd dictionary used to decompress tile layer data.
+    Maps whose layers or chunks are each compressed with the same
+    dictionary, for example one trained with zstd --train on the chunks
+    of a set of infinite maps, can be loaded by passing the dictionary
+    to Map::setZstdDictionary() before loading the map.
+    Dictionaries are only available when the library is built with
+    USE_ZSTD or USE_EXTLIBS. A dictionary may be used by maps loading
+    on any thread, and must outlive any map whose tile data has not
+    yet been decoded with it.
+    */
+    class TMXLITE_EXPORT_API ZstdDictionary final
+    {
+    public:
+        ZstdDictionary();
+        ~ZstdDictionary();
+
+        ZstdDictionary(const ZstdDictionary&) = delete;
+        ZstdDictionary& operator = (const ZstdDictionary&) = delete;
+
+        /*!
+        \brief Loads a dictionary from the file at the given path
+        \returns false if the file could not be read, the dictionary
+        is invalid or the library was built without zstd support
+        */
+        bool loadFromFile(const std::string& path);
+
+        /*!
+        \brief Loads a dictionary from memory. The data is copied, so
+        does not need to outlive the dictionary.
+        \returns false if the dictionary is invalid or the library was
+        built without zstd support
+        */
+        bool loadFromMemory(const void* data, std::size_t size);
+
+        /*!
+        \brief Returns true if a dictionary is loaded
+        */
+        bool isLoaded() const { return m_dictionary != nullptr; }
+
+        /*!
+        \brief Returns the ID stored in the loaded dictionary, or 0 if
+        no dictionary is loaded or the dictionary has no ID
+        */
+        std::uint32_t getID() const;
+
+    private:
+        friend class detail::TileDataReader;
+        ZSTD_DDict_s* m_dictionary;
+
+        void release();
+    };
+}
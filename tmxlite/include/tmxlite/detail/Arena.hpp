@@ -0,0 +1,179 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#pragma once
+
+#include <tmxlite/Config.hpp>
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tmx
+{
+#ifdef TMXLITE_USE_ARENA
+    namespace detail
+    {
+        /*!
+        \brief Monotonic arena from which a Map allocates the strings and
+        vectors belonging to its layers, objects, tile sets and properties.
+        Individual deallocations are ignored, the memory is returned in one
+        go when the arena is released or destroyed.
+        */
+        class TMXLITE_EXPORT_API Arena final
+        {
+        public:
+            Arena();
+            ~Arena();
+
+            Arena(const Arena&) = delete;
+            Arena& operator = (const Arena&) = delete;
+
+            /*!
+            \brief Moving an arena swaps the blocks with the source, so that
+            memory still referenced by the destination's previous contents
+            remains valid until the source is released.
+            */
+            Arena(Arena&&) noexcept;
+            Arena& operator = (Arena&&) noexcept;
+
+            void* allocate(std::size_t size);
+
+            /*!
+            \brief Frees all memory held by the arena. Anything allocated
+            from it must have been destroyed first.
+            */
+            void release();
+
+            /*!
+            \brief Returns the number of bytes reserved by the arena
+            */
+            std::size_t getCapacity() const;
+
+            /*!
+            \brief Directs allocations made through ArenaAllocator on the
+            calling thread to the given arena for the lifetime of the Scope.
+            Scopes may be nested, and a default constructed Scope directs
+            allocations back to the heap.
+            */
+            class TMXLITE_EXPORT_API Scope final
+            {
+            public:
+                Scope();
+                explicit Scope(Arena&);
+                ~Scope();
+
+                Scope(const Scope&) = delete;
+                Scope& operator = (const Scope&) = delete;
+
+            private:
+                Arena* m_previous;
+            };
+
+        private:
+            struct Block;
+            Block* m_head;
+        };
+
+        TMXLITE_EXPORT_API void* arenaAllocate(std::size_t size);
+        TMXLITE_EXPORT_API void arenaDeallocate(void* ptr) noexcept;
+
+        /*!
+        \brief Stateless allocator which takes its memory from the arena of
+        the current Arena::Scope, or from the heap when no scope is active.
+        Allocations larger than a few kilobytes, such as the storage of
+        large vectors, always come from the heap so that they can be freed
+        as the vector grows.
+        As all instances compare equal containers can be moved and swapped
+        freely regardless of where their memory came from.
+        */
+        template <typename T>
+        struct ArenaAllocator
+        {
+            using value_type = T;
+
+            ArenaAllocator() = default;
+            template <typename U>
+            ArenaAllocator(const ArenaAllocator<U>&) {}
+
+            T* allocate(std::size_t count)
+            {
+                return static_cast<T*>(arenaAllocate(count * sizeof(T)));
+            }
+
+            void deallocate(T* ptr, std::size_t)
+            {
+                arenaDeallocate(ptr);
+            }
+
+            template <typename U>
+            bool operator == (const ArenaAllocator<U>&) const { return true; }
+            template <typename U>
+            bool operator != (const ArenaAllocator<U>&) const { return false; }
+        };
+    }
+
+    using String = std::basic_string<char, std::char_traits<char>, detail::ArenaAllocator<char>>;
+    template <typename T>
+    using Vector = std::vector<T, detail::ArenaAllocator<T>>;
+
+    namespace detail
+    {
+        //conversions between String and the std::string used by the
+        //file handling functions, which are free when the arena is disabled
+        inline void assignString(String& dst, const std::string& src) { dst.assign(src.data(), src.size()); }
+        inline std::string toStdString(const String& src) { return std::string(src.data(), src.size()); }
+    }
+#else
+    namespace detail
+    {
+        //arena allocation is disabled, so this does nothing
+        class Arena final
+        {
+        public:
+            void release() {}
+            std::size_t getCapacity() const { return 0; }
+
+            class Scope final
+            {
+            public:
+                Scope() {}
+                explicit Scope(Arena&) {}
+            };
+        };
+    }
+
+    using String = std::string;
+    template <typename T>
+    using Vector = std::vector<T>;
+
+    namespace detail
+    {
+        inline void assignString(String& dst, std::string src) { dst = std::move(src); }
+        inline const std::string& toStdString(const String& src) { return src; }
+    }
+#endif //TMXLITE_USE_ARENA
+}
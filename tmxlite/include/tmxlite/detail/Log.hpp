@@ -36,6 +36,7 @@ source distribution.
 #include <fstream>
 #include <sstream>
 #include <list>
+#include <mutex>
 #include <ctime>
 
 #ifdef _MSC_VER
@@ -125,6 +126,7 @@ namespace tmx
                     std::cout << outstring << std::endl;
                 }
                 const std::size_t maxBuffer = 30;
+                std::lock_guard<std::mutex> lock(bufferMutex());
                 buffer().push_back(outstring);
                 if (buffer().size() > maxBuffer)buffer().pop_front(); //no majick here pl0x
                 updateOutString(maxBuffer);
@@ -163,6 +165,7 @@ namespace tmx
     private:
         static std::list<std::string>& buffer(){ static std::list<std::string> buffer; return buffer; }
         static std::string& stringOutput() { static std::string output; return output; }
+        static std::mutex& bufferMutex() { static std::mutex mutex; return mutex; }
         static void updateOutString(std::size_t maxBuffer)
         {
             static size_t count = 0;
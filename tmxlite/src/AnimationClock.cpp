@@ -0,0 +1,140 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#include <tmxlite/AnimationClock.hpp>
+#include <tmxlite/AnimationTable.hpp>
+#include "detail/Gid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace tmx;
+
+AnimationClock::AnimationClock()
+    : m_table   (nullptr),
+    m_time      (0.0)
+{
+
+}
+
+AnimationClock::AnimationClock(const AnimationTable& table)
+    : AnimationClock()
+{
+    reset(table);
+}
+
+//public
+void AnimationClock::reset(const AnimationTable& table)
+{
+    m_table = &table;
+    m_time = 0.0;
+    m_changed.clear();
+
+    const auto count = table.getAnimations().size();
+    m_currentGIDs.resize(count);
+    m_frameEnds.resize(count);
+    for (auto i = 0u; i < count; ++i)
+    {
+        updateAnimation(i);
+    }
+}
+
+void AnimationClock::update(double elapsed)
+{
+    setTime(m_time + elapsed);
+}
+
+void AnimationClock::setTime(double time)
+{
+    //going back in time means every animation is worked out again
+    const bool forward = time >= m_time;
+    m_time = time;
+    m_changed.clear();
+    if (!m_table)
+    {
+        return;
+    }
+
+    const auto count = m_table->getAnimations().size();
+    if (m_currentGIDs.size() != count)
+    {
+        m_currentGIDs.resize(count);
+        m_frameEnds.assign(count, 0.0);
+    }
+
+    for (auto i = 0u; i < count; ++i)
+    {
+        if (forward && time < m_frameEnds[i])
+        {
+            continue;
+        }
+
+        if (updateAnimation(i))
+        {
+            m_changed.push_back(i);
+        }
+    }
+}
+
+std::uint32_t AnimationClock::getGID(std::uint32_t GID) const
+{
+    if (!m_table)
+    {
+        return GID;
+    }
+
+    const auto index = m_table->findAnimation(GID);
+    if (index < 0
+        || static_cast<std::size_t>(index) >= m_currentGIDs.size())
+    {
+        return GID;
+    }
+    return m_currentGIDs[index] | (GID & detail::GIDFlagMask);
+}
+
+//private
+bool AnimationClock::updateAnimation(std::size_t index)
+{
+    const auto& animation = m_table->getAnimations()[index];
+    const auto frame = m_table->getFrameIndex(animation, m_time);
+
+    const auto GID = m_table->getFrameGIDs()[frame];
+    const bool changed = GID != m_currentGIDs[index];
+    m_currentGIDs[index] = GID;
+
+    if (animation.duration == 0)
+    {
+        m_frameEnds[index] = std::numeric_limits<double>::infinity();
+    }
+    else
+    {
+        //start of the current loop of the animation, plus the end of the frame
+        const auto time = std::max(m_time, 0.0);
+        const auto loopStart = time - std::fmod(time, static_cast<double>(animation.duration));
+        m_frameEnds[index] = loopStart + m_table->getFrameEnds()[frame];
+    }
+    return changed;
+}
@@ -0,0 +1,148 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#include <tmxlite/AnimationTable.hpp>
+#include <tmxlite/Map.hpp>
+#include "detail/Gid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace tmx;
+
+//public
+void AnimationTable::build(const Map& map)
+{
+    clear();
+
+    for (const auto& tileset : map.getTilesets())
+    {
+        for (const auto& tile : tileset.getTiles())
+        {
+            const auto& frames = tile.animation.frames;
+            if (frames.empty())
+            {
+                continue;
+            }
+
+            Animation animation;
+            animation.GID = tileset.getFirstGID() + tile.ID;
+            animation.firstFrame = static_cast<std::uint32_t>(m_frameGIDs.size());
+            animation.frameCount = static_cast<std::uint32_t>(frames.size());
+
+            //frame tile IDs are stored as GIDs by the tile set
+            for (const auto& frame : frames)
+            {
+                animation.duration += frame.duration;
+                m_frameGIDs.push_back(frame.tileID);
+                m_frameEnds.push_back(animation.duration);
+            }
+            m_animations.push_back(animation);
+        }
+    }
+
+    std::stable_sort(m_animations.begin(), m_animations.end(),
+        [](const Animation& a, const Animation& b)
+        {
+            return a.GID < b.GID;
+        });
+
+    //as with Map::getAnimatedTiles(), a GID found in more than one
+    //tile set uses the animation of the last
+    std::size_t count = 0;
+    for (auto i = 0u; i < m_animations.size(); ++i)
+    {
+        if (i + 1 < m_animations.size()
+            && m_animations[i + 1].GID == m_animations[i].GID)
+        {
+            continue;
+        }
+        m_animations[count++] = m_animations[i];
+    }
+    m_animations.resize(count);
+}
+
+std::int32_t AnimationTable::findAnimation(std::uint32_t GID) const
+{
+    GID &= ~detail::GIDFlagMask;
+    const auto result = std::lower_bound(m_animations.begin(), m_animations.end(), GID,
+        [](const Animation& animation, std::uint32_t value)
+        {
+            return animation.GID < value;
+        });
+
+    if (result == m_animations.end() || result->GID != GID)
+    {
+        return -1;
+    }
+    return static_cast<std::int32_t>(result - m_animations.begin());
+}
+
+std::uint32_t AnimationTable::getFrameIndex(const Animation& animation, double time) const
+{
+    if (animation.duration == 0)
+    {
+        return animation.firstFrame;
+    }
+
+    //the frame shown is the first which ends after the time, so
+    //frames with no duration are never shown
+    const auto* first = m_frameEnds.data() + animation.firstFrame;
+    const auto position = time > 0.0 ? std::fmod(time, static_cast<double>(animation.duration)) : 0.0;
+    const auto* frame = std::upper_bound(first, first + animation.frameCount, position,
+        [](double value, std::uint32_t end)
+        {
+            return value < end;
+        });
+
+    //only reachable through rounding, so shows the last frame
+    if (frame == first + animation.frameCount)
+    {
+        --frame;
+    }
+    return animation.firstFrame + static_cast<std::uint32_t>(frame - first);
+}
+
+std::uint32_t AnimationTable::getFrameGID(const Animation& animation, double time) const
+{
+    return m_frameGIDs[getFrameIndex(animation, time)];
+}
+
+std::uint32_t AnimationTable::getFrameGID(std::uint32_t GID, double time) const
+{
+    const auto index = findAnimation(GID);
+    if (index < 0)
+    {
+        return GID;
+    }
+    return getFrameGID(m_animations[index], time) | (GID & detail::GIDFlagMask);
+}
+
+void AnimationTable::clear()
+{
+    m_animations.clear();
+    m_frameGIDs.clear();
+    m_frameEnds.clear();
+}
@@ -0,0 +1,223 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#include <tmxlite/AtlasLayout.hpp>
+#include <tmxlite/Map.hpp>
+#include <tmxlite/detail/Log.hpp>
+#include "detail/Gid.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+using namespace tmx;
+
+AtlasLayout::AtlasLayout()
+    : m_maxPageSize (4096u, 4096u),
+    m_padding       (1)
+{
+
+}
+
+//public
+bool AtlasLayout::build(const Map& map)
+{
+    clear();
+
+    //the image containing each tile and the tile's area within it,
+    //kept until the images have been placed
+    struct TileSource final
+    {
+        std::uint32_t GID = 0;
+        std::uint32_t image = 0;
+        Vector2u offset;
+        Vector2u size;
+    };
+    std::vector<TileSource> sources;
+    std::unordered_map<std::string, std::uint32_t> imageIndices;
+    std::uint32_t lastGID = 0;
+
+    for (const auto& tileset : map.getTilesets())
+    {
+        if (tileset.getTileCount() == 0 && tileset.getTiles().empty())
+        {
+            continue;
+        }
+
+        const auto firstGID = tileset.getFirstGID();
+        const auto tileCount = tileset.getLastGID() - firstGID + 1;
+        for (auto i = 0u; i < tileCount; ++i)
+        {
+            //GIDs shared by overlapping tile sets belong to the one
+            //the map resolves them to
+            if (map.findTile(firstGID + i).tileset != &tileset)
+            {
+                continue;
+            }
+            const auto tile = tileset.getTile(firstGID + i);
+
+            TileSource source;
+            source.GID = firstGID + i;
+            source.size = tile.getImageSize();
+
+            //tiles in an image collection have their own image
+            auto imageSize = source.size;
+            if (tile.getImagePath() == tileset.getImagePath())
+            {
+                imageSize = tileset.getImageSize();
+                source.offset = tile.getImagePosition();
+            }
+
+            //skips empty tiles, and tiles past the edge of the image
+            if (source.size.x == 0 || source.size.y == 0
+                || source.offset.x + source.size.x > imageSize.x
+                || source.offset.y + source.size.y > imageSize.y)
+            {
+                continue;
+            }
+
+            const auto path = detail::toStdString(tile.getImagePath());
+            const auto result = imageIndices.find(path);
+            if (result == imageIndices.end())
+            {
+                source.image = static_cast<std::uint32_t>(m_images.size());
+                imageIndices.insert(std::make_pair(path, source.image));
+
+                m_images.emplace_back();
+                m_images.back().path = path;
+                m_images.back().size = imageSize;
+            }
+            else
+            {
+                source.image = result->second;
+            }
+
+            sources.push_back(source);
+            lastGID = std::max(lastGID, source.GID);
+        }
+    }
+
+    if (!pack())
+    {
+        clear();
+        return false;
+    }
+
+    if (!sources.empty())
+    {
+        m_tileRects.resize(std::size_t(lastGID) + 1);
+    }
+
+    for (const auto& source : sources)
+    {
+        const auto& image = m_images[source.image];
+        auto& tileRect = m_tileRects[source.GID];
+        tileRect.rect = IntRect(static_cast<int>(image.position.x + source.offset.x),
+            static_cast<int>(image.position.y + source.offset.y),
+            static_cast<int>(source.size.x), static_cast<int>(source.size.y));
+        tileRect.page = image.page;
+    }
+
+    return true;
+}
+
+const AtlasLayout::TileRect* AtlasLayout::getTileRect(std::uint32_t GID) const
+{
+    GID &= ~detail::GIDFlagMask;
+    if (GID >= m_tileRects.size()
+        || m_tileRects[GID].rect.width == 0)
+    {
+        return nullptr;
+    }
+    return &m_tileRects[GID];
+}
+
+void AtlasLayout::clear()
+{
+    m_images.clear();
+    m_pageSizes.clear();
+    m_tileRects.clear();
+}
+
+//private
+bool AtlasLayout::pack()
+{
+    //images are placed in rows, tallest first, so that the
+    //images in each row waste as little height as possible
+    std::vector<std::uint32_t> order(m_images.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(),
+        [&](std::uint32_t a, std::uint32_t b)
+        {
+            const auto& l = m_images[a].size;
+            const auto& r = m_images[b].size;
+            return l.y > r.y || (l.y == r.y && l.x > r.x);
+        });
+
+    Vector2u cursor;
+    std::uint32_t rowHeight = 0;
+    for (auto index : order)
+    {
+        auto& image = m_images[index];
+        if (image.size.x > m_maxPageSize.x || image.size.y > m_maxPageSize.y)
+        {
+            Logger::log("Image " + image.path + " is larger than the maximum atlas page size", Logger::Type::Error);
+            return false;
+        }
+
+        if (m_pageSizes.empty())
+        {
+            m_pageSizes.emplace_back();
+        }
+
+        //starts a new row when the image doesn't fit on the current
+        //one, and a new page when the row doesn't fit on the page
+        if (cursor.x + image.size.x > m_maxPageSize.x)
+        {
+            cursor.x = 0;
+            cursor.y += rowHeight + m_padding;
+            rowHeight = 0;
+        }
+
+        if (cursor.y + image.size.y > m_maxPageSize.y)
+        {
+            m_pageSizes.emplace_back();
+            cursor = Vector2u();
+            rowHeight = 0;
+        }
+
+        image.position = cursor;
+        image.page = static_cast<std::uint32_t>(m_pageSizes.size() - 1);
+
+        auto& pageSize = m_pageSizes.back();
+        pageSize.x = std::max(pageSize.x, cursor.x + image.size.x);
+        pageSize.y = std::max(pageSize.y, cursor.y + image.size.y);
+
+        cursor.x += image.size.x + m_padding;
+        rowHeight = std::max(rowHeight, image.size.y);
+    }
+
+    return true;
+}
@@ -25,18 +25,22 @@ and must not be misrepresented as being the original software.
 source distribution.
 *********************************************************************/
 
-#ifndef USE_EXTLIBS
-#include "miniz.h"
-#else
-#include <zlib.h>
-#endif
 #include <tmxlite/FreeFuncs.hpp>
 #include <tmxlite/Types.hpp>
 #include <tmxlite/detail/Log.hpp>
+#include "detail/Base64.hpp"
+#include "detail/DecompressionContext.hpp"
+#include "detail/Gzip.hpp"
 
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 
+std::size_t tmx::base64_decode(const char* source, std::size_t length, unsigned char* dest)
+{
+    return detail::base64Decode(source, length, dest);
+}
+
 bool tmx::decompress(const char* source, std::vector<unsigned char>& dest, std::size_t inSize, std::size_t expectedSize)
 {
     if (!source)
@@ -45,85 +49,115 @@ bool tmx::decompress(const char* source, std::vector<unsigned char>& dest, std::
         return false;
     }
 
-//#ifdef USE_EXTLIBS
-
-
-//#else
-    int currentSize = static_cast<int>(expectedSize);
-    std::vector<unsigned char> byteArray(expectedSize / sizeof(unsigned char));
-    z_stream stream;
-    stream.zalloc = Z_NULL;
-    stream.zfree = Z_NULL;
-    stream.opaque = Z_NULL;
-    stream.next_in = (Bytef*)source;
-    stream.avail_in = static_cast<unsigned int>(inSize);
-    stream.next_out = (Bytef*)byteArray.data();
-    stream.avail_out = static_cast<unsigned int>(expectedSize);
-
-    //we'd prefer to use inflateInit2 but it appears 
-    //to be incorrect in miniz. This is fine for zlib
-    //compressed data, but gzip compressed streams
-    //will fail to inflate.
-#ifdef USE_EXTLIBS
-    if (inflateInit2(&stream, 15 + 32) != Z_OK)
+    auto& context = detail::DecompressionContext::getThreadContext();
+    const auto* input = reinterpret_cast<const unsigned char*>(source);
+
+#ifdef USE_LIBDEFLATE
+    //libdeflate reads zlib and gzip streams whole, checking their trailers
+    const auto start = dest.size();
+    if (!context.inflateWhole(input, inSize, dest, expectedSize))
+    {
+        LOG("zlib decompression failed, the data is invalid.", Logger::Type::Error);
+        return false;
+    }
 #else
-    if (inflateInit(&stream) != Z_OK)
-#endif
+    //gzip members are read as a header followed by raw deflate data
+    std::size_t headerSize = 0;
+    const bool gzip = detail::isGzip(input, inSize);
+    if (gzip)
+    {
+        headerSize = detail::readGzipHeader(input, inSize);
+        if (headerSize == 0)
+        {
+            LOG("gzip decompression failed, the header is invalid.", Logger::Type::Error);
+            return false;
+        }
+    }
+
+    const auto beginStream = [&]()
+    {
+        auto* stream = context.beginInflate(gzip);
+        if (stream)
+        {
+            stream->next_in = (Bytef*)(input + headerSize);
+            stream->avail_in = static_cast<unsigned int>(inSize - headerSize);
+        }
+        return stream;
+    };
+
+    auto* stream = beginStream();
+    if (!stream)
     {
         LOG("inflate init failed", Logger::Type::Error);
         return false;
     }
 
-    int result = 0;
-    do
-    {
-        result = inflate(&stream, Z_SYNC_FLUSH);
+    //inflate directly into the end of dest, which is sized
+    //up front and only grown if the expected size was too small
+    const auto start = dest.size();
+    dest.resize(start + std::max(expectedSize, std::size_t(1)));
+    stream->next_out = (Bytef*)(dest.data() + start);
+    stream->avail_out = static_cast<unsigned int>(dest.size() - start);
 
-        switch (result)
+    int result = inflate(stream, Z_FINISH);
+    while (result == Z_BUF_ERROR && stream->avail_out == 0)
+    {
+        //miniz can only finish in a single call, so restart with a larger buffer
+        const auto size = (dest.size() - start) * 2;
+        dest.resize(start + size);
+        stream = beginStream();
+        if (!stream)
         {
-        default: break;
-        case Z_NEED_DICT:
-        case Z_STREAM_ERROR:
-            result = Z_DATA_ERROR;
-        case Z_DATA_ERROR:
-            Logger::log("If using gzip or zstd compression try using zlib instead", Logger::Type::Info);
-        case Z_MEM_ERROR:
-            inflateEnd(&stream);
-            Logger::log("inflate() returned " +  std::to_string(result), Logger::Type::Error);
+            dest.resize(start);
+            LOG("inflate init failed", Logger::Type::Error);
             return false;
         }
+        stream->next_out = (Bytef*)(dest.data() + start);
+        stream->avail_out = static_cast<unsigned int>(size);
+        result = inflate(stream, Z_FINISH);
+    }
 
-        if (result != Z_STREAM_END)
+    if (result != Z_STREAM_END)
+    {
+        context.endInflate();
+        dest.resize(start);
+        if (result == Z_DATA_ERROR || result == Z_NEED_DICT || result == Z_STREAM_ERROR)
         {
-            int oldSize = currentSize;
-            currentSize *= 2;
-            std::vector<unsigned char> newArray(currentSize / sizeof(unsigned char));
-            std::memcpy(newArray.data(), byteArray.data(), currentSize / 2);
-            byteArray = std::move(newArray);
+            Logger::log("If using zstd compression try using zlib instead", Logger::Type::Info);
+        }
+        Logger::log("inflate() returned " + std::to_string(result), Logger::Type::Error);
+        return false;
+    }
 
-            stream.next_out = (Bytef*)(byteArray.data() + oldSize);
-            stream.avail_out = oldSize;
+    const auto remaining = stream->avail_in;
+    const auto outSize = (dest.size() - start) - stream->avail_out;
+    context.endInflate();
+    dest.resize(start + outSize);
 
+    if (gzip && remaining <= detail::GzipTrailerSize)
+    {
+        //miniz may have read the start of the trailer along with the
+        //end of the stream, so it is taken from the end of the input
+        const auto crc = detail::gzipCrc32(0, dest.data() + start, outSize);
+        if (inSize - headerSize < detail::GzipTrailerSize
+            || !detail::checkGzipTrailer(input + inSize - detail::GzipTrailerSize, crc, outSize))
+        {
+            dest.resize(start);
+            LOG("gzip decompression failed, the checksum or size of the data is incorrect.", Logger::Type::Error);
+            return false;
         }
-    } while (result != Z_STREAM_END);
+    }
 
-    if (stream.avail_in != 0)
+    if (remaining > (gzip ? detail::GzipTrailerSize : 0))
     {
-        LOG("stream.avail_in is 0", Logger::Type::Error);
-        LOG("zlib decompression failed.", Logger::Type::Error);
+        dest.resize(start);
+        LOG("zlib decompression failed, found data after the end of the stream.", Logger::Type::Error);
         return false;
     }
+#endif
 
-    const int outSize = currentSize - stream.avail_out;
-    inflateEnd(&stream);
-
-    std::vector<unsigned char> newArray(outSize / sizeof(unsigned char));
-    std::memcpy(newArray.data(), byteArray.data(), outSize);
-    byteArray = std::move(newArray);
-
-    //copy bytes to vector
-    dest.insert(dest.begin(), byteArray.begin(), byteArray.end());
-//#endif
+    //decompressed data has always been inserted at the front of dest
+    std::rotate(dest.begin(), dest.begin() + start, dest.end());
     return true;
 }
 
@@ -166,6 +200,8 @@ TMXLITE_CONSTINIT bool tmx::enableWindowsPathHandling = true;
 TMXLITE_CONSTINIT bool tmx::enableWindowsPathHandling = false;
 #endif
 
+TMXLITE_CONSTINIT bool tmx::enableFileMapping = false;
+
 bool tmx::isAbsoluteFilePath(const std::string& path, std::string* prefix)
 {
     if (path.empty())
@@ -267,11 +303,26 @@ std::string tmx::resolveFilePath(std::string path, std::string workingDir)
 
 bool tmx::readFileIntoString(const std::string& path, std::string* out)
 {
-    std::ifstream stream(path);
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
     if (!stream.is_open())
     {
         return false;
     }
-    out->append((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+    //read the whole file in one go rather than a character at a time
+    const auto size = stream.tellg();
+    if (size <= 0)
+    {
+        //size unknown, eg a pipe
+        stream.seekg(0);
+        out->append((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        return !stream.bad();
+    }
+
+    const auto offset = out->size();
+    out->resize(offset + static_cast<std::size_t>(size));
+    stream.seekg(0);
+    stream.read(&(*out)[offset], size);
+    out->resize(offset + static_cast<std::size_t>(stream.gcount()));
     return !stream.bad();
 }
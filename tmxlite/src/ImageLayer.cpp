@@ -33,6 +33,8 @@ source distribution.
 #include <tmxlite/ImageLayer.hpp>
 #include <tmxlite/FreeFuncs.hpp>
 #include <tmxlite/detail/Log.hpp>
+#include "detail/JsonReader.hpp"
+#include "detail/Keys.hpp"
 
 using namespace tmx;
 
@@ -45,25 +47,31 @@ ImageLayer::ImageLayer(const std::string& workingDir)
 
 }
 
-bool ImageLayer::parseChild(const cJSON &child, tmx::Map *map)
+bool ImageLayer::parseChild(detail::Key key, const cJSON &child, tmx::Map *map)
 {
-    std::string childName = child.string;
-    if(childName == "repeatx") {
-        m_hasRepeatX = std::string(child.valuestring) == "true";
-    } else if(childName == "repeaty") {
-        m_hasRepeatY = std::string(child.valuestring) == "true";
-    } else if(childName == "transparentcolor") {
+    switch(key)
+    {
+    case detail::Key::RepeatX:
+        m_hasRepeatX = detail::isTrue(child);
+        break;
+    case detail::Key::RepeatY:
+        m_hasRepeatY = detail::isTrue(child);
+        break;
+    case detail::Key::TransparentColour:
         m_transparencyColour = colourFromString(child.valuestring);
         m_hasTransparency = true;
-    } else if(childName == "image") {
+        break;
+    case detail::Key::Image:
         m_filePath = resolveFilePath(child.valuestring, m_workingDir);
-    } else if(childName == "imagewidth") {
+        break;
+    case detail::Key::ImageWidth:
         m_imageSize.x = (unsigned int)child.valuedouble;
-    } else if(childName == "imageheight") {
-        
+        break;
+    case detail::Key::ImageHeight:
         m_imageSize.y = (unsigned int)child.valuedouble;
-    } else {
-        return Layer::parseChild(child, map);
+        break;
+    default:
+        return Layer::parseChild(key, child, map);
     }
     return true;
 }
@@ -71,14 +79,23 @@ bool ImageLayer::parseChild(const cJSON &child, tmx::Map *map)
 //public
 bool ImageLayer::parse(const cJSON& node, Map* map)
 {
-    std::string attribName = node.string;
-    if (attribName != "imagelayer")
+    //layers stored in an array have no name
+    if (node.string != nullptr && std::string(node.string) != "imagelayer")
     {
         Logger::log("Node not an image layer, node skipped", Logger::Type::Error);
         return false;
     }
-    bool retval = Parsable::parse(node, map);
+    return parseComplete(Parsable::parse(node, map));
+}
+
+bool ImageLayer::parseStream(tmx::detail::JsonReader& reader, Map* map)
+{
+    return parseComplete(Parsable::parseStream(reader, map));
+}
 
+//private
+bool ImageLayer::parseComplete(bool retval)
+{
     if(retval){
         if(m_filePath.empty()) {
             Logger::log("Image Layer has missing source property", Logger::Type::Warning);
@@ -7,41 +7,81 @@
 #include <tmxlite/FreeFuncs.hpp>
 #include <tmxlite/detail/Log.hpp>
 #include <cJSON/cJSON.h>
+#include "detail/JsonReader.hpp"
+#include "detail/Keys.hpp"
 
-bool tmx::Layer::parseChild(const cJSON& child, Map* map)
+namespace
 {
-    std::string childName = child.string;
-    if(childName == "name") {
+    std::unique_ptr<tmx::Layer> createLayer(const std::string& name, tmx::Map* map)
+    {
+        std::unique_ptr<tmx::Layer> output;
+        if (name == "layer" || name == "tilelayer") {
+            output.reset(new tmx::TileLayer(map->getTileCount().x * map->getTileCount().y));
+        } else if (name == "objectgroup") {
+            output.reset(new tmx::ObjectGroup());
+        } else if (name == "imagelayer") {
+            output.reset(new tmx::ImageLayer(map->getWorkingDirectory()));
+        } else if (name == "group") {
+            output.reset(new tmx::LayerGroup());
+        } else {
+            LOG("Unidentified name " + name + ": node skipped", tmx::Logger::Type::Warning);
+        }
+        return output;
+    }
+}
+
+bool tmx::Layer::parseChild(detail::Key key, const cJSON& child, Map* map)
+{
+    switch(key)
+    {
+    case detail::Key::Name:
         setName(child.valuestring);
-    } else if(childName == "id") {
+        break;
+    case detail::Key::ID:
         m_id = int(child.valuedouble);
-    } else if(childName == "type") {
+        break;
+    case detail::Key::Type:
         // skip this, we already know the type
-    } else if(childName == "class") {
+        break;
+    case detail::Key::Class:
         setClass(child.valuestring);
-    } else if(childName == "opacity") {
+        break;
+    case detail::Key::Opacity:
         setOpacity(float(child.valuedouble));
-    } else if(childName == "offsetx") {
+        break;
+    case detail::Key::OffsetX:
         m_offset.x = int(child.valuedouble);
-    } else if(childName == "offsety") {
+        break;
+    case detail::Key::OffsetY:
         m_offset.y = int(child.valuedouble);
-    } else if(childName == "x" || childName == "y") {
+        break;
+    case detail::Key::X:
+    case detail::Key::Y:
         // skip these too, spec says always 0
-    } else if(childName == "startx") {
+        break;
+    case detail::Key::StartX:
         m_start.x = float(child.valuedouble);
-    } else if(childName == "starty") {
+        break;
+    case detail::Key::StartY:
         m_start.y = float(child.valuedouble);
-    } else if(childName == "parallaxx") {
+        break;
+    case detail::Key::ParallaxX:
         m_parallaxFactor.x = float(child.valuedouble);
-    } else if(childName == "parallaxy") {
+        break;
+    case detail::Key::ParallaxY:
         m_parallaxFactor.y = float(child.valuedouble);
-    } else if(childName == "tintcolour") {
+        break;
+    case detail::Key::TintColor:
+    case detail::Key::TintColour:
         m_tintColour = colourFromString(child.valuestring);
-    } else if(childName == "properties") {
+        break;
+    case detail::Key::Properties:
         m_properties = Property::readProperties(child);
-    } else if(childName == "visible") {
-        m_visible = child.type == cJSON_True;
-    } else {
+        break;
+    case detail::Key::Visible:
+        m_visible = detail::isTrue(child);
+        break;
+    default:
         return false;
     }
     return true;
@@ -51,22 +91,11 @@ std::unique_ptr<tmx::Layer> tmx::Layer::readLayer(const cJSON &node, tmx::Map *m
 {
     std::string name;
     for(cJSON *child = node.child; child != nullptr; child = child->next) {
-        if(std::string(child->string) == "type") {
+        if(detail::classifyKey(child->string) == detail::Key::Type && child->valuestring != nullptr) {
             name = child->valuestring;
         }
     }
-    std::unique_ptr<tmx::Layer> output;
-    if (name == "layer" || name == "tilelayer") {
-        output.reset(new tmx::TileLayer(map->getTileCount().x * map->getTileCount().y));
-    } else if (name == "objectgroup") {
-        output.reset(new ObjectGroup());
-    } else if (name == "imagelayer") {
-        output.reset(new ImageLayer(map->getWorkingDirectory()));
-    } else if (name == "group") {
-        output.reset(new LayerGroup());
-    } else {
-        LOG("Unidentified name " + name + ": node skipped", Logger::Type::Warning);
-    }
+    auto output = createLayer(name, map);
     if(output) {
         output->parse(node, map);
     }
@@ -83,4 +112,38 @@ std::vector<std::unique_ptr<tmx::Layer>> tmx::Layer::readLayers(const struct cJS
         }
     }
     return output;
-}
\ No newline at end of file
+}
+
+std::unique_ptr<tmx::Layer> tmx::Layer::readLayer(tmx::detail::JsonReader& reader, tmx::Map* map)
+{
+    //the type usually comes after the layer data, so look ahead for it
+    std::string name;
+    detail::JsonValue type;
+    if(reader.findValue("type", type) && type.get().valuestring != nullptr) {
+        name = type.get().valuestring;
+    }
+
+    auto output = createLayer(name, map);
+    if(output) {
+        output->parseStream(reader, map);
+    } else {
+        reader.skipValue();
+    }
+    return output;
+}
+
+std::vector<std::unique_ptr<tmx::Layer>> tmx::Layer::readLayers(tmx::detail::JsonReader& reader, tmx::Map* map)
+{
+    std::vector<std::unique_ptr<tmx::Layer>> output;
+    if(!reader.beginArray()) {
+        return output;
+    }
+
+    while(reader.nextElement()) {
+        auto outLayer = readLayer(reader, map);
+        if(outLayer) {
+            output.push_back(std::move(outLayer));
+        }
+    }
+    return output;
+}
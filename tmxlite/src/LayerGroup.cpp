@@ -28,7 +28,7 @@ source distribution.
 #ifdef USE_EXTLIBS
 #include <cJSON/cJSON.h>
 #else
-#include "detail/cJson.h"
+#include "detail/cJSON.h"
 #endif
 #include <tmxlite/LayerGroup.hpp>
 #include <tmxlite/FreeFuncs.hpp>
@@ -36,6 +36,8 @@ source distribution.
 #include <tmxlite/ImageLayer.hpp>
 #include <tmxlite/TileLayer.hpp>
 #include <tmxlite/detail/Log.hpp>
+#include "detail/JsonReader.hpp"
+#include "detail/Keys.hpp"
 
 using namespace tmx;
 
@@ -43,22 +45,32 @@ LayerGroup::LayerGroup()
 {
 }
 
-bool LayerGroup::parseChild(const struct cJSON &child, tmx::Map* map)
+bool LayerGroup::parseChild(detail::Key key, const struct cJSON &child, tmx::Map* map)
 {
     assert(map != nullptr);
-    if(std::string(child.string) == "layers") {
+    if(key == detail::Key::Layers) {
         m_layers = Layer::readLayers(child, map);
     } else {
-        return Layer::parseChild(child, map);
+        return Layer::parseChild(key, child, map);
     }
     return true;
 }
 
+bool LayerGroup::parseChildStream(detail::Key key, tmx::detail::JsonReader& reader, tmx::Map* map)
+{
+    assert(map != nullptr);
+    if(key == detail::Key::Layers) {
+        m_layers = Layer::readLayers(reader, map);
+        return !reader.failed();
+    }
+    return Layer::parseChildStream(key, reader, map);
+}
+
 //public
 bool LayerGroup::parse(const cJSON& node, Map* map)
 {
-    std::string attribString = node.string;
-    if (attribString != "group") {
+    //layers stored in an array have no name
+    if (node.string != nullptr && std::string(node.string) != "group") {
         Logger::log("Node was not a group layer, node will be skipped.", Logger::Type::Error);
         return false;
     }
@@ -38,13 +38,144 @@ source distribution.
 #include <tmxlite/LayerGroup.hpp>
 #include <tmxlite/detail/Log.hpp>
 #include <tmxlite/detail/Android.hpp>
+#include "detail/CompiledMap.hpp"
+#include "detail/Gid.hpp"
+#include "detail/JsonReader.hpp"
+#include "detail/Keys.hpp"
+#include "detail/MappedFile.hpp"
+#include "detail/Parallel.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
 #include <queue>
 
 using namespace tmx;
 
+namespace
+{
+    void collectTileLayers(const std::vector<Layer::Ptr>& layers, std::vector<TileLayer*>& output)
+    {
+        for (const auto& layer : layers)
+        {
+            if (layer->getType() == Layer::Type::Tile)
+            {
+                output.push_back(&layer->getLayerAs<TileLayer>());
+            }
+            else if (layer->getType() == Layer::Type::Group)
+            {
+                collectTileLayers(layer->getLayerAs<LayerGroup>().getLayers(), output);
+            }
+        }
+    }
+
+    std::size_t countChildren(const cJSON& node)
+    {
+        std::size_t count = 0;
+        for (const cJSON* child = node.child; child != nullptr; child = child->next)
+        {
+            count++;
+        }
+        return count;
+    }
+
+    //external tile sets and templates referenced by a map document
+    struct References final
+    {
+        std::vector<std::string> tilesets;
+        std::vector<std::string> templates;
+
+        void add(detail::Key key, std::string path)
+        {
+            auto& paths = (key == detail::Key::Template) ? templates : tilesets;
+            if (std::find(paths.begin(), paths.end(), path) == paths.end())
+            {
+                paths.push_back(std::move(path));
+            }
+        }
+    };
+
+    //tile sets refer to files with a source property, and
+    //objects anywhere in the map may refer to a template
+    bool isReference(detail::Key key, detail::Key parentKey)
+    {
+        return key == detail::Key::Template
+            || (key == detail::Key::Source && parentKey == detail::Key::Tilesets);
+    }
+
+    void findReferences(const cJSON& node, detail::Key parentKey, References& output)
+    {
+        for (const cJSON* child = node.child; child != nullptr; child = child->next)
+        {
+            const auto key = (child->string != nullptr) ? detail::classifyKey(child->string) : parentKey;
+            if (child->valuestring != nullptr && isReference(key, parentKey))
+            {
+                output.add(key, child->valuestring);
+            }
+            else if (child->child != nullptr && key != detail::Key::Data)
+            {
+                findReferences(*child, key, output);
+            }
+        }
+    }
+
+    bool findReferences(detail::JsonReader& reader, detail::Key parentKey, References& output)
+    {
+        switch (reader.peek())
+        {
+        case detail::JsonReader::Type::Object:
+            reader.beginObject();
+            while (reader.nextKey())
+            {
+                const auto key = detail::classifyKey(reader.getKey());
+                if (isReference(key, parentKey) && reader.peek() == detail::JsonReader::Type::String)
+                {
+                    std::string path;
+                    if (!reader.readString(path))
+                    {
+                        return false;
+                    }
+                    output.add(key, std::move(path));
+                }
+                else if (key == detail::Key::Data)
+                {
+                    if (!reader.skipValue())
+                    {
+                        return false;
+                    }
+                }
+                else if (!findReferences(reader, key, output))
+                {
+                    return false;
+                }
+            }
+            return !reader.failed();
+        case detail::JsonReader::Type::Array:
+            reader.beginArray();
+            while (reader.nextElement())
+            {
+                if (!findReferences(reader, parentKey, output))
+                {
+                    return false;
+                }
+            }
+            return !reader.failed();
+        default:
+            return reader.skipValue();
+        }
+    }
+}
+
 Map::Map()
-    : m_orientation (Orientation::None),
+    : m_parseMode   (ParseMode::Streaming),
+    m_tileDecoding(TileDecoding::Eager),
+    m_tileStorage (TileStorage::Tiles),
+    m_sparseThreshold(0.f),
+    m_workerThreadCount(1),
+    m_tilesetCache(nullptr),
+    m_zstdDictionary(nullptr),
+    m_cancelRequested(std::make_unique<std::atomic<bool>>(false)),
+    m_orientation (Orientation::None),
     m_renderOrder   (RenderOrder::None),
     m_infinite      (false),
     m_hexSideLength (0.f),
@@ -58,26 +189,77 @@ Map::Map()
 //public
 bool Map::load(const std::string& path)
 {
+    reportProgress(LoadPhase::FileRead, 0, 1);
+    if (enableFileMapping)
+    {
+        detail::MappedFile file;
+        if (file.open(path))
+        {
+            reportProgress(LoadPhase::FileRead, 1, 1);
+            return loadFromMemory(file.getData(), file.getSize(), getFilePath(path));
+        }
+    }
+
     std::string contents;
     if (!readFileIntoString(path, &contents))
     {
         Logger::log("Failed to read file " + path, Logger::Type::Error);
+        m_cancelRequested->store(false);
         return reset();
     }
+    reportProgress(LoadPhase::FileRead, 1, 1);
     return loadFromString(contents, getFilePath(path));
 }
 
-bool Map::loadFromString(const std::string& data, const std::string& workingDir)
+std::future<bool> Map::loadAsync(const std::string& path)
 {
-    reset();
+    return std::async(std::launch::async, [this, path]()
+        {
+            return load(path);
+        });
+}
 
-    //open the doc
-    cJSON* doc = cJSON_Parse(data.c_str());
-    if (!doc) {
-        Logger::log("Failed opening map", Logger::Type::Error);
+bool Map::saveCompiled(const std::string& path) const
+{
+    std::vector<char> data;
+    detail::CompiledMap::write(*this, data);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        Logger::log("Failed to open " + path + " for writing", Logger::Type::Error);
         return false;
     }
 
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!file.good())
+    {
+        Logger::log("Failed writing compiled map " + path, Logger::Type::Error);
+        return false;
+    }
+    return true;
+}
+
+bool Map::loadFromString(const std::string& data, const std::string& workingDir)
+{
+    return loadFromMemory(data.data(), data.size(), workingDir);
+}
+
+bool Map::loadFromMemory(const char* data, std::size_t size, const std::string& workingDir)
+{
+    bool loaded = loadDocument(data, size, workingDir);
+
+    //a cancel request only applies to a single load
+    m_cancelRequested->store(false);
+    return loaded;
+}
+
+//private
+bool Map::loadDocument(const char* data, std::size_t size, const std::string& workingDir)
+{
+    reset();
+    detail::Arena::Scope arenaScope(m_arena);
+
     //make sure we have consistent path separators
     m_workingDirectory = workingDir;
     std::replace(m_workingDirectory.begin(), m_workingDirectory.end(), '\\', '/');
@@ -86,104 +268,474 @@ bool Map::loadFromString(const std::string& data, const std::string& workingDir)
         m_workingDirectory.back() == '/') {
         m_workingDirectory.pop_back();
     }
+
+    if (loadCancelled()) {
+        return reset();
+    }
+
+    reportProgress(LoadPhase::Parse, 0, 1);
+    if (detail::CompiledMap::isCompiled(data, size)) {
+        if (!detail::CompiledMap::read(data, size, *this)) {
+            return reset();
+        }
+        reportProgress(LoadPhase::Parse, 1, 1);
+        return parseComplete();
+    }
+
+    if (m_parseMode == ParseMode::Streaming) {
+        if (m_workerThreadCount != 1) {
+            References references;
+            detail::JsonReader reader(data, size);
+            if (findReferences(reader, detail::Key::Unknown, references)) {
+                preloadExternalFiles(references.tilesets, references.templates);
+            }
+        }
+
+        if (loadCancelled()) {
+            return reset();
+        }
+
+        //the document is parsed as the map is read
+        detail::JsonReader reader(data, size);
+        return parseMapStream(reader);
+    }
+
+    //open the doc
+    cJSON* doc = cJSON_ParseWithLength(data, size);
+    if (!doc) {
+        Logger::log("Failed opening map", Logger::Type::Error);
+        return reset();
+    }
+    reportProgress(LoadPhase::Parse, 1, 1);
+
+    if (m_workerThreadCount != 1) {
+        References references;
+        findReferences(*doc, detail::Key::Unknown, references);
+        preloadExternalFiles(references.tilesets, references.templates);
+    }
+
+    if (loadCancelled()) {
+        cJSON_Delete(doc);
+        return reset();
+    }
+
     bool parseSuccess = parseMapNode(*doc);
     cJSON_Delete(doc);
     return parseSuccess;
 }
 
+void Map::decodeAll() const
+{
+    std::vector<TileLayer*> layers;
+    collectTileLayers(m_layers, layers);
+
+    const auto threadCount = detail::resolveThreadCount(m_workerThreadCount);
+    if (threadCount == 1) {
+        for (auto* layer : layers) {
+            layer->decodeAll();
+        }
+        return;
+    }
+
+    //the layers stay locked until they are decoded, so that
+    //any other threads reading them wait for the results
+    struct Task final
+    {
+        TileLayer* layer = nullptr;
+        std::size_t index = 0;
+    };
+    std::vector<Task> tasks;
+    std::vector<TileLayer*> pending;
+    std::vector<std::unique_lock<std::mutex>> locks;
+    for (auto* layer : layers) {
+        std::unique_lock<std::mutex> lock(layer->m_decodeMutex);
+        if (layer->isDecoded()) {
+            continue;
+        }
+
+        for (auto i = 0u; i < layer->getDecodeTaskCount(); ++i) {
+            tasks.push_back({ layer, i });
+        }
+        pending.push_back(layer);
+        locks.push_back(std::move(lock));
+    }
+
+    detail::parallelFor(tasks.size(), threadCount,
+        [&tasks](std::size_t i)
+        {
+            tasks[i].layer->decodeTask(tasks[i].index);
+        });
+
+    for (auto* layer : pending) {
+        layer->finishDecode();
+        layer->m_decoded.store(true, std::memory_order_release);
+    }
+}
+
+Map::TileLocation Map::findTile(std::uint32_t GID) const
+{
+    GID &= ~detail::GIDFlagMask;
+
+    TileLocation location;
+    std::uint32_t index = 0;
+    if (!m_gidTable.empty())
+    {
+        if (GID >= m_gidTable.size()
+            || m_gidTable[GID] == 0)
+        {
+            return location;
+        }
+        index = m_gidTable[GID] - 1u;
+    }
+    else
+    {
+        if (m_gidRanges.empty())
+        {
+            return location;
+        }
+
+        //branchless search for the last range starting at or before the GID
+        const auto* range = m_gidRanges.data();
+        auto count = m_gidRanges.size();
+        while (count > 1)
+        {
+            const auto half = count / 2;
+            range = (range[half].first <= GID) ? range + half : range;
+            count -= half;
+        }
+
+        if (GID < range->first || GID > range->last)
+        {
+            return location;
+        }
+        index = range->index;
+    }
+
+    const auto& tileset = m_tilesets[index];
+    location.tileset = &tileset;
+    location.index = static_cast<std::int32_t>(index);
+    location.tileID = GID - tileset.getFirstGID();
+    return location;
+}
+
+Map::TileLocation Map::findTile(const Object& object) const
+{
+    const auto& name = object.getTilesetName();
+    if (name.empty())
+    {
+        return findTile(object.getTileID());
+    }
+
+    TileLocation location;
+    const auto result = m_templateTilesets.find(detail::toStdString(name));
+    if (result != m_templateTilesets.end())
+    {
+        const auto& tileset = result->second;
+        const auto GID = object.getTileID() & ~detail::GIDFlagMask;
+        if (GID >= tileset.getFirstGID()
+            && GID - tileset.getFirstGID() < tileset.data().m_tileIndex.size())
+        {
+            location.tileset = &tileset;
+            location.tileID = GID - tileset.getFirstGID();
+        }
+    }
+    return location;
+}
+
 //private
+void Map::reportProgress(LoadPhase phase, std::size_t completed, std::size_t total) const
+{
+    if (m_progressCallback) {
+        //anything the callback allocates belongs to the caller,
+        //so mustn't come from the arena of the map being loaded
+        detail::Arena::Scope heapScope;
+        m_progressCallback(phase, completed, total);
+    }
+}
+
+bool Map::loadCancelled() const
+{
+    if (m_cancelRequested->load()) {
+        Logger::log("Map loading cancelled", Logger::Type::Info);
+        return true;
+    }
+    return false;
+}
+
+void Map::preloadExternalFiles(const std::vector<std::string>& tilesets, const std::vector<std::string>& templates)
+{
+    struct Result final
+    {
+        ExternalFile file;
+        Object object;
+        Tileset tileset;
+
+        explicit Result(const std::string& workingDir) : tileset(workingDir) {}
+    };
+    std::vector<Result> results;
+    results.reserve(tilesets.size() + templates.size());
+    for (const auto& path : tilesets) {
+        results.emplace_back(m_workingDirectory);
+        results.back().file.path = path;
+        results.back().file.type = ExternalFile::Type::Tileset;
+    }
+    for (const auto& path : templates) {
+        results.emplace_back(m_workingDirectory);
+        results.back().file.path = path;
+        results.back().file.type = ExternalFile::Type::Template;
+    }
+
+    //files are loaded without touching the map, which
+    //then takes the results once they are all loaded
+    const auto& workingDir = m_workingDirectory;
+    auto* tilesetCache = m_tilesetCache;
+    detail::parallelFor(results.size(), m_workerThreadCount,
+        [&results, &workingDir, tilesetCache](std::size_t i)
+        {
+            auto& result = results[i];
+            auto start = std::chrono::steady_clock::now();
+            if (result.file.type == ExternalFile::Type::Tileset) {
+                result.file.loaded = result.tileset.loadFile(result.file.path, tilesetCache, 0);
+            } else {
+                result.file.loaded = Object::loadTemplate(result.file.path, workingDir, result.object, result.tileset);
+            }
+            auto end = std::chrono::steady_clock::now();
+            result.file.loadTime = std::chrono::duration<double, std::milli>(end - start).count();
+        });
+
+    reportProgress(LoadPhase::Tilesets, tilesets.size(), tilesets.size());
+    reportProgress(LoadPhase::Templates, templates.size(), templates.size());
+
+    for (auto& result : results) {
+        const auto& path = result.file.path;
+        if (result.file.type == ExternalFile::Type::Tileset) {
+            auto& preloaded = m_preloadedTilesets[path];
+            preloaded.tileset = std::move(result.tileset);
+            preloaded.loaded = result.file.loaded;
+        } else if (result.file.loaded) {
+            const auto tilesetName = detail::toStdString(result.object.getTilesetName());
+            if (!tilesetName.empty() && m_templateTilesets.count(tilesetName) == 0) {
+                m_templateTilesets.insert(std::make_pair(tilesetName, std::move(result.tileset)));
+            }
+            m_templateObjects.insert(std::make_pair(path, std::move(result.object)));
+        } else {
+            m_failedTemplates.insert(path);
+        }
+        m_externalFiles.push_back(std::move(result.file));
+    }
+}
+
 bool Map::parseMapNode(const cJSON& mapNode)
 {
     //parse map attributes
     for(cJSON *child = mapNode.child; child != nullptr; child = child->next) {
-        std::string childname = child->string;
-        if(childname == "compressionlevel") {
-            m_compressionLevel = int(child->valuedouble);
-        } else if(childname == "version") {
-            std::size_t pointPos = 0;
-            std::string versionString = child->valuestring;
-            if (versionString.empty() || (pointPos = versionString.find('.')) == std::string::npos) {
-                Logger::log("Invalid map version value, map not loaded.", Logger::Type::Error);
-                return reset();
+        const auto key = detail::classifyKey(child->string);
+        if(key == detail::Key::Layers) {
+            //layers are read one at a time so that loading can be cancelled between them
+            const std::size_t layerCount = countChildren(*child);
+            std::size_t layersRead = 0;
+            reportProgress(LoadPhase::Layers, 0, layerCount);
+            for (cJSON* layerNode = child->child; layerNode != nullptr; layerNode = layerNode->next) {
+                auto layer = Layer::readLayer(*layerNode, this);
+                if (layer) {
+                    m_layers.push_back(std::move(layer));
+                }
+                if (loadCancelled()) {
+                    return reset();
+                }
+                reportProgress(LoadPhase::Layers, ++layersRead, layerCount);
             }
-        
-            m_version.upper = STOI(versionString.substr(0, pointPos));
-            m_version.lower = STOI(versionString.substr(pointPos + 1));
-        } else if(childname == "class") {
-            m_class = child->valuestring;
-        } else if(childname == "orientation") {
-            std::string orientation = child->valuestring;
-            if (orientation == "orthogonal") {
-                m_orientation = Orientation::Orthogonal;
-            } else if (orientation == "isometric") {
-                m_orientation = Orientation::Isometric;
-            } else if (orientation == "staggered") {
-                m_orientation = Orientation::Staggered;
-            } else if (orientation == "hexagonal") {
-                m_orientation = Orientation::Hexagonal;
-            } else {
-                Logger::log(orientation + " format maps aren't supported yet, sorry! Map not loaded", Logger::Type::Error);
+        } else if (key == detail::Key::Tilesets) {
+            const std::size_t tilesetCount = countChildren(*child);
+            reportProgress(LoadPhase::Tilesets, 0, tilesetCount);
+            m_tilesets = Tileset::readTilesets(*child, this);
+            reportProgress(LoadPhase::Tilesets, tilesetCount, tilesetCount);
+            if (loadCancelled()) {
                 return reset();
             }
-        } else if(childname == "renderorder") {
-            std::string renderorder = child->valuestring;
-            if (renderorder == "right-down") {
-                m_renderOrder = RenderOrder::RightDown;
-            } else if (renderorder == "right-up") {
-                m_renderOrder = RenderOrder::RightUp;
-            } else if (renderorder == "left-down") {
-                m_renderOrder = RenderOrder::LeftDown;
-            } else if (renderorder == "left-up") {
-                m_renderOrder = RenderOrder::LeftUp;
-            } else {
-                Logger::log(renderorder + ": invalid render order. Map not loaded.", Logger::Type::Error);
+        } else if (!parseMapAttribute(key, *child)) {
+            return false;
+        }
+    }
+
+    return parseComplete();
+}
+
+bool Map::parseMapStream(tmx::detail::JsonReader& reader)
+{
+    if (!reader.beginObject()) {
+        Logger::log("Failed opening map", Logger::Type::Error);
+        return reset();
+    }
+
+    while (reader.nextKey()) {
+        const auto key = detail::classifyKey(reader.getKey());
+        if(key == detail::Key::Layers) {
+            //the number of layers isn't known until they have all been read
+            if (!reader.beginArray()) {
+                break;
+            }
+            reportProgress(LoadPhase::Layers, 0, 0);
+            std::size_t layersRead = 0;
+            while (reader.nextElement()) {
+                auto layer = Layer::readLayer(reader, this);
+                if (layer) {
+                    m_layers.push_back(std::move(layer));
+                }
+                if (loadCancelled()) {
+                    return reset();
+                }
+                reportProgress(LoadPhase::Layers, ++layersRead, 0);
+            }
+        } else if (key == detail::Key::Tilesets) {
+            reportProgress(LoadPhase::Tilesets, 0, 0);
+            m_tilesets = Tileset::readTilesets(reader, this);
+            reportProgress(LoadPhase::Tilesets, m_tilesets.size(), m_tilesets.size());
+            if (loadCancelled()) {
                 return reset();
             }
-        } else if(childname == "infinite") {
-            m_infinite = child->type == cJSON_True;
-        } else if(childname == "width") {
-            m_tileCount.x = int(child->valuedouble);
-        } else if(childname == "height") {
-            m_tileCount.y = int(child->valuedouble);
-        } else if(childname == "tilewidth") {
-            m_tileSize.x = int(child->valuedouble);
-        } else if(childname == "tileheight") {
-            m_tileSize.y = int(child->valuedouble);
-        } else if(childname == "hexsidelength") {
-            m_hexSideLength = float(child->valuedouble);
-        } else if(childname == "staggeraxis") {
-            std::string staggeraxis = child->valuestring;
-            if (staggeraxis == "x") {
-                m_staggerAxis = StaggerAxis::X;
-            } else if (staggeraxis == "y") {
-                m_staggerAxis = StaggerAxis::Y;
-            }
-        } else if(childname == "staggerindex") {
-            std::string staggerindex = child->valuestring;
-            if (staggerindex == "odd") {
-                m_staggerIndex = StaggerIndex::Odd;
-            } else if (staggerindex == "even") {
-                m_staggerIndex = StaggerIndex::Even;
-            }
-        } else if(childname == "parallaxoriginx") {
-            m_parallaxOrigin.x = int(child->valuedouble);
-        } else if(childname == "parallaxoriginy") {
-            m_parallaxOrigin.y = int(child->valuedouble);
-        } else if(childname == "backgroundcolor") {
-            m_backgroundColour = colourFromString(child->valuestring);
-        } else if(childname == "properties") {
-            m_properties = Property::readProperties(*child);
-        } else if(childname == "layers") {
-            m_layers = Layer::readLayers(*child, this);
-        } else if (childname == "tilesets") {
-            m_tilesets = Tileset::readTilesets(*child, this);
-        } else if(childname == "nextlayerid" || childname == "nextobjectid") {
-            // i dont think we care about these, but we don't need to see the warning
         } else {
-            LOG("Unidentified name " + childname + ": node skipped", Logger::Type::Warning);
+            detail::JsonValue value;
+            if (!reader.readValue(value, reader.getKey().c_str())) {
+                break;
+            }
+            if (!parseMapAttribute(key, value.get())) {
+                return false;
+            }
+        }
+    }
+
+    if (reader.failed()) {
+        Logger::log("Failed parsing map, map not loaded.", Logger::Type::Error);
+        return reset();
+    }
+    reportProgress(LoadPhase::Parse, 1, 1);
+
+    return parseComplete();
+}
+
+bool Map::parseMapAttribute(detail::Key key, const cJSON& child)
+{
+    switch(key)
+    {
+    case detail::Key::CompressionLevel:
+        m_compressionLevel = int(child.valuedouble);
+        break;
+    case detail::Key::Version:
+    {
+        std::size_t pointPos = 0;
+        std::string versionString = child.valuestring;
+        if (versionString.empty() || (pointPos = versionString.find('.')) == std::string::npos) {
+            Logger::log("Invalid map version value, map not loaded.", Logger::Type::Error);
+            return reset();
         }
+    
+        m_version.upper = STOI(versionString.substr(0, pointPos));
+        m_version.lower = STOI(versionString.substr(pointPos + 1));
     }
+        break;
+    case detail::Key::Class:
+        m_class = child.valuestring;
+        break;
+    case detail::Key::Orientation:
+    {
+        std::string orientation = child.valuestring;
+        if (orientation == "orthogonal") {
+            m_orientation = Orientation::Orthogonal;
+        } else if (orientation == "isometric") {
+            m_orientation = Orientation::Isometric;
+        } else if (orientation == "staggered") {
+            m_orientation = Orientation::Staggered;
+        } else if (orientation == "hexagonal") {
+            m_orientation = Orientation::Hexagonal;
+        } else {
+            Logger::log(orientation + " format maps aren't supported yet, sorry! Map not loaded", Logger::Type::Error);
+            return reset();
+        }
+    }
+        break;
+    case detail::Key::RenderOrder:
+    {
+        std::string renderorder = child.valuestring;
+        if (renderorder == "right-down") {
+            m_renderOrder = RenderOrder::RightDown;
+        } else if (renderorder == "right-up") {
+            m_renderOrder = RenderOrder::RightUp;
+        } else if (renderorder == "left-down") {
+            m_renderOrder = RenderOrder::LeftDown;
+        } else if (renderorder == "left-up") {
+            m_renderOrder = RenderOrder::LeftUp;
+        } else {
+            Logger::log(renderorder + ": invalid render order. Map not loaded.", Logger::Type::Error);
+            return reset();
+        }
+    }
+        break;
+    case detail::Key::Infinite:
+        m_infinite = detail::isTrue(child);
+        break;
+    case detail::Key::Width:
+        m_tileCount.x = int(child.valuedouble);
+        break;
+    case detail::Key::Height:
+        m_tileCount.y = int(child.valuedouble);
+        break;
+    case detail::Key::TileWidth:
+        m_tileSize.x = int(child.valuedouble);
+        break;
+    case detail::Key::TileHeight:
+        m_tileSize.y = int(child.valuedouble);
+        break;
+    case detail::Key::HexSideLength:
+        m_hexSideLength = float(child.valuedouble);
+        break;
+    case detail::Key::StaggerAxis:
+    {
+        std::string staggeraxis = child.valuestring;
+        if (staggeraxis == "x") {
+            m_staggerAxis = StaggerAxis::X;
+        } else if (staggeraxis == "y") {
+            m_staggerAxis = StaggerAxis::Y;
+        }
+    }
+        break;
+    case detail::Key::StaggerIndex:
+    {
+        std::string staggerindex = child.valuestring;
+        if (staggerindex == "odd") {
+            m_staggerIndex = StaggerIndex::Odd;
+        } else if (staggerindex == "even") {
+            m_staggerIndex = StaggerIndex::Even;
+        }
+    }
+        break;
+    case detail::Key::ParallaxOriginX:
+        m_parallaxOrigin.x = int(child.valuedouble);
+        break;
+    case detail::Key::ParallaxOriginY:
+        m_parallaxOrigin.y = int(child.valuedouble);
+        break;
+    case detail::Key::BackgroundColour:
+        m_backgroundColour = colourFromString(child.valuestring);
+        break;
+    case detail::Key::Properties:
+        m_properties = Property::readProperties(child);
+        break;
+    case detail::Key::NextLayerID:
+    case detail::Key::NextObjectID:
+    case detail::Key::TiledVersion:
+    case detail::Key::Type:
+        // i dont think we care about these, but we don't need to see the warning
+        break;
+    default:
+        LOG(std::string("Unidentified name ") + child.string + ": node skipped", Logger::Type::Warning);
+        break;
+    }
+    return true;
+}
 
+bool Map::parseComplete()
+{
     if (m_orientation == Orientation::None) {
         Logger::log("Missing map orientation attribute, map not loaded.", Logger::Type::Error);
         return reset();
@@ -206,6 +758,10 @@ bool Map::parseMapNode(const cJSON& mapNode)
         return reset();
     }
 
+    if (m_tileDecoding == TileDecoding::Eager && m_workerThreadCount != 1) {
+        decodeAll();
+    }
+
     // fill animated tiles for easier lookup into map
     for(const auto& ts : m_tilesets)
     {
@@ -218,9 +774,79 @@ bool Map::parseMapNode(const cJSON& mapNode)
         }
     }
 
+    m_animationTable.build(*this);
+    buildGIDTable();
+
     return true;
 }
 
+void Map::buildGIDTable()
+{
+    m_gidTable.clear();
+    m_gidRanges.clear();
+
+    std::uint64_t tileCount = 0;
+    for (auto i = 0u; i < m_tilesets.size(); ++i)
+    {
+        const auto size = m_tilesets[i].data().m_tileIndex.size();
+        if (size != 0)
+        {
+            GIDRange range;
+            range.first = m_tilesets[i].getFirstGID();
+            range.last = range.first + static_cast<std::uint32_t>(size - 1);
+            range.index = i;
+            m_gidRanges.push_back(range);
+            tileCount += size;
+        }
+    }
+
+    if (m_gidRanges.empty())
+    {
+        return;
+    }
+
+    //Tiled resolves a GID to the tile set with the greatest first GID
+    //not above it, so overlapping ranges are clipped to match
+    std::stable_sort(m_gidRanges.begin(), m_gidRanges.end(),
+        [](const GIDRange& a, const GIDRange& b)
+        {
+            return a.first < b.first;
+        });
+
+    std::size_t rangeCount = 0;
+    for (auto i = 0u; i < m_gidRanges.size(); ++i)
+    {
+        auto range = m_gidRanges[i];
+        if (i + 1 < m_gidRanges.size())
+        {
+            const auto next = m_gidRanges[i + 1].first;
+            if (next == range.first)
+            {
+                continue;
+            }
+            range.last = std::min(range.last, next - 1);
+        }
+        m_gidRanges[rangeCount++] = range;
+    }
+    m_gidRanges.resize(rangeCount);
+
+    //a table entry for every GID is only worth it if most of them are used
+    static const std::uint64_t MaxTableSize = 0x100000;
+    const std::uint64_t tableSize = std::uint64_t(m_gidRanges.back().last) + 1;
+    if (m_tilesets.size() < 0xffff
+        && tableSize <= MaxTableSize
+        && tableSize <= tileCount * 4 + 4096)
+    {
+        m_gidTable.resize(static_cast<std::size_t>(tableSize));
+        for (const auto& range : m_gidRanges)
+        {
+            std::fill(m_gidTable.begin() + range.first, m_gidTable.begin() + range.last + 1,
+                static_cast<std::uint16_t>(range.index + 1));
+        }
+        m_gidRanges.clear();
+    }
+}
+
 bool Map::reset()
 {
     m_orientation = Orientation::None;
@@ -233,14 +859,24 @@ bool Map::reset()
     m_backgroundColour = {};
     m_workingDirectory = "";
 
-    m_tilesets.clear();
+    //storage is swapped out rather than cleared as it may belong to the arena
+    String().swap(m_class);
+    Vector<Tileset>().swap(m_tilesets);
     m_layers.clear();
-    m_properties.clear();
+    Vector<Property>().swap(m_properties);
 
     m_templateObjects.clear();
     m_templateTilesets.clear();
+    m_preloadedTilesets.clear();
+    m_failedTemplates.clear();
+    m_externalFiles.clear();
 
     m_animTiles.clear();
+    m_animationTable.clear();
+    m_gidTable.clear();
+    m_gidRanges.clear();
+
+    m_arena.release();
 
     return false;
 }
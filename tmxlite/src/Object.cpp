@@ -35,7 +35,10 @@ source distribution.
 #include <tmxlite/Map.hpp>
 #include <tmxlite/Tileset.hpp>
 #include <tmxlite/detail/Log.hpp>
+#include "detail/JsonReader.hpp"
+#include "detail/Keys.hpp"
 
+#include <chrono>
 #include <sstream>
 
 using namespace tmx;
@@ -51,52 +54,71 @@ Object::Object()
 
 }
 
-bool Object::parseChild(const struct cJSON &child, tmx::Map* map)
+bool Object::parseChild(detail::Key key, const struct cJSON &child, tmx::Map* map)
 {
-    std::string attribString = child.string;
-    if(attribString == "id") {
+    switch(key)
+    {
+    case detail::Key::ID:
         m_UID = int(child.valuedouble);
-    } else if(attribString == "name") {
+        break;
+    case detail::Key::Name:
         m_name = child.valuestring;
-    } else if(attribString == "type" || attribString == "class") {
+        break;
+    case detail::Key::Type:
+    case detail::Key::Class:
         m_class = child.valuestring;
-    } else if(attribString == "x") {
+        break;
+    case detail::Key::X:
         m_position.x = float(child.valuedouble);
         m_AABB.left = m_position.x;
-    } else if(attribString == "y") {
+        break;
+    case detail::Key::Y:
         m_position.y = float(child.valuedouble);
         m_AABB.top = m_position.y;
-    } else if(attribString == "width") {
+        break;
+    case detail::Key::Width:
         m_AABB.width = float(child.valuedouble);
-    } else if(attribString == "height") {
+        break;
+    case detail::Key::Height:
         m_AABB.height = float(child.valuedouble);
-    } else if(attribString == "rotation") {
+        break;
+    case detail::Key::Rotation:
         m_rotation = float(child.valuedouble);
-    } else if(attribString == "visible") {
-        m_visible = std::string(child.valuestring) == "true";
-    } else if(attribString == "gid") {
-        m_tileID = int(child.valuedouble);
-    } else if (attribString == "properties") {
+        break;
+    case detail::Key::Visible:
+        m_visible = detail::isTrue(child);
+        break;
+    case detail::Key::GID:
+        m_tileID = std::uint32_t(child.valuedouble);
+        break;
+    case detail::Key::Properties:
         for(cJSON *propNode = child.child; propNode != nullptr; propNode = propNode->next) {
             m_properties.emplace_back();
             m_properties.back().parse(*propNode);
         }
-    } else if (attribString == "ellipse") {
+        break;
+    case detail::Key::Ellipse:
         m_shape = Shape::Ellipse;
-    } else if (attribString == "point") {
+        break;
+    case detail::Key::Point:
         m_shape = Shape::Point;
-    } else if (attribString == "polygon") {
+        break;
+    case detail::Key::Polygon:
         m_shape = Shape::Polygon;
         parsePoints(child);
-    } else if (attribString == "polyline") {
+        break;
+    case detail::Key::Polyline:
         m_shape = Shape::Polyline;
         parsePoints(child);
-    } else if (attribString == "text") {
+        break;
+    case detail::Key::Text:
         m_shape = Shape::Text;
         parseText(child);
-    } else if(attribString == "template") {
+        break;
+    case detail::Key::Template:
         m_template = child.valuestring;
-    } else {
+        break;
+    default:
         return false;
     }
     return true;
@@ -105,37 +127,56 @@ bool Object::parseChild(const struct cJSON &child, tmx::Map* map)
 //public
 bool Object::parse(const cJSON& node, Map* map)
 {
-    std::string attribString = node.string;
-    if (attribString != "object") {
+    //objects stored in an array have no name
+    if (node.string != nullptr && std::string(node.string) != "object") {
         Logger::log("This not an Object node, parsing skipped.", Logger::Type::Error);
         return false;
     }
 
     bool retval = Parsable::parse(node, map);
     if(retval) {
-        static const std::uint32_t mask = 0xf0000000;
-        m_flipFlags = ((m_tileID & mask) >> 28);
-        m_tileID = m_tileID & ~mask;
-        if(!m_template.empty()) {
-            //parse templates last so we know which properties
-            //ought to be overridden
-            parseTemplate(m_template, map);
-        }
+        parseComplete(map);
+    }
+    return retval;
+}
+
+bool Object::parseStream(tmx::detail::JsonReader& reader, Map* map)
+{
+    bool retval = Parsable::parseStream(reader, map);
+    if(retval) {
+        parseComplete(map);
     }
     return retval;
 }
 
 //private
+void Object::parseComplete(Map* map)
+{
+    static const std::uint32_t mask = 0xf0000000;
+    m_flipFlags = ((m_tileID & mask) >> 28);
+    m_tileID = m_tileID & ~mask;
+    if(!m_template.empty() && map != nullptr) {
+        //parse templates last so we know which properties
+        //ought to be overridden
+        parseTemplate(m_template, map);
+    }
+}
+
 void Object::parsePoints(const cJSON& node)
 {
     for(cJSON *pointNode = node.child; pointNode != nullptr; pointNode = pointNode->next) {
         float x = 0, y = 0;
         for(cJSON *pointAttrNode = pointNode->child; pointAttrNode != nullptr; pointAttrNode = pointAttrNode->next) {
-            std::string attrName = pointAttrNode->string;
-            if(attrName == "x") {
+            switch(detail::classifyKey(pointAttrNode->string))
+            {
+            case detail::Key::X:
                 x = float(pointAttrNode->valuedouble);
-            } else if(attrName == "y") {
+                break;
+            case detail::Key::Y:
                 y = float(pointAttrNode->valuedouble);
+                break;
+            default:
+                break;
             }
         }
         m_points.push_back({x, y});
@@ -149,26 +190,37 @@ void Object::parsePoints(const cJSON& node)
 void Object::parseText(const cJSON& node)
 {
     for(cJSON *child = node.child; child != nullptr; child = child->next) {
-        std::string name = child->string;
-        if(name == "bold") {
-            m_textData.bold = std::string(child->valuestring) == "true";
-        } else if(name == "color") {
+        switch(detail::classifyKey(child->string))
+        {
+        case detail::Key::Bold:
+            m_textData.bold = detail::isTrue(*child);
+            break;
+        case detail::Key::Colour:
             m_textData.colour = colourFromString(child->valuestring);
-        } else if(name == "fontfamily") {
+            break;
+        case detail::Key::FontFamily:
             m_textData.fontFamily = child->valuestring;
-        } else if(name == "italic") {
-            m_textData.italic = std::string(child->valuestring) == "true";
-        } else if(name == "kerning") {
-            m_textData.kerning = std::string(child->valuestring) == "true";
-        } else if(name == "pixelsize") {
+            break;
+        case detail::Key::Italic:
+            m_textData.italic = detail::isTrue(*child);
+            break;
+        case detail::Key::Kerning:
+            m_textData.kerning = detail::isTrue(*child);
+            break;
+        case detail::Key::PixelSize:
             m_textData.pixelSize = uint32_t(child->valuedouble);
-        } else if(name == "strikeout") {
-            m_textData.strikethough = std::string(child->valuestring) == "true";
-        } else if(name == "underline") {
-            m_textData.underline = std::string(child->valuestring) == "true";
-        } else if(name == "wrap") {
-            m_textData.wrap = std::string(child->valuestring) == "true";
-        } else if(name == "halign") {
+            break;
+        case detail::Key::Strikeout:
+            m_textData.strikethough = detail::isTrue(*child);
+            break;
+        case detail::Key::Underline:
+            m_textData.underline = detail::isTrue(*child);
+            break;
+        case detail::Key::Wrap:
+            m_textData.wrap = detail::isTrue(*child);
+            break;
+        case detail::Key::HAlign:
+        {
             std::string alignment = child->valuestring;
             if (alignment == "left") {
                 m_textData.hAlign = Text::HAlign::Left;
@@ -177,7 +229,10 @@ void Object::parseText(const cJSON& node)
             } else if (alignment == "right") {
                 m_textData.hAlign = Text::HAlign::Right;
             }
-        } else if(name == "valign") {
+        }
+            break;
+        case detail::Key::VAlign:
+        {
             std::string alignment = child->valuestring;
             if (alignment == "top") {
                 m_textData.vAlign = Text::VAlign::Top;
@@ -186,8 +241,13 @@ void Object::parseText(const cJSON& node)
             } else if (alignment == "bottom") {
                 m_textData.vAlign = Text::VAlign::Bottom;
             }
-        } else if(name == "text") {
+        }
+            break;
+        case detail::Key::Text:
             m_textData.content = child->valuestring;
+            break;
+        default:
+            break;
         }
     }
 
@@ -201,61 +261,37 @@ void Object::parseTemplate(const std::string& path, Map* map)
     auto& templateTilesets = map->getTemplateTilesets();
 
     //load the template if not already loaded
-    if (templateObjects.count(path) == 0)
+    if (templateObjects.count(path) == 0 && map->m_failedTemplates.count(path) == 0)
     {
-        auto templatePath = map->getWorkingDirectory() + "/" + path;
-
-        cJSON *doc = cJSON_Parse(templatePath.c_str());
-        if (!doc)
-        {
-            Logger::log("Failed opening template file " + path, Logger::Type::Error);
-            return;
-        }
-
-        cJSON *templateNode = nullptr;
-        for(cJSON *child = doc->child; child != nullptr; child = child->next) {
-            if(std::string(child->string) == "template") {
-                templateNode = child;
-                break;
-            }
-        }
-        if (!templateNode)
+        auto start = std::chrono::steady_clock::now();
+        Object object;
+        Tileset tileset(map->getWorkingDirectory());
+        bool loaded = loadTemplate(path, map->getWorkingDirectory(), object, tileset);
+        auto end = std::chrono::steady_clock::now();
+
+        Map::ExternalFile file;
+        file.path = path;
+        file.type = Map::ExternalFile::Type::Template;
+        file.loaded = loaded;
+        file.loadTime = std::chrono::duration<double, std::milli>(end - start).count();
+        map->m_externalFiles.push_back(file);
+        map->reportProgress(Map::LoadPhase::Templates, templateObjects.size() + map->m_failedTemplates.size() + 1, 0);
+
+        if (!loaded)
         {
-            Logger::log("Template node missing from " + path, Logger::Type::Error);
+            //don't try again for every object using this template
+            map->m_failedTemplates.insert(path);
             return;
         }
 
-        cJSON *objectNode = nullptr;
-        std::string tilesetName;
-        for(cJSON *child = templateNode->child; child != nullptr; child = child->next) {
-            std::string name = child->string;
-            if(name == "tileset") {
-                for(cJSON *tilesetChild = child->child; tilesetChild != nullptr; tilesetChild = tilesetChild->next) {
-                    if(std::string(tilesetChild->string) == "source") {
-                        tilesetName = tilesetChild->valuestring;
-                        break;
-                    }
-                }
-                if (!tilesetName.empty() &&
-                    templateTilesets.count(tilesetName) == 0)
-                {
-                    templateTilesets.insert(std::make_pair(tilesetName, Tileset(map->getWorkingDirectory())));
-                    templateTilesets.at(tilesetName).parse(*child, map);
-                }
-            } else if(name == "object") {
-                objectNode = child;
-            }
-        }
-        //if the template has a tileset load that (if not already loaded)
-
-        //parse the object - don't pass the map pointer here so there's
-        //no recursion if someone tried to get clever and put a template in a template
-        if (objectNode)
+        //if the template has a tileset store that (if not already loaded)
+        const auto tilesetName = detail::toStdString(object.m_tilesetName);
+        if (!tilesetName.empty() &&
+            templateTilesets.count(tilesetName) == 0)
         {
-            templateObjects.insert(std::make_pair(path, Object()));
-            templateObjects[path].parse(*objectNode, nullptr);
-            templateObjects[path].m_tilesetName = tilesetName;
+            templateTilesets.insert(std::make_pair(tilesetName, std::move(tileset)));
         }
+        templateObjects.insert(std::make_pair(path, std::move(object)));
     }
 
     //apply any non-overridden object properties from the template
@@ -396,3 +432,82 @@ void Object::parseTemplate(const std::string& path, Map* map)
         }
     }
 }
+
+bool Object::loadTemplate(const std::string& path, const std::string& workingDir, Object& object, Tileset& tileset)
+{
+    std::string contents;
+    const auto templatePath = resolveFilePath(path, workingDir);
+    if (!readFileIntoString(templatePath, &contents))
+    {
+        Logger::log("Failed opening template file " + path, Logger::Type::Error);
+        return false;
+    }
+
+    cJSON *doc = cJSON_ParseWithLength(contents.data(), contents.size());
+    if (!doc)
+    {
+        Logger::log("Failed parsing template file " + path, Logger::Type::Error);
+        return false;
+    }
+
+    cJSON *templateNode = nullptr;
+    for(cJSON *child = doc->child; child != nullptr; child = child->next) {
+        if(detail::classifyKey(child->string) == detail::Key::Template) {
+            templateNode = child;
+            break;
+        } else if(detail::classifyKey(child->string) == detail::Key::Type && child->valuestring != nullptr
+            && std::string(child->valuestring) == "template") {
+            //templates exported by Tiled are stored in the root object
+            templateNode = doc;
+        }
+    }
+    if (!templateNode)
+    {
+        Logger::log("Template node missing from " + path, Logger::Type::Error);
+        cJSON_Delete(doc);
+        return false;
+    }
+
+    cJSON *objectNode = nullptr;
+    std::string tilesetName;
+    for(cJSON *child = templateNode->child; child != nullptr; child = child->next) {
+        const auto key = detail::classifyKey(child->string);
+        if(key == detail::Key::Tileset) {
+            std::uint32_t firstGID = 0;
+            for(cJSON *tilesetChild = child->child; tilesetChild != nullptr; tilesetChild = tilesetChild->next) {
+                const auto tilesetKey = detail::classifyKey(tilesetChild->string);
+                if(tilesetKey == detail::Key::Source && tilesetChild->valuestring != nullptr) {
+                    tilesetName = tilesetChild->valuestring;
+                } else if(tilesetKey == detail::Key::FirstGID) {
+                    firstGID = std::uint32_t(tilesetChild->valuedouble);
+                }
+            }
+
+            if (firstGID == 0) {
+                Logger::log("Invalid first GID in template tileset. Tileset node skipped.", Logger::Type::Warning);
+                tilesetName.clear();
+            } else if (!tilesetName.empty()) {
+                tileset.loadWithoutMap(tilesetName);
+                tileset.setFirstGID(firstGID);
+            }
+        } else if(key == detail::Key::Object) {
+            objectNode = child;
+        }
+    }
+
+    //parse the object - don't pass the map pointer here so there's
+    //no recursion if someone tried to get clever and put a template in a template
+    if (objectNode)
+    {
+        object.parse(*objectNode, nullptr);
+        detail::assignString(object.m_tilesetName, tilesetName);
+    }
+    cJSON_Delete(doc);
+
+    if (!objectNode)
+    {
+        Logger::log("Object missing from template " + path, Logger::Type::Error);
+        return false;
+    }
+    return true;
+}
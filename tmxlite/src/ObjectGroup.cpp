@@ -33,6 +33,8 @@ source distribution.
 #include <tmxlite/FreeFuncs.hpp>
 #include <tmxlite/ObjectGroup.hpp>
 #include <tmxlite/detail/Log.hpp>
+#include "detail/JsonReader.hpp"
+#include "detail/Keys.hpp"
 
 using namespace tmx;
 
@@ -43,22 +45,40 @@ ObjectGroup::ObjectGroup()
 
 }
 
-bool ObjectGroup::parseChild(const struct cJSON &child, tmx::Map* map)
+bool ObjectGroup::parseChild(detail::Key key, const struct cJSON &child, tmx::Map* map)
 {
-    std::string childName = child.string;
-    if(childName == "objects") {
+    switch(key)
+    {
+    case detail::Key::Objects:
         for(cJSON *objectNode = child.child; objectNode != nullptr; objectNode = objectNode->next) {
             m_objects.emplace_back();
             m_objects.back().parse(*objectNode, map);
         }
-    } else if(childName == "draworder") {
+        break;
+    case detail::Key::DrawOrder:
         if(std::string(child.valuestring) == "index") {
             m_drawOrder = DrawOrder::Index;
         } else {
             m_drawOrder = DrawOrder::TopDown;
         }
-    } else {
-        return Layer::parseChild(child, map);
+        break;
+    default:
+        return Layer::parseChild(key, child, map);
     }
     return true;
 }
+
+bool ObjectGroup::parseChildStream(detail::Key key, tmx::detail::JsonReader& reader, tmx::Map* map)
+{
+    if(key == detail::Key::Objects) {
+        if(!reader.beginArray()) {
+            return false;
+        }
+        while(reader.nextElement()) {
+            m_objects.emplace_back();
+            m_objects.back().parseStream(reader, map);
+        }
+        return !reader.failed();
+    }
+    return Layer::parseChildStream(key, reader, map);
+}
@@ -3,13 +3,15 @@
 #include <tmxlite/Parsable.hpp>
 #include <tmxlite/Map.hpp>
 #include <tmxlite/detail/Log.hpp>
+#include "detail/JsonReader.hpp"
+#include "detail/Keys.hpp"
 #include <sstream>
 
 bool Parsable::parse(const cJSON &node, tmx::Map *map)
 {
     bool retval = true;
     for(cJSON *child = node.child; child != nullptr; child = child->next) {
-        if(!parseChild(*child, map)) {
+        if(!parseChild(tmx::detail::classifyKey(child->string), *child, map)) {
             std::stringstream logmsg;
             logmsg << "Failed to parse node: " << child->string;
             LOG(logmsg.str().c_str(), tmx::Logger::Type::Error);
@@ -17,4 +19,31 @@ bool Parsable::parse(const cJSON &node, tmx::Map *map)
         }
     }
     return retval;
-}
\ No newline at end of file
+}
+
+bool Parsable::parseStream(tmx::detail::JsonReader &reader, tmx::Map *map)
+{
+    if(!reader.beginObject()) {
+        return false;
+    }
+
+    bool retval = true;
+    while(reader.nextKey()) {
+        if(!parseChildStream(tmx::detail::classifyKey(reader.getKey()), reader, map)) {
+            std::stringstream logmsg;
+            logmsg << "Failed to parse node: " << reader.getKey();
+            LOG(logmsg.str().c_str(), tmx::Logger::Type::Error);
+            retval = false;
+        }
+    }
+    return retval && !reader.failed();
+}
+
+bool Parsable::parseChildStream(tmx::detail::Key key, tmx::detail::JsonReader &reader, tmx::Map *map)
+{
+    tmx::detail::JsonValue value;
+    if(!reader.readValue(value, reader.getKey().c_str())) {
+        return false;
+    }
+    return parseChild(key, value.get(), map);
+}
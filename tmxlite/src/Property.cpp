@@ -33,6 +33,8 @@ source distribution.
 #include <tmxlite/Property.hpp>
 #include <tmxlite/detail/Log.hpp>
 #include <tmxlite/FreeFuncs.hpp>
+#include "detail/JsonReader.hpp"
+#include "detail/Keys.hpp"
 
 using namespace tmx;
 
@@ -41,9 +43,9 @@ Property::Property()
 {
 }
 
-std::vector<Property> Property::readProperties(const cJSON &node)
+Vector<Property> Property::readProperties(const cJSON &node)
 {
-    std::vector<Property> output;
+    Vector<Property> output;
     for(cJSON* propNode = node.child; propNode != nullptr; propNode = propNode->next)
     {
         output.emplace_back();
@@ -80,7 +82,7 @@ Property Property::fromString(const std::string& value)
 {
     Property p;
     p.m_type = Type::String;
-    p.m_stringValue = value;
+    detail::assignString(p.m_stringValue, value);
     return p;
 }
 
@@ -96,7 +98,7 @@ Property Property::fromFile(const std::string& value)
 {
     Property p;
     p.m_type = Type::File;
-    p.m_stringValue = value;
+    detail::assignString(p.m_stringValue, value);
     return p;
 }
 
@@ -112,9 +114,10 @@ Property Property::fromObject(int value)
 void Property::parse(const cJSON& node, bool isObjectTypes)
 {
     // The value attribute name is different in object types
-    const char *const valueAttribute = isObjectTypes ? "default" : "value";
+    const detail::Key valueAttribute = isObjectTypes ? detail::Key::Default : detail::Key::Value;
 
-    std::string attribData = node.string;
+    //properties stored in an array have no name
+    std::string attribData = node.string != nullptr ? node.string : "property";
     if (attribData != "property")
     {
         Logger::log("Node was not a valid property, node will be skipped", Logger::Type::Error);
@@ -124,21 +127,20 @@ void Property::parse(const cJSON& node, bool isObjectTypes)
     attribData = "string";
     cJSON *valueNode = nullptr, *propertyNode = nullptr;
     for(cJSON *child = node.child; child != nullptr; child = child->next) {
-        std::string childName = std::string(child->string);
-        if(childName == "name") {
+        const auto key = detail::classifyKey(child->string);
+        if(key == detail::Key::Name) {
             m_name = child->valuestring;
-        } else if(childName == "type") {
+        } else if(key == detail::Key::Type) {
             attribData = child->valuestring;
-        } else if(childName == valueAttribute) {
+        } else if(key == valueAttribute) {
             valueNode = child;
-        } else if(childName == "propertytype") {
+        } else if(key == detail::Key::PropertyType) {
             propertyNode = child;
         }
     }
     if (attribData == "bool")
     {
-        attribData = valueNode != nullptr ? valueNode->valuestring : "false";;
-        m_boolValue = (attribData == "true");
+        m_boolValue = valueNode != nullptr && detail::isTrue(*valueNode);
         m_type = Type::Boolean;
         return;
     }
@@ -156,11 +158,12 @@ void Property::parse(const cJSON& node, bool isObjectTypes)
     }
     else if (attribData == "string")
     {
-        m_stringValue = valueNode != nullptr ? valueNode->string : "";
+        m_stringValue = (valueNode != nullptr && valueNode->valuestring != nullptr) ? valueNode->valuestring : "";
 
         //if value is empty, try getting the child value instead
         //as this is how multiline string properties are stored.
-        if(m_stringValue.empty() && valueNode != nullptr)
+        if(m_stringValue.empty() && valueNode != nullptr
+            && valueNode->child != nullptr && valueNode->child->valuestring != nullptr)
         {
             m_stringValue = valueNode->child->valuestring;
         }
@@ -191,10 +194,11 @@ void Property::parse(const cJSON& node, bool isObjectTypes)
         m_type = Type::Class;
         m_propertyType = propertyNode != nullptr ? propertyNode->valuestring : "null";
 
-        const std::string firstChildName = propertyNode->child != nullptr ? propertyNode->child->string : "";
+        const std::string firstChildName = (propertyNode != nullptr && propertyNode->child != nullptr && propertyNode->child->string != nullptr)
+            ? propertyNode->child->string : "";
         if (firstChildName == "properties" && propertyNode->child->child != nullptr)
         {
-            for(cJSON *childProp = propertyNode->child->child; childProp != nullptr; childProp++)
+            for(cJSON *childProp = propertyNode->child->child; childProp != nullptr; childProp = childProp->next)
             {
                 m_classValue.emplace_back();
                 m_classValue.back().parse(*childProp);
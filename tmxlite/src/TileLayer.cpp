@@ -27,45 +27,87 @@ source distribution.
 
 #ifdef USE_EXTLIBS
 #include <cJSON/cJSON.h>
-#include <zstd.h>
 #else
 #include "detail/cJSON.h"
 #endif
 
-#ifdef USE_ZSTD
-#include <zstd.h>
-#endif
-
 #include <tmxlite/FreeFuncs.hpp>
 #include <tmxlite/TileLayer.hpp>
+#include <tmxlite/Map.hpp>
 #include <tmxlite/detail/Log.hpp>
+#include "detail/JsonReader.hpp"
+#include "detail/Keys.hpp"
+#include "detail/Gid.hpp"
+#include "detail/TileDataReader.hpp"
 
-#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <limits>
 
 using namespace tmx;
 
+constexpr std::size_t TileLayer::DecodeBlockSize;
+
+namespace
+{
+    std::int64_t floorDiv(std::int64_t value, std::int64_t divisor)
+    {
+        const auto result = value / divisor;
+        return (value % divisor != 0 && (value < 0) != (divisor < 0)) ? result - 1 : result;
+    }
+
+    std::uint64_t cellKey(std::int64_t x, std::int64_t y)
+    {
+        return (std::uint64_t(std::uint32_t(x)) << 32) | std::uint32_t(y);
+    }
+
+    //the number of tiles in a chunk, or 0 if its size is negative
+    //or so large that the tile count would not fit in an int
+    std::size_t getChunkTileCount(const TileLayer::Chunk& chunk)
+    {
+        if(chunk.size.x <= 0 || chunk.size.y <= 0
+            || chunk.size.x > std::numeric_limits<int>::max() / chunk.size.y) {
+            return 0;
+        }
+        return std::size_t(chunk.size.x) * std::size_t(chunk.size.y);
+    }
+}
 
 TileLayer::TileLayer(std::size_t tileCount)
-    : m_tileCount (tileCount),
+    : m_encoding(EncodingType::Csv),
+    m_tileCount (tileCount),
     m_compression(CompressionType::None),
-    m_encoding(EncodingType::Csv)
+    m_zstdDictionary(nullptr),
+    m_hasData(false),
+    m_decoded(false),
+    m_storage(Storage::Tiles),
+    m_denseStorage(Storage::Tiles),
+    m_sparseThreshold(0.f),
+    m_forms(static_cast<std::uint8_t>(Storage::Tiles))
 {
-    m_tiles.reserve(tileCount);
+
 }
 
 
-bool TileLayer::parseChild(const struct cJSON &child, tmx::Map* map)
+bool TileLayer::parseChild(detail::Key key, const struct cJSON &child, tmx::Map* map)
 {
-    std::string childName = child.string;
-    if(childName == "data") {
-        m_dataNode = &child;
-    } else if(childName == "chunks") {
-        m_chunkNode = &child;
-    } else if(childName == "width") {
+    switch(key)
+    {
+    case detail::Key::Data:
+        m_hasData = true;
+        readTileData(child, m_pendingIDs, m_encodedData);
+        break;
+    case detail::Key::Chunks:
+        readChunks(child);
+        break;
+    case detail::Key::Width:
         m_size.x = (unsigned int)child.valuedouble;
-    } else if(childName == "height") {
+        break;
+    case detail::Key::Height:
         m_size.y = (unsigned int)child.valuedouble;
-    } else if(childName == "compression") {
+        break;
+    case detail::Key::Compression:
+    {
         std::string strCompressionType = child.valuestring;
         if(strCompressionType == "zlib") {
             m_compression = CompressionType::Zlib;
@@ -74,107 +116,362 @@ bool TileLayer::parseChild(const struct cJSON &child, tmx::Map* map)
         } else if(strCompressionType == "zstd") {
             m_compression = CompressionType::Zstd;
         }
-    } else if(childName == "encoding") {
+    }
+        break;
+    case detail::Key::Encoding:
         if(std::string(child.valuestring) == "base64") {
             m_encoding = EncodingType::Base64;
         } else {
             m_encoding = EncodingType::Csv;
         }
-    } else {
-        return Layer::parseChild(child, map);
+        break;
+    default:
+        return Layer::parseChild(key, child, map);
     }
     return true;
 }
 
+bool TileLayer::parseChildStream(detail::Key key, tmx::detail::JsonReader& reader, tmx::Map* map)
+{
+    switch(key)
+    {
+    case detail::Key::Data:
+        m_hasData = true;
+        return readTileData(reader, m_tileCount, m_pendingIDs, m_encodedData);
+    case detail::Key::Chunks:
+        return readChunks(reader);
+    default:
+        return Layer::parseChildStream(key, reader, map);
+    }
+}
+
 //public
 bool TileLayer::parse(const cJSON& node, Map* map)
 {
     bool retval = Parsable::parse(node, map);
     if(retval) {
-        if(m_chunkNode != nullptr) {
-            parseChunks(*m_chunkNode);
-        }
-        if(m_dataNode != nullptr) {
-            if (m_encoding == EncodingType::Base64) {
-                parseBase64(*m_dataNode);
-            } else if (m_encoding == EncodingType::Csv) {
-                parseCSV(*m_dataNode);
-            }
-        }
+        parseComplete(map);
     }
     return retval;
 }
 
-std::vector<uint32_t> TileLayer::parseTileIds(const cJSON& node, std::size_t tileCount)
+bool TileLayer::parseStream(tmx::detail::JsonReader& reader, Map* map)
 {
-    std::vector<std::uint32_t> IDs;
-    if(m_encoding == EncodingType::Base64) {
-        std::string dataString = node.valuestring;
-        std::stringstream ss;
-        ss << dataString;
-        ss >> dataString;
-        dataString = base64_decode(dataString);
+    bool retval = Parsable::parseStream(reader, map);
+    if(retval) {
+        parseComplete(map);
+    }
+    return retval;
+}
 
-        std::size_t expectedSize = tileCount * 4; //4 bytes per tile
-        std::vector<unsigned char> byteData;
-        byteData.reserve(expectedSize);
+void TileLayer::decodeAll() const
+{
+    if(isDecoded()) {
+        return;
+    }
 
-        switch (m_compression)
-        {
-        default:
-            byteData.insert(byteData.end(), dataString.begin(), dataString.end());
-            break;
-        case CompressionType::Zstd:
-#if defined USE_ZSTD || defined USE_EXTLIBS
+    std::lock_guard<std::mutex> lock(m_decodeMutex);
+    if(!m_decoded.load(std::memory_order_relaxed)) {
+        //decoding only replaces the encoded data owned by
+        //the layer with the decoded tiles, so is logically const
+        const_cast<TileLayer*>(this)->decode();
+        m_decoded.store(true, std::memory_order_release);
+    }
+}
+
+//private
+void TileLayer::parseComplete(Map* map)
+{
+    if(m_size.x != 0 && m_size.y != 0) {
+        m_tileCount = m_size.x * m_size.y;
+    }
+
+    if(map != nullptr) {
+        m_zstdDictionary = map->getZstdDictionary();
+        setStorage(getStorage(*map), map->getSparseThreshold());
+    }
+
+    if(m_hasData && m_encodedData.empty() && m_pendingIDs.empty() && m_pendingChunks.empty()) {
+        Logger::log("Layer " + detail::toStdString(getName()) + " has no layer data. Layer skipped.", Logger::Type::Error);
+    }
+
+    //when using worker threads the map decodes all the layers together once loaded
+    if(map == nullptr
+        || (map->getTileDecoding() == Map::TileDecoding::Eager && map->getWorkerThreadCount() == 1)) {
+        decodeAll();
+    }
+}
+
+void TileLayer::decode()
+{
+    for(auto i = 0u; i < getDecodeTaskCount(); ++i) {
+        decodeTask(i);
+    }
+    finishDecode();
+}
+
+std::size_t TileLayer::getDecodeTaskCount() const
+{
+    return m_pendingChunks.size() + 1;
+}
+
+void TileLayer::decodeTask(std::size_t index)
+{
+    if(index < m_pendingChunks.size()) {
+        auto& pending = m_pendingChunks[index];
+        auto& chunk = pending.chunk;
+        if(!pending.encoded.empty()) {
+            decodeTiles(pending.encoded.data(), pending.encoded.size(), getChunkTileCount(chunk), getStore(chunk));
+        } else {
+            createTiles(pending.IDs.data(), pending.IDs.size(), getStore(chunk));
+        }
+    } else {
+        if(!m_encodedData.empty()) {
+            decodeTiles(m_encodedData.data(), m_encodedData.size(), m_tileCount, getStore());
+        } else {
+            createTiles(m_pendingIDs.data(), m_pendingIDs.size(), getStore());
+        }
+    }
+}
+
+void TileLayer::finishDecode()
+{
+    m_palette.finish();
+    m_sparse.finish();
+    for(auto& pending : m_pendingChunks) {
+        auto& chunk = pending.chunk;
+        chunk.palette.finish();
+        chunk.sparse.finish();
+        if(!chunk.tiles.empty() || !chunk.tileIDs.empty() || !chunk.GIDs.empty()
+            || !chunk.palette.empty() || !chunk.sparse.empty()) {
+            m_chunks.push_back(std::move(pending.chunk));
+        }
+    }
+
+    std::string().swap(m_encodedData);
+    std::vector<std::uint32_t>().swap(m_pendingIDs);
+    std::vector<PendingChunk>().swap(m_pendingChunks);
+
+    applySparseThreshold();
+    buildChunkIndex();
+}
+
+void TileLayer::readTileData(const cJSON& node, std::vector<std::uint32_t>& IDs, std::string& encoded)
+{
+    if(node.valuestring != nullptr) {
+        encoded = node.valuestring;
+    } else {
+        IDs.reserve(cJSON_GetArraySize(&node));
+        for(cJSON* tileId = node.child; tileId != nullptr; tileId = tileId->next) {
+            IDs.push_back(std::uint32_t(tileId->valuedouble));
+        }
+    }
+}
+
+void TileLayer::readChunks(const cJSON& chunksNode)
+{
+    for(cJSON* child = chunksNode.child; child != nullptr; child = child->next) {
+        PendingChunk pending;
+        auto& chunk = pending.chunk;
+        for(cJSON* chunkNode = child->child; chunkNode != nullptr; chunkNode = chunkNode->next) {
+            switch(detail::classifyKey(chunkNode->string))
             {
-                std::size_t dataSize = dataString.length() * sizeof(unsigned char);
-                std::size_t result = ZSTD_decompress(byteData.data(), expectedSize, &dataString[0], dataSize);
-                
-                if (ZSTD_isError(result))
-                {
-                    std::string err = ZSTD_getErrorName(result);
-                    LOG("Failed to decompress layer data, node skipped.\nError: " + err, Logger::Type::Error);
-                }
+            case detail::Key::X:
+                chunk.position.x = int(chunkNode->valuedouble);
+                break;
+            case detail::Key::Y:
+                chunk.position.y = int(chunkNode->valuedouble);
+                break;
+            case detail::Key::Width:
+                chunk.size.x = int(chunkNode->valuedouble);
+                break;
+            case detail::Key::Height:
+                chunk.size.y = int(chunkNode->valuedouble);
+                break;
+            case detail::Key::Data:
+                readTileData(*chunkNode, pending.IDs, pending.encoded);
+                break;
+            default:
+                break;
             }
-#else
-            Logger::log("Library must be built with USE_EXTLIBS or USE_ZSTD for Zstd compression", Logger::Type::Error);
-            return {};
-#endif
-        case CompressionType::GZip:
-#ifndef USE_EXTLIBS
-            Logger::log("Library must be built with USE_EXTLIBS for GZip compression", Logger::Type::Error);
-            return {};
-#endif
-            //[[fallthrough]];
-        case CompressionType::Zlib:
-        {
-            //unzip
-            std::size_t dataSize = dataString.length() * sizeof(unsigned char);
+        }
+        if(getChunkTileCount(chunk) == 0) {
+            LOG("Invalid chunk size, chunk skipped.", Logger::Type::Error);
+            continue;
+        }
+        m_pendingChunks.push_back(std::move(pending));
+    }
+}
 
-            if (!decompress(dataString.c_str(), byteData, dataSize, expectedSize))
+bool TileLayer::readTileData(tmx::detail::JsonReader& reader, std::size_t expectedCount,
+    std::vector<std::uint32_t>& IDs, std::string& encoded)
+{
+    if(reader.peek() == detail::JsonReader::Type::String) {
+        return reader.readString(encoded);
+    } else if(reader.peek() == detail::JsonReader::Type::Array) {
+        reader.beginArray();
+        IDs.reserve(expectedCount);
+        while(reader.nextElement()) {
+            std::uint32_t id = 0;
+            if(!reader.readUnsigned(id)) {
+                return false;
+            }
+            IDs.push_back(id);
+        }
+        return !reader.failed();
+    }
+    return reader.skipValue();
+}
+
+bool TileLayer::readChunks(tmx::detail::JsonReader& reader)
+{
+    if(!reader.beginArray()) {
+        return false;
+    }
+
+    while(reader.nextElement()) {
+        if(!reader.beginObject()) {
+            return false;
+        }
+
+        PendingChunk pending;
+        auto& chunk = pending.chunk;
+        while(reader.nextKey()) {
+            double value = 0.0;
+            switch(detail::classifyKey(reader.getKey()))
             {
-                LOG("Failed to decompress layer data, node skipped.", Logger::Type::Error);
-                return {};
+            case detail::Key::X:
+                reader.readNumber(value);
+                chunk.position.x = int(value);
+                break;
+            case detail::Key::Y:
+                reader.readNumber(value);
+                chunk.position.y = int(value);
+                break;
+            case detail::Key::Width:
+                reader.readNumber(value);
+                chunk.size.x = int(value);
+                break;
+            case detail::Key::Height:
+                reader.readNumber(value);
+                chunk.size.y = int(value);
+                break;
+            case detail::Key::Data:
+                //the size of the chunk is usually found after its data
+                readTileData(reader, getChunkTileCount(chunk), pending.IDs, pending.encoded);
+                break;
+            default:
+                reader.skipValue();
+                break;
             }
         }
-            break;
+        if(reader.failed()) {
+            return false;
         }
 
-        //data stream is in bytes so we need to OR into 32 bit values
-        IDs.reserve(tileCount);
-        for (auto i = 0u; i < expectedSize - 3u; i += 4u)
-        {
-            std::uint32_t id = byteData[i] | byteData[i + 1] << 8 | byteData[i + 2] << 16 | byteData[i + 3] << 24;
-            IDs.push_back(id);
+        if(getChunkTileCount(chunk) == 0) {
+            LOG("Invalid chunk size, chunk skipped.", Logger::Type::Error);
+            continue;
+        }
+        m_pendingChunks.push_back(std::move(pending));
+    }
+    return !reader.failed();
+}
+
+std::vector<uint32_t> TileLayer::parseTileIds(const cJSON& node, std::size_t tileCount)
+{
+    std::vector<std::uint32_t> IDs;
+    if(m_encoding == EncodingType::Base64) {
+        if(node.valuestring != nullptr) {
+            IDs = decodeBase64(node.valuestring, std::strlen(node.valuestring), tileCount);
         }
     } else {
+        IDs.reserve(tileCount);
         for(cJSON *tileId = node.child; tileId != nullptr; tileId = tileId->next) {
-            IDs.push_back(uint32_t(tileId->valueint));
+            IDs.push_back(uint32_t(tileId->valuedouble));
         }
     }
     return IDs;
 }
 
+std::vector<std::uint32_t> TileLayer::decodeBase64(const char* data, std::size_t length, std::size_t tileCount)
+{
+    std::vector<std::uint32_t> IDs(tileCount);
+    detail::TileDataReader reader(data, length, m_compression, m_zstdDictionary, tileCount);
+
+    //tile count is only a hint, so read anything beyond it as well
+    auto count = reader.read(IDs.data(), IDs.size());
+    while (count == IDs.size() && !reader.failed())
+    {
+        IDs.resize(count + DecodeBlockSize);
+        count += reader.read(IDs.data() + count, DecodeBlockSize);
+    }
+
+    if (reader.failed())
+    {
+        LOG("Failed to decompress layer data, node skipped.", Logger::Type::Error);
+        return {};
+    }
+    IDs.resize(count);
+    return IDs;
+}
+
+void TileLayer::decodeTiles(const char* data, std::size_t length, std::size_t tileCount, const TileStore& store)
+{
+    const auto tileStart = store.tiles.size();
+    const auto arrayStart = store.tileIDs.size();
+    const auto GIDStart = store.GIDs.size();
+    detail::TileDataReader reader(data, length, m_compression, m_zstdDictionary, tileCount);
+
+    if (m_storage == Storage::GIDs)
+    {
+        //GIDs are kept as they are, so are decoded straight into the vector
+        auto& GIDs = store.GIDs;
+        GIDs.resize(GIDStart + tileCount);
+        auto count = reader.read(GIDs.data() + GIDStart, tileCount);
+        while (count == GIDs.size() - GIDStart && !reader.failed())
+        {
+            GIDs.resize(GIDs.size() + DecodeBlockSize);
+            count += reader.read(GIDs.data() + GIDStart + count, DecodeBlockSize);
+        }
+        GIDs.resize(GIDStart + count);
+    }
+    else
+    {
+        reserveTiles(store, tileCount);
+
+        //a layer without chunks can be stored in the set form as soon
+        //as it has too many tiles to be sparse, rather than once decoded
+        const bool checkSparse = m_storage == Storage::Sparse
+            && &store.sparse == &m_sparse && m_pendingChunks.empty();
+
+        //GIDs are decoded in blocks directly into the tiles
+        std::uint32_t IDs[DecodeBlockSize];
+        std::size_t count = 0;
+        while ((count = reader.read(IDs, DecodeBlockSize)) != 0)
+        {
+            createTiles(IDs, count, store);
+            if (checkSparse && m_storage == Storage::Sparse
+                && double(m_sparse.getTiles().size()) >= double(tileCount) * m_sparseThreshold)
+            {
+                storeDense();
+                reserveTiles(store, tileCount);
+            }
+        }
+    }
+
+    if (reader.failed())
+    {
+        LOG("Failed to decompress layer data, node skipped.", Logger::Type::Error);
+        store.tiles.resize(tileStart);
+        store.tileIDs.resize(arrayStart);
+        store.flipFlags.resize(arrayStart);
+        store.GIDs.resize(GIDStart);
+        store.palette.clear();
+        store.sparse = SparseTiles();
+    }
+}
+
 bool TileLayer::parseChunks(const cJSON &chunkNode)
 {
     //check for chunk nodes
@@ -182,78 +479,610 @@ bool TileLayer::parseChunks(const cJSON &chunkNode)
     for(cJSON *child = chunkNode.child; child != nullptr; child = child->next)
     {
         Chunk chunk;
+        const cJSON* dataNode = nullptr;
         for(cJSON *chunkNode = child->child; chunkNode != nullptr; chunkNode = chunkNode->next) {
-            std::string chunkNodeName = chunkNode->string;
-            if(chunkNodeName == "x") {
+            switch(detail::classifyKey(chunkNode->string))
+            {
+            case detail::Key::X:
                 chunk.position.x = int(chunkNode->valuedouble);
-            } else if(chunkNodeName == "y") {
+                break;
+            case detail::Key::Y:
                 chunk.position.y = int(chunkNode->valuedouble);
-            } else if(chunkNodeName == "width") {
+                break;
+            case detail::Key::Width:
                 chunk.size.x = int(chunkNode->valuedouble);
-            } else if(chunkNodeName == "height") {
+                break;
+            case detail::Key::Height:
                 chunk.size.y = int(chunkNode->valuedouble);
-            } else if(chunkNodeName == "data") {
-                chunk.dataNode = chunkNode;
+                break;
+            case detail::Key::Data:
+                dataNode = chunkNode;
+                break;
+            default:
+                break;
             }
         }
-        if(chunk.dataNode != nullptr) {
-            auto IDs = parseTileIds(*chunk.dataNode, (chunk.size.x * chunk.size.y));
+        const auto tileCount = getChunkTileCount(chunk);
+        if(tileCount == 0) {
+            LOG("Invalid chunk size, chunk skipped.", Logger::Type::Error);
+        } else if(dataNode != nullptr) {
+            auto IDs = parseTileIds(*dataNode, tileCount);
 
             if (!IDs.empty())
             {
-                createTiles(IDs, chunk.tiles);
-                m_chunks.push_back(chunk);
+                createTiles(IDs.data(), IDs.size(), getStore(chunk));
+                chunk.palette.finish();
+                chunk.sparse.finish();
+                m_chunks.push_back(std::move(chunk));
                 dataCount++;
             }
         }
     }
+    buildChunkIndex();
     return dataCount != 0;
 }
 
-//private
-void TileLayer::parseBase64(const cJSON& node)
+void TileLayer::createTiles(const std::uint32_t* source, std::size_t count, const TileStore& store)
 {
-    std::string data = node.valuestring;
-    if (data.empty())
+    //LOG(IDs.size() != m_tileCount, "Layer tile count does not match expected size. Found: "
+    //    + std::to_string(IDs.size()) + ", expected: " + std::to_string(m_tileCount));
+
+    switch (m_storage)
     {
-        if (!parseChunks(node))
-        {
-            Logger::log("Layer " + getName() + " has no layer data. Layer skipped.", Logger::Type::Error);
-            return;
+    case Storage::GIDs:
+        store.GIDs.insert(store.GIDs.end(), source, source + count);
+        return;
+    case Storage::Arrays:
+    {
+        const auto start = store.tileIDs.size();
+        store.tileIDs.resize(start + count);
+        store.flipFlags.resize(start + count);
+        detail::unpackGIDs(source, count, store.tileIDs.data() + start, store.flipFlags.data() + start);
+    }
+        return;
+    case Storage::Palette:
+        store.palette.append(source, count);
+        return;
+    case Storage::Sparse:
+        store.sparse.append(source, count);
+        return;
+    case Storage::Tiles:
+        break;
+    }
+
+    static const std::uint32_t mask = detail::GIDFlagMask;
+    auto& tiles = store.tiles;
+    tiles.reserve(tiles.size() + count);
+    for (auto i = 0u; i < count; ++i)
+    {
+        const auto id = source[i];
+        tiles.emplace_back();
+        tiles.back().flipFlags = ((id & mask) >> 28);
+        tiles.back().ID = id & ~mask;
+    }
+}
+
+std::size_t TileLayer::decodeGIDs(std::uint32_t* dest, std::size_t count) const
+{
+    if(!isDecoded()) {
+        std::lock_guard<std::mutex> lock(m_decodeMutex);
+        if(!m_decoded.load(std::memory_order_relaxed)) {
+            //read from the encoded data, which is kept for the layer to decode later
+            if(!m_encodedData.empty()) {
+                detail::TileDataReader reader(m_encodedData.data(), m_encodedData.size(),
+                    m_compression, m_zstdDictionary, std::min(count, m_tileCount));
+                const auto written = reader.read(dest, count);
+                if(reader.failed()) {
+                    LOG("Failed to decompress layer data.", Logger::Type::Error);
+                    return 0;
+                }
+                return written;
+            }
+
+            const auto written = std::min(count, m_pendingIDs.size());
+            std::copy(m_pendingIDs.begin(), m_pendingIDs.begin() + written, dest);
+            return written;
         }
     }
-    else
+
+    //the stored form is never released, so can be read without the lock
+    const auto store = const_cast<TileLayer*>(this)->getStore();
+    const auto written = std::min(count, getStoredCount(store));
+    packGIDs(store, 0, written, dest);
+    return written;
+}
+
+void TileLayer::setStorage(Storage storage, float sparseThreshold)
+{
+    //with a threshold the tiles are decoded as sparse tiles,
+    //then converted to the given storage if they are too dense
+    m_denseStorage = storage;
+    m_sparseThreshold = sparseThreshold;
+    m_storage = sparseThreshold > 0.f ? Storage::Sparse : storage;
+    m_forms.store(static_cast<std::uint8_t>(m_storage), std::memory_order_relaxed);
+}
+
+TileLayer::Storage TileLayer::getStorage(const Map& map)
+{
+    switch(map.getTileStorage())
     {
-        auto IDs = parseTileIds(node, m_tileCount);
-        createTiles(IDs, m_tiles);
+    case Map::TileStorage::Arrays:
+        return Storage::Arrays;
+    case Map::TileStorage::GIDs:
+        return Storage::GIDs;
+    case Map::TileStorage::Palette:
+        return Storage::Palette;
+    case Map::TileStorage::Tiles:
+        break;
     }
+    return Storage::Tiles;
 }
 
-void TileLayer::parseCSV(const cJSON& node)
+void TileLayer::convertStorage(Storage form) const
 {
-    std::vector<uint32_t> tileIds;
-    for(cJSON* idElem = node.child; idElem != nullptr; idElem = idElem->next) {
-        tileIds.push_back(uint32_t(idElem->valuedouble));
+    std::lock_guard<std::mutex> lock(m_decodeMutex);
+    const auto forms = m_forms.load(std::memory_order_relaxed);
+    if((forms & static_cast<std::uint8_t>(form)) != 0) {
+        return;
+    }
+
+    //the stored form is first packed into GIDs, unless those are
+    //what is stored, then unpacked into the requested form. Creating
+    //another form only adds to the data owned by the layer, so is
+    //logically const
+    auto* layer = const_cast<TileLayer*>(this);
+    const auto store = layer->getStore();
+    std::vector<std::uint32_t> packed;
+    const std::vector<std::uint32_t>* GIDs = &m_GIDs;
+    if(m_storage != Storage::GIDs) {
+        auto& target = (form == Storage::GIDs) ? layer->m_GIDs : packed;
+        target.resize(getStoredCount(store));
+        packGIDs(store, 0, target.size(), target.data());
+        GIDs = &target;
+    }
+
+    switch(form)
+    {
+    case Storage::Tiles:
+    {
+        static const std::uint32_t mask = detail::GIDFlagMask;
+        layer->m_tiles.resize(GIDs->size());
+        for(auto i = 0u; i < m_tiles.size(); ++i) {
+            layer->m_tiles[i].ID = (*GIDs)[i] & ~mask;
+            layer->m_tiles[i].flipFlags = (((*GIDs)[i] & mask) >> 28);
+        }
+    }
+        break;
+    case Storage::Arrays:
+        layer->m_tileIDs.resize(GIDs->size());
+        layer->m_flipFlags.resize(GIDs->size());
+        detail::unpackGIDs(GIDs->data(), GIDs->size(), layer->m_tileIDs.data(), layer->m_flipFlags.data());
+        break;
+    case Storage::Palette:
+        layer->m_palette.reserve(GIDs->size());
+        layer->m_palette.append(GIDs->data(), GIDs->size());
+        layer->m_palette.finish();
+        break;
+    case Storage::Sparse:
+        layer->m_sparse.append(GIDs->data(), GIDs->size());
+        layer->m_sparse.finish();
+        break;
+    case Storage::GIDs:
+        break;
+    }
+    m_forms.store(forms | static_cast<std::uint8_t>(form), std::memory_order_release);
+}
+
+std::size_t TileLayer::getStoredCount(const TileStore& store) const
+{
+    switch(m_storage)
+    {
+    case Storage::Arrays:
+        return store.tileIDs.size();
+    case Storage::GIDs:
+        return store.GIDs.size();
+    case Storage::Palette:
+        return store.palette.size();
+    case Storage::Sparse:
+        return store.sparse.size();
+    case Storage::Tiles:
+        break;
+    }
+    return store.tiles.size();
+}
+
+void TileLayer::packGIDs(const TileStore& store, std::size_t first, std::size_t count, std::uint32_t* dest) const
+{
+    switch(m_storage)
+    {
+    case Storage::Tiles:
+        for(auto i = 0u; i < count; ++i) {
+            const auto& tile = store.tiles[first + i];
+            dest[i] = tile.ID | (std::uint32_t(tile.flipFlags) << 28);
+        }
+        break;
+    case Storage::Arrays:
+        for(auto i = 0u; i < count; ++i) {
+            dest[i] = store.tileIDs[first + i] | (std::uint32_t(store.flipFlags[first + i]) << 28);
+        }
+        break;
+    case Storage::GIDs:
+        std::copy(store.GIDs.begin() + first, store.GIDs.begin() + first + count, dest);
+        break;
+    case Storage::Palette:
+    {
+        const auto& entries = store.palette.getEntries();
+        for(auto i = 0u; i < count; ++i) {
+            const auto& tile = entries[store.palette.getIndex(first + i)];
+            dest[i] = tile.ID | (std::uint32_t(tile.flipFlags) << 28);
+        }
+    }
+        break;
+    case Storage::Sparse:
+        store.sparse.pack(first, count, dest);
+        break;
     }
+}
 
-    if (tileIds.empty()) {
-        Logger::log("Layer " + getName() + " has no layer data. Layer skipped.", Logger::Type::Error);
+void TileLayer::applySparseThreshold()
+{
+    if(m_storage != Storage::Sparse) {
         return;
-    } else {
-        createTiles(tileIds, m_tiles);
+    }
+
+    std::vector<TileStore> stores;
+    stores.push_back(getStore());
+    for(auto& chunk : m_chunks) {
+        stores.push_back(getStore(chunk));
+    }
+
+    std::size_t total = 0;
+    std::size_t used = 0;
+    for(const auto& store : stores) {
+        total += store.sparse.size();
+        used += store.sparse.getTiles().size();
+    }
+
+    if(total == 0 || double(used) >= double(total) * m_sparseThreshold) {
+        storeDense();
+        for(const auto& store : stores) {
+            store.palette.finish();
+        }
     }
 }
 
-void TileLayer::createTiles(const std::vector<std::uint32_t>& IDs, std::vector<Tile>& destination)
+void TileLayer::storeDense()
 {
-    //LOG(IDs.size() != m_tileCount, "Layer tile count does not match expected size. Found: "
-    //    + std::to_string(IDs.size()) + ", expected: " + std::to_string(m_tileCount));
-    
-    static const std::uint32_t mask = 0xf0000000;
-    for (const auto& id : IDs)
+    std::vector<TileStore> stores;
+    stores.push_back(getStore());
+    for(auto& chunk : m_chunks) {
+        stores.push_back(getStore(chunk));
+    }
+
+    setStorage(m_denseStorage, 0.f);
+    std::uint32_t GIDs[DecodeBlockSize];
+    for(const auto& store : stores) {
+        SparseTiles sparse;
+        std::swap(sparse, store.sparse);
+
+        const auto count = sparse.size();
+        reserveTiles(store, count);
+        for(std::size_t i = 0; i < count; i += DecodeBlockSize) {
+            const auto blockSize = std::min(count - i, DecodeBlockSize);
+            sparse.pack(i, blockSize, GIDs);
+            createTiles(GIDs, blockSize, store);
+        }
+    }
+}
+
+void TileLayer::reserveTiles(const TileStore& store, std::size_t count)
+{
+    switch(m_storage)
     {
-        destination.emplace_back();
-        destination.back().flipFlags = ((id & mask) >> 28);
-        destination.back().ID = id & ~mask;
+    case Storage::Tiles:
+        store.tiles.reserve(count);
+        break;
+    case Storage::Arrays:
+        store.tileIDs.reserve(count);
+        store.flipFlags.reserve(count);
+        break;
+    case Storage::GIDs:
+        store.GIDs.reserve(count);
+        break;
+    case Storage::Palette:
+        store.palette.reserve(count);
+        break;
+    case Storage::Sparse:
+        break;
+    }
+}
+
+//palette
+void TileLayer::Palette::reserve(std::size_t count)
+{
+    //the indices start as single bytes and are only widened
+    //once there are more distinct tiles than they can index
+    if(m_indexSize == 1) {
+        m_indices8.reserve(count);
+    }
+}
+
+void TileLayer::Palette::append(const std::uint32_t* GIDs, std::size_t count)
+{
+    static const std::uint32_t mask = detail::GIDFlagMask;
+
+    //neighbouring tiles are often the same, so the last
+    //GID is checked before looking up the palette
+    std::uint32_t indices[DecodeBlockSize];
+    std::uint32_t lastGID = 0;
+    std::uint32_t lastIndex = 0;
+    bool hasLast = false;
+    for(std::size_t start = 0; start < count; start += DecodeBlockSize) {
+        const auto blockSize = std::min(count - start, DecodeBlockSize);
+        for(auto i = 0u; i < blockSize; ++i) {
+            const auto GID = GIDs[start + i];
+            if(!hasLast || GID != lastGID) {
+                auto result = m_lookup.find(GID);
+                if(result == m_lookup.end()) {
+                    Tile tile;
+                    tile.ID = GID & ~mask;
+                    tile.flipFlags = ((GID & mask) >> 28);
+                    result = m_lookup.emplace(GID, static_cast<std::uint32_t>(m_entries.size())).first;
+                    m_entries.push_back(tile);
+                }
+                lastGID = GID;
+                lastIndex = result->second;
+                hasLast = true;
+            }
+            indices[i] = lastIndex;
+        }
+
+        //widen the existing indices if the new tiles no longer fit
+        if(m_indexSize == 1 && m_entries.size() > 0x100) {
+            m_indices16.reserve(m_indices8.capacity());
+            m_indices16.assign(m_indices8.begin(), m_indices8.end());
+            std::vector<std::uint8_t>().swap(m_indices8);
+            m_indexSize = 2;
+        }
+        if(m_indexSize == 2 && m_entries.size() > 0x10000) {
+            m_indices32.reserve(m_indices16.capacity());
+            m_indices32.assign(m_indices16.begin(), m_indices16.end());
+            std::vector<std::uint16_t>().swap(m_indices16);
+            m_indexSize = 4;
+        }
+
+        switch(m_indexSize)
+        {
+        case 1:
+            m_indices8.insert(m_indices8.end(), indices, indices + blockSize);
+            break;
+        case 2:
+            m_indices16.insert(m_indices16.end(), indices, indices + blockSize);
+            break;
+        default:
+            m_indices32.insert(m_indices32.end(), indices, indices + blockSize);
+            break;
+        }
+    }
+}
+
+void TileLayer::Palette::finish()
+{
+    std::unordered_map<std::uint32_t, std::uint32_t>().swap(m_lookup);
+    m_entries.shrink_to_fit();
+}
+
+void TileLayer::Palette::clear()
+{
+    m_entries.clear();
+    m_indices8.clear();
+    m_indices16.clear();
+    m_indices32.clear();
+    m_indexSize = 1;
+    m_lookup.clear();
+}
+
+//sparse tiles
+TileLayer::Tile TileLayer::SparseTiles::getTile(std::size_t position) const
+{
+    //the last run starting at or before the position
+    auto run = std::upper_bound(m_runs.begin(), m_runs.end(), position,
+        [](std::size_t p, const Run& r) { return p < r.start; });
+    if(run != m_runs.begin()) {
+        --run;
+        if(position - run->start < run->count) {
+            return m_tiles[run->first + (position - run->start)];
+        }
+    }
+    return {};
+}
+
+void TileLayer::SparseTiles::append(const std::uint32_t* GIDs, std::size_t count)
+{
+    static const std::uint32_t mask = detail::GIDFlagMask;
+    for(auto i = 0u; i < count; ++i, ++m_size) {
+        const auto GID = GIDs[i];
+        if(GID == 0) {
+            continue;
+        }
+
+        //continue the last run if it ends at the previous position
+        if(m_runs.empty() || m_runs.back().start + m_runs.back().count != m_size) {
+            Run run;
+            run.start = static_cast<std::uint32_t>(m_size);
+            run.first = static_cast<std::uint32_t>(m_tiles.size());
+            m_runs.push_back(run);
+        }
+        m_runs.back().count++;
+
+        Tile tile;
+        tile.ID = GID & ~mask;
+        tile.flipFlags = ((GID & mask) >> 28);
+        m_tiles.push_back(tile);
+    }
+}
+
+void TileLayer::SparseTiles::finish()
+{
+    m_runs.shrink_to_fit();
+    m_tiles.shrink_to_fit();
+}
+
+void TileLayer::SparseTiles::pack(std::size_t first, std::size_t count, std::uint32_t* dest) const
+{
+    std::fill(dest, dest + count, 0u);
+
+    const auto end = first + count;
+    auto run = std::upper_bound(m_runs.begin(), m_runs.end(), first,
+        [](std::size_t p, const Run& r) { return p < r.start; });
+    if(run != m_runs.begin()) {
+        --run;
+    }
+
+    for(; run != m_runs.end() && run->start < end; ++run) {
+        const auto begin = std::max<std::size_t>(run->start, first);
+        const auto last = std::min<std::size_t>(std::size_t(run->start) + run->count, end);
+        for(auto position = begin; position < last; ++position) {
+            const auto& tile = m_tiles[run->first + (position - run->start)];
+            dest[position - first] = tile.ID | (std::uint32_t(tile.flipFlags) << 28);
+        }
+    }
+}
+
+const TileLayer::Chunk* TileLayer::getChunk(int x, int y) const
+{
+    if(!isDecoded()) {
+        decodeAll();
+    }
+
+    if(m_chunkSize.x == 0) {
+        for(const auto& chunk : m_chunks) {
+            //widened, as the distance from a chunk can overflow an int
+            if(x >= chunk.position.x && std::int64_t(x) - chunk.position.x < chunk.size.x
+                && y >= chunk.position.y && std::int64_t(y) - chunk.position.y < chunk.size.y) {
+                return &chunk;
+            }
+        }
+        return nullptr;
+    }
+
+    const auto cellX = floorDiv(std::int64_t(x) - m_chunkOrigin.x, m_chunkSize.x) - m_chunkGridStart.x;
+    const auto cellY = floorDiv(std::int64_t(y) - m_chunkOrigin.y, m_chunkSize.y) - m_chunkGridStart.y;
+    if(!m_chunkGrid.empty()) {
+        if(cellX < 0 || cellY < 0 || cellX >= m_chunkGridSize.x || cellY >= m_chunkGridSize.y) {
+            return nullptr;
+        }
+        const auto index = m_chunkGrid[std::size_t(cellY) * m_chunkGridSize.x + std::size_t(cellX)];
+        return index < 0 ? nullptr : &m_chunks[index];
+    }
+
+    const auto result = m_chunkMap.find(cellKey(cellX, cellY));
+    return result == m_chunkMap.end() ? nullptr : &m_chunks[result->second];
+}
+
+TileLayer::Tile TileLayer::getTile(int x, int y) const
+{
+    if(!isDecoded()) {
+        decodeAll();
+    }
+
+    //the stored form is only read, so the stores are logically const
+    if(m_chunks.empty()) {
+        if(x < 0 || y < 0 || unsigned(x) >= m_size.x || unsigned(y) >= m_size.y) {
+            return {};
+        }
+        return getStoredTile(const_cast<TileLayer*>(this)->getStore(), std::size_t(y) * m_size.x + std::size_t(x));
+    }
+
+    const auto* chunk = getChunk(x, y);
+    if(chunk == nullptr) {
+        return {};
+    }
+    const auto index = std::size_t(y - chunk->position.y) * std::size_t(chunk->size.x) + std::size_t(x - chunk->position.x);
+    return getStoredTile(getStore(const_cast<Chunk&>(*chunk)), index);
+}
+
+TileLayer::Tile TileLayer::getStoredTile(const TileStore& store, std::size_t index) const
+{
+    if(index >= getStoredCount(store)) {
+        return {};
+    }
+
+    static const std::uint32_t mask = detail::GIDFlagMask;
+    Tile tile;
+    switch(m_storage)
+    {
+    case Storage::Tiles:
+        return store.tiles[index];
+    case Storage::Arrays:
+        tile.ID = store.tileIDs[index];
+        tile.flipFlags = store.flipFlags[index];
+        break;
+    case Storage::GIDs:
+        tile.ID = store.GIDs[index] & ~mask;
+        tile.flipFlags = ((store.GIDs[index] & mask) >> 28);
+        break;
+    case Storage::Palette:
+        return store.palette[index];
+    case Storage::Sparse:
+        return store.sparse.getTile(index);
+    }
+    return tile;
+}
+
+void TileLayer::buildChunkIndex()
+{
+    m_chunkSize = {};
+    m_chunkGrid.clear();
+    m_chunkMap.clear();
+    if(m_chunks.empty()) {
+        return;
+    }
+
+    //chunks saved by Tiled are all the same size, and placed
+    //at multiples of it, so can be found by their grid cell
+    const auto origin = m_chunks[0].position;
+    const auto size = m_chunks[0].size;
+    if(size.x <= 0 || size.y <= 0) {
+        return;
+    }
+
+    std::int64_t minX = 0, minY = 0, maxX = 0, maxY = 0;
+    for(const auto& chunk : m_chunks) {
+        const auto offsetX = std::int64_t(chunk.position.x) - origin.x;
+        const auto offsetY = std::int64_t(chunk.position.y) - origin.y;
+        if(chunk.size.x != size.x || chunk.size.y != size.y
+            || offsetX % size.x != 0 || offsetY % size.y != 0) {
+            return;
+        }
+        minX = std::min(minX, offsetX / size.x);
+        minY = std::min(minY, offsetY / size.y);
+        maxX = std::max(maxX, offsetX / size.x);
+        maxY = std::max(maxY, offsetY / size.y);
+    }
+
+    m_chunkOrigin = origin;
+    m_chunkSize = size;
+    m_chunkGridStart = { int(minX), int(minY) };
+
+    //a flat grid is used unless the chunks are spread far apart
+    const auto width = maxX - minX + 1;
+    const auto height = maxY - minY + 1;
+    if(width * height <= std::int64_t(m_chunks.size()) * 4 + 64) {
+        m_chunkGridSize = { int(width), int(height) };
+        m_chunkGrid.assign(std::size_t(width * height), -1);
+        for(auto i = 0u; i < m_chunks.size(); ++i) {
+            const auto cellX = (std::int64_t(m_chunks[i].position.x) - origin.x) / size.x - minX;
+            const auto cellY = (std::int64_t(m_chunks[i].position.y) - origin.y) / size.y - minY;
+            m_chunkGrid[std::size_t(cellY * width + cellX)] = std::int32_t(i);
+        }
+    } else {
+        m_chunkGridSize = {};
+        m_chunkMap.reserve(m_chunks.size());
+        for(auto i = 0u; i < m_chunks.size(); ++i) {
+            const auto cellX = (std::int64_t(m_chunks[i].position.x) - origin.x) / size.x - minX;
+            const auto cellY = (std::int64_t(m_chunks[i].position.y) - origin.y) / size.y - minY;
+            m_chunkMap[cellKey(cellX, cellY)] = std::uint32_t(i);
+        }
     }
 }
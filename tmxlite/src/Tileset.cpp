@@ -31,10 +31,16 @@ source distribution.
 #include "detail/cJSON.h"
 #endif
 #include <tmxlite/Tileset.hpp>
+#include <tmxlite/TilesetCache.hpp>
 #include <tmxlite/Map.hpp>
 #include <tmxlite/FreeFuncs.hpp>
 #include <tmxlite/detail/Log.hpp>
+#include "detail/JsonReader.hpp"
+#include "detail/Keys.hpp"
+#include "detail/MappedFile.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <ctype.h>
 
 using namespace tmx;
@@ -49,23 +55,24 @@ Tileset::Tileset(const std::string& workingDir)
     m_columnCount           (0),
     m_objectAlignment       (ObjectAlignment::Unspecified),
     m_transparencyColour    (0, 0, 0, 0),
-    m_hasTransparency       (false),
-    m_doc(nullptr)
+    m_hasTransparency       (false)
 {
 
 }
 
-Tileset::~Tileset()
-{
-    if(m_doc != nullptr){
-        cJSON_Delete(m_doc);
-        m_doc = nullptr;
-    }
-}
-
 bool Tileset::loadWithoutMap(const std::string& path)
 {
     std::string resolved_path = tmx::resolveFilePath(path, m_workingDir);
+    if (enableFileMapping)
+    {
+        detail::MappedFile file;
+        if (file.open(resolved_path))
+        {
+            m_workingDir = getFilePath(resolved_path);
+            return loadWithoutMapFromMemory(file.getData(), file.getSize());
+        }
+    }
+
     std::string contents;
     if (!readFileIntoString(resolved_path, &contents))
     {
@@ -79,31 +86,43 @@ bool Tileset::loadWithoutMap(const std::string& path)
 
 bool Tileset::loadWithoutMapFromString(const std::string& xmlStr)
 {
-    if(m_doc != nullptr){
-        cJSON_Delete(m_doc);
-        m_doc = nullptr;
-    }
-    m_doc = cJSON_Parse(xmlStr.c_str());
-    if (!m_doc)
+    return loadWithoutMapFromMemory(xmlStr.data(), xmlStr.size());
+}
+
+bool Tileset::loadWithoutMapFromMemory(const char* data, std::size_t size)
+{
+    cJSON* doc = cJSON_ParseWithLength(data, size);
+    if (!doc)
     {
         Logger::log("Failed to parse tileset XML", Logger::Type::Error);
         //Logger::log("Reason: " + std::string(result.description()), Logger::Type::Error);
         return false;
     }
+    m_shared.reset();
+
     cJSON *tilesetNode = nullptr;
-    for(cJSON *child = m_doc->child; child != nullptr; child = child->next) {
-        if(std::string(child->string) == "tileset") {
+    for(cJSON *child = doc->child; child != nullptr; child = child->next) {
+        const auto key = detail::classifyKey(child->string);
+        if(key == detail::Key::Tileset) {
             tilesetNode = child;
             break;
+        } else if(key == detail::Key::Type && child->valuestring != nullptr
+            && std::string(child->valuestring) == "tileset") {
+            //tile sets exported by Tiled are stored in the root object
+            tilesetNode = doc;
         }
     }
     if (!tilesetNode)
     {
         Logger::log("Failed opening tileset: no tileset node found", Logger::Type::Error);
+        cJSON_Delete(doc);
         return reset();
     }
 
-    return parse(*tilesetNode, nullptr);
+    //nothing refers to the document once parsing is complete
+    bool retval = parse(*tilesetNode, nullptr);
+    cJSON_Delete(doc);
+    return retval;
 }
 
 bool Tileset::parse(const cJSON& node, Map* map)
@@ -113,10 +132,10 @@ bool Tileset::parse(const cJSON& node, Map* map)
     if (map) {
         std::string sourcePath;
         for(cJSON *child = node.child; child != nullptr; child = child->next) {
-            std::string childname = child->string;
-            if(childname == "firstgid") {
+            const auto key = detail::classifyKey(child->string);
+            if(key == detail::Key::FirstGID) {
                 m_firstGID = int(child->valuedouble);
-            } else if(childname == "source") {
+            } else if(key == detail::Key::Source) {
                 sourcePath = child->valuestring;
             }
         }
@@ -127,125 +146,325 @@ bool Tileset::parse(const cJSON& node, Map* map)
         }
 
         if (!sourcePath.empty()) {
-            return loadWithoutMap(sourcePath);
+            return loadExternal(sourcePath, *map);
         }
     }
-    std::string transparentColor;
+    const cJSON* tilesNode = nullptr;
     for(cJSON *child = node.child; child != nullptr; child = child->next) {
-        std::string name = child->string;
-        if(name == "name") {
-            m_name = child->valuestring;
-            LOG("found tile set " + m_name, Logger::Type::Info);
-        } else if(name == "class") {
-            m_class = child->valuestring;
-        } else if(name == "tilewidth") {
-            m_tileSize.x = int(child->valuedouble);
-        } else if(name == "tileheight") {
-            m_tileSize.y = int(child->valuedouble);
-        } else if(name == "spacing") {
-            m_spacing = int(child->valuedouble);
-        } else if(name == "margin") {
-            m_margin = int(child->valuedouble);
-        } else if(name == "tilecount") {
-            m_tileCount = int(child->valuedouble);
-        } else if(name == "columns") {
-            m_columnCount = int(child->valuedouble);
-        } else if(name == "objectalignment") {
-            std::string objectAlignment = child->valuestring;
-            if (objectAlignment == "unspecified") {
-                m_objectAlignment = ObjectAlignment::Unspecified;
-            } else if (objectAlignment == "topleft") {
-                m_objectAlignment = ObjectAlignment::TopLeft;
-            } else if (objectAlignment == "top") {
-                m_objectAlignment = ObjectAlignment::Top;
-            } else if (objectAlignment == "topright") {
-                m_objectAlignment = ObjectAlignment::TopRight;
-            } else if (objectAlignment == "left") {
-                m_objectAlignment = ObjectAlignment::Left;
-            } else if (objectAlignment == "center") {
-                m_objectAlignment = ObjectAlignment::Center;
-            } else if (objectAlignment == "right") {
-                m_objectAlignment = ObjectAlignment::Right;
-            } else if (objectAlignment == "bottomleft") {
-                m_objectAlignment = ObjectAlignment::BottomLeft;
-            } else if (objectAlignment == "bottom") {
-                m_objectAlignment = ObjectAlignment::Bottom;
-            } else if (objectAlignment == "bottomright") {
-                m_objectAlignment = ObjectAlignment::BottomRight;
-            }
-        } else if(name == "image") {
-            m_imagePath = child->valuestring;
-        } else if (name == "tileoffset") {
-            parseOffsetNode(*child);
-        } else if (name == "properties") {
-            m_properties = Property::readProperties(*child);
-        } else if (name == "terraintypes") {
-            parseTerrainNode(*child);
-        } else if (name == "tiles") {
-            parseTileNode(*child, map);
-        } else if(name == "transparentcolor") {
-            transparentColor = child->valuestring;
-        } else if(name == "imagewidth") {
-            m_imageSize.x = int(child->valuedouble);
-        } else if(name == "imageheight") {
-            m_imageSize.y = int(child->valuedouble);
+        //tiles are parsed last as they depend on the tile size
+        const auto key = detail::classifyKey(child->string);
+        if(key == detail::Key::Tiles) {
+            tilesNode = child;
+        } else {
+            parseAttribute(key, *child);
+        }
+    }
+    return parseComplete(tilesNode, map);
+}
+
+bool Tileset::parse(tmx::detail::JsonReader& reader, Map* map)
+{
+    if (map) {
+        detail::JsonValue value;
+        if (reader.findValue("firstgid", value)) {
+            m_firstGID = int(value.get().valuedouble);
+        }
+
+        if (m_firstGID == 0) {
+            Logger::log("Invalid first GID in tileset. Tileset node skipped.", Logger::Type::Warning);
+            reader.skipValue();
+            return false;
+        }
+
+        if (reader.findValue("source", value) && value.get().valuestring != nullptr) {
+            std::string sourcePath = value.get().valuestring;
+            reader.skipValue();
+            return loadExternal(sourcePath, *map);
+        }
+    }
+
+    if (!reader.beginObject()) {
+        return reset();
+    }
+
+    detail::JsonValue tilesValue;
+    bool hasTiles = false;
+    while (reader.nextKey()) {
+        const auto key = detail::classifyKey(reader.getKey());
+        if (key == detail::Key::Tiles) {
+            hasTiles = reader.readValue(tilesValue, "tiles");
         } else {
-            LOG(std::string("Unsupported tileset attribute encountered: ") + child->string, tmx::Logger::Type::Warning);
+            detail::JsonValue value;
+            if (reader.readValue(value, reader.getKey().c_str())) {
+                parseAttribute(key, value.get());
+            }
         }
     }
+    if (reader.failed()) {
+        Logger::log("Failed to parse tile set " + detail::toStdString(m_name), Logger::Type::Error);
+        return reset();
+    }
+
+    return parseComplete(hasTiles ? &tilesValue.get() : nullptr, map);
+}
+
+std::uint32_t Tileset::getLastGID() const
+{
+    const auto& tileIndex = data().m_tileIndex;
+    assert(!tileIndex.empty());
+    return m_firstGID + static_cast<std::uint32_t>(tileIndex.size()) - 1;
+}
+
+Tileset::TileView Tileset::getTile(std::uint32_t id) const
+{
+    TileView view;
+    if (!hasTile(id))
+    {
+        return view;
+    }
     
+    //corrects the ID. Indices and IDs are different.
+    const auto& shared = data();
+    id -= m_firstGID;
+    view.m_tileset = &shared;
+    view.m_ID = id;
+
+    const auto index = shared.m_tileIndex[id];
+    view.m_tile = index ? &shared.m_tiles[index - 1] : nullptr;
+    return view;
+}
+
+Vector2u Tileset::TileView::getImagePosition() const
+{
+    if (m_tile)
+    {
+        return m_tile->imagePosition;
+    }
+
+    if (!m_tileset || m_tileset->m_columnCount == 0)
+    {
+        return {};
+    }
+    return m_tileset->getImagePosition(m_ID);
+}
+
+Vector2u Tileset::TileView::getImageSize() const
+{
+    if (m_tile)
+    {
+        return m_tile->imageSize;
+    }
+    return m_tileset ? m_tileset->m_tileSize : Vector2u();
+}
+
+const String& Tileset::TileView::getImagePath() const
+{
+    if (m_tile)
+    {
+        return m_tile->imagePath;
+    }
+
+    static const String empty;
+    return m_tileset ? m_tileset->m_imagePath : empty;
+}
+
+//private
+void Tileset::parseAttribute(detail::Key key, const cJSON& child)
+{
+    switch(key)
+    {
+    case detail::Key::Name:
+        m_name = child.valuestring;
+        LOG("found tile set " + detail::toStdString(m_name), Logger::Type::Info);
+        break;
+    case detail::Key::Class:
+        m_class = child.valuestring;
+        break;
+    case detail::Key::TileWidth:
+        m_tileSize.x = int(child.valuedouble);
+        break;
+    case detail::Key::TileHeight:
+        m_tileSize.y = int(child.valuedouble);
+        break;
+    case detail::Key::Spacing:
+        m_spacing = int(child.valuedouble);
+        break;
+    case detail::Key::Margin:
+        m_margin = int(child.valuedouble);
+        break;
+    case detail::Key::TileCount:
+        m_tileCount = int(child.valuedouble);
+        break;
+    case detail::Key::Columns:
+        m_columnCount = int(child.valuedouble);
+        break;
+    case detail::Key::ObjectAlignment:
+    {
+        std::string objectAlignment = child.valuestring;
+        if (objectAlignment == "unspecified") {
+            m_objectAlignment = ObjectAlignment::Unspecified;
+        } else if (objectAlignment == "topleft") {
+            m_objectAlignment = ObjectAlignment::TopLeft;
+        } else if (objectAlignment == "top") {
+            m_objectAlignment = ObjectAlignment::Top;
+        } else if (objectAlignment == "topright") {
+            m_objectAlignment = ObjectAlignment::TopRight;
+        } else if (objectAlignment == "left") {
+            m_objectAlignment = ObjectAlignment::Left;
+        } else if (objectAlignment == "center") {
+            m_objectAlignment = ObjectAlignment::Center;
+        } else if (objectAlignment == "right") {
+            m_objectAlignment = ObjectAlignment::Right;
+        } else if (objectAlignment == "bottomleft") {
+            m_objectAlignment = ObjectAlignment::BottomLeft;
+        } else if (objectAlignment == "bottom") {
+            m_objectAlignment = ObjectAlignment::Bottom;
+        } else if (objectAlignment == "bottomright") {
+            m_objectAlignment = ObjectAlignment::BottomRight;
+        }
+    }
+        break;
+    case detail::Key::Image:
+        m_imagePath = child.valuestring;
+        break;
+    case detail::Key::TileOffset:
+        parseOffsetNode(child);
+        break;
+    case detail::Key::Properties:
+        m_properties = Property::readProperties(child);
+        break;
+    case detail::Key::TerrainTypes:
+        parseTerrainNode(child);
+        break;
+    case detail::Key::TransparentColour:
+        m_transparencyColour = colourFromString(child.valuestring);
+        m_hasTransparency = true;
+        break;
+    case detail::Key::ImageWidth:
+        m_imageSize.x = int(child.valuedouble);
+        break;
+    case detail::Key::ImageHeight:
+        m_imageSize.y = int(child.valuedouble);
+        break;
+    case detail::Key::FirstGID:
+    case detail::Key::Source:
+    case detail::Key::Type:
+    case detail::Key::TiledVersion:
+    case detail::Key::Version:
+        //handled by parse(), or not used
+        break;
+    default:
+        LOG(std::string("Unsupported tileset attribute encountered: ") + child.string, tmx::Logger::Type::Warning);
+        break;
+    }
+}
+
+bool Tileset::parseComplete(const cJSON* tilesNode, Map* map)
+{
     if (m_tileSize.x == 0 || m_tileSize.y == 0) {
         Logger::log("Invalid tile size found in tile set node. Node will be skipped.", Logger::Type::Error);
         return reset();
     }
-    m_tileIndex.reserve(m_tileCount);
-    m_tiles.reserve(m_tileCount);
     
+    //tiles in an image collection have images of their own, in which
+    //case the tile set has no image and no columns
+    const bool isCollection = m_imagePath.empty() && m_columnCount == 0;
     if (m_imagePath.empty()) {
-        Logger::log("Tileset image node has missing source property, tile set not loaded", Logger::Type::Error);
-        return reset();
+        if (!isCollection) {
+            Logger::log("Tileset image node has missing source property, tile set not loaded", Logger::Type::Error);
+            return reset();
+        }
     } else {
         //TODO this currently doesn't cover embedded images
         //mostly because I can't figure out how to export them
         //from the Tiled editor... but also resource handling
         //should be handled by the renderer, not the parser.
-        m_imagePath = resolveFilePath(m_imagePath, m_workingDir);
-        if (!transparentColor.empty()) {
-            m_transparencyColour = colourFromString(transparentColor);
-            m_hasTransparency = true;
-        }
+        detail::assignString(m_imagePath, resolveFilePath(detail::toStdString(m_imagePath), m_workingDir));
     }
 
-    //if the tsx file does not declare every tile, we create the missing ones
-    if (m_tiles.size() != getTileCount()) {
-        for (std::uint32_t ID = 0; ID < getTileCount(); ID++) {
-            createMissingTile(ID);
+    if (tilesNode != nullptr) {
+        for(cJSON *tileNode = tilesNode->child; tileNode != nullptr; tileNode = tileNode->next) {
+            parseTileNode(*tileNode, map);
         }
     }
 
+    if (isCollection
+        && std::none_of(m_tiles.begin(), m_tiles.end(), [](const Tile& tile) { return !tile.imagePath.empty(); })) {
+        Logger::log("Tileset has no image and none of its tiles have one, tile set not loaded", Logger::Type::Error);
+        return reset();
+    }
+
+    //tiles which the file does not declare are not stored, but are
+    //still part of the tile set
+    if (m_tileIndex.size() < getTileCount()) {
+        m_tileIndex.resize(getTileCount(), 0);
+    }
+
     return true;
 }
 
-std::uint32_t Tileset::getLastGID() const
+bool Tileset::loadExternal(const std::string& path, Map& map)
 {
-    assert(!m_tileIndex.empty());
-    return m_firstGID + static_cast<std::uint32_t>(m_tileIndex.size()) - 1;
+    //the first GID is set by the map rather than the tile set file
+    const auto firstGID = m_firstGID;
+    bool loaded = false;
+
+    auto result = map.m_preloadedTilesets.find(path);
+    if (result != map.m_preloadedTilesets.end()) {
+        //animation frames weren't offset as the first
+        //GID wasn't known when the file was preloaded
+        loaded = result->second.loaded;
+        *this = std::move(result->second.tileset);
+        map.m_preloadedTilesets.erase(result);
+
+        if (loaded) {
+            if (m_shared) {
+                loaded = loadFile(path, map.m_tilesetCache, firstGID);
+            } else {
+                offsetFrames(firstGID);
+            }
+        }
+    } else {
+        auto start = std::chrono::steady_clock::now();
+        loaded = loadFile(path, map.m_tilesetCache, firstGID);
+        auto end = std::chrono::steady_clock::now();
+
+        Map::ExternalFile file;
+        file.path = path;
+        file.type = Map::ExternalFile::Type::Tileset;
+        file.loaded = loaded;
+        file.loadTime = std::chrono::duration<double, std::milli>(end - start).count();
+        map.m_externalFiles.push_back(file);
+    }
+
+    m_firstGID = loaded ? firstGID : 0;
+    return loaded;
 }
 
-const Tileset::Tile* Tileset::getTile(std::uint32_t id) const
+bool Tileset::loadFile(const std::string& path, TilesetCache* cache, std::uint32_t firstGID)
 {
-    if (!hasTile(id))
-    {
-        return nullptr;
+    if (cache) {
+        m_shared = cache->get(resolveFilePath(path, m_workingDir), firstGID);
+        return m_shared ? true : reset();
+    }
+
+    m_firstGID = 0;
+    if (!loadWithoutMap(path)) {
+        return false;
+    }
+    offsetFrames(firstGID);
+    return true;
+}
+
+void Tileset::offsetFrames(std::uint32_t firstGID)
+{
+    for (auto& tile : m_tiles) {
+        for (auto& frame : tile.animation.frames) {
+            frame.tileID += firstGID;
+        }
     }
-    
-    //corrects the ID. Indices and IDs are different.
-    id -= m_firstGID;
-    id = m_tileIndex[id];
-    return id ? &m_tiles[id - 1] : nullptr;
 }
 
-//private
 bool Tileset::reset()
 {
     m_firstGID = 0;
@@ -266,20 +485,17 @@ bool Tileset::reset()
     m_terrainTypes.clear();
     m_tileIndex.clear();
     m_tiles.clear();
-    if(m_doc) {
-        cJSON_Delete(m_doc);
-        m_doc = nullptr;
-    }
+    m_shared.reset();
     return false;
 }
 
 void Tileset::parseOffsetNode(const cJSON& node)
 {
     for(cJSON *offsetNode = node.child; offsetNode != nullptr; offsetNode = offsetNode->next) {
-        std::string nodeName = offsetNode->string;
-        if(nodeName == "x") {
+        const auto key = detail::classifyKey(offsetNode->string);
+        if(key == detail::Key::X) {
             m_tileOffset.x = int(offsetNode->valuedouble);
-        } else if(nodeName == "y") {
+        } else if(key == detail::Key::Y) {
             m_tileOffset.y = int(offsetNode->valuedouble);
         }
     }
@@ -289,18 +505,17 @@ void Tileset::parseTerrainNode(const cJSON& node)
 {
     for(cJSON* child = node.child; child != nullptr; child = child->next)
     {
-        std::string name = child->string;
-        if (name == "terrain")
+        if (detail::classifyKey(child->string) == detail::Key::Terrain)
         {
             m_terrainTypes.emplace_back();
             auto& terrain = m_terrainTypes.back();
             for(cJSON *terrainNode = child->child; terrainNode != nullptr; terrainNode = terrainNode->next) {
-                std::string tnodename = terrainNode->string;
-                if(tnodename == "name") {
+                const auto key = detail::classifyKey(terrainNode->string);
+                if(key == detail::Key::Name) {
                     terrain.name = terrainNode->valuestring;
-                } else if(tnodename == "tile") {
+                } else if(key == detail::Key::Tile) {
                     terrain.tileID = int(terrainNode->valuedouble);
-                } else if(tnodename == "properties") {
+                } else if(key == detail::Key::Properties) {
                     terrain.properties = Property::readProperties(*terrainNode);
                 }
             }
@@ -328,9 +543,9 @@ Tileset Tileset::readTileset(const cJSON& node, tmx::Map* map, bool &parseSucces
     return output;
 }
 
-std::vector<Tileset> Tileset::readTilesets(const cJSON& node, tmx::Map* map)
+Vector<Tileset> Tileset::readTilesets(const cJSON& node, tmx::Map* map)
 {
-    std::vector<Tileset> output;
+    Vector<Tileset> output;
     for(cJSON *child = node.child; child != nullptr; child = child->next) {
         bool parseSuccess = false;
         auto tileset = readTileset(*child, map, parseSuccess);
@@ -341,11 +556,27 @@ std::vector<Tileset> Tileset::readTilesets(const cJSON& node, tmx::Map* map)
     return output;
 }
 
+Vector<Tileset> Tileset::readTilesets(tmx::detail::JsonReader& reader, tmx::Map* map)
+{
+    Vector<Tileset> output;
+    if(!reader.beginArray()) {
+        return output;
+    }
+
+    while(reader.nextElement()) {
+        Tileset tileset(map->getWorkingDirectory());
+        if(tileset.parse(reader, map)) {
+            output.push_back(std::move(tileset));
+        }
+    }
+    return output;
+}
+
 void Tileset::parseTileNode(const cJSON& node, Map* map)
 {
     uint32_t tileId = 0;
     for(cJSON *tileNode = node.child; tileNode != nullptr; tileNode = tileNode->next) {
-        if(std::string(tileNode->string) == "id") {
+        if(detail::classifyKey(tileNode->string) == detail::Key::ID) {
             tileId = int(tileNode->valuedouble);
         }
     }
@@ -356,8 +587,12 @@ void Tileset::parseTileNode(const cJSON& node, Map* map)
     tile.imageSize = m_tileSize;
     tile.probability = 100;
     for(cJSON *tileNode = node.child; tileNode != nullptr; tileNode = tileNode->next) {
-        std::string name = tileNode->string;
-        if(name == "terrain") {
+        switch(detail::classifyKey(tileNode->string))
+        {
+        case detail::Key::ID:
+            break;
+        case detail::Key::Terrain:
+        {
             std::string data = tileNode->valuestring;
             bool lastWasChar = true;
             std::size_t idx = 0u;
@@ -377,65 +612,64 @@ void Tileset::parseTileNode(const cJSON& node, Map* map)
             if (lastWasChar) {
                 tile.terrainIndices[idx] = -1;
             }
-        } else if(name == "probability") {
+        }
+            break;
+        case detail::Key::Probability:
             tile.probability = int(tileNode->valuedouble);
-        } else if(name == "type" || name == "class") {
+            break;
+        case detail::Key::Type:
+        case detail::Key::Class:
             tile.className = tileNode->valuestring;
-        } else if(name == "properties") {
+            break;
+        case detail::Key::Properties:
             tile.properties = Property::readProperties(*tileNode);
-        } else if (name == "objectgroup") {
+            break;
+        case detail::Key::ObjectGroup:
             tile.objectGroup.parse(*tileNode, map);
-        } else if (name == "image") {
+            break;
+        case detail::Key::Image:
             if (tileNode->valuestring == nullptr) {
                 Logger::log("Tile image path missing", Logger::Type::Warning);
                 continue;
             }
-            tile.imagePath = resolveFilePath(tileNode->valuestring, m_workingDir);
-        } else if (name == "imagewidth") {
+            detail::assignString(tile.imagePath, resolveFilePath(tileNode->valuestring, m_workingDir));
+            break;
+        case detail::Key::ImageWidth:
             tile.imageSize.x = (unsigned int)tileNode->valuedouble;
-        } else if (name == "imageheight") {
+            break;
+        case detail::Key::ImageHeight:
             tile.imageSize.y = (unsigned int)tileNode->valuedouble;
-        } else if (name == "animation") {
-            for(cJSON *animNode = node.child; animNode != nullptr; animNode = animNode->next) {
+            break;
+        case detail::Key::Animation:
+            for(cJSON *animNode = tileNode->child; animNode != nullptr; animNode = animNode->next) {
                 Tile::Animation::Frame frame;
                 for(cJSON* frameNode = animNode->child; frameNode != nullptr; frameNode = frameNode->next) {
-                    std::string fnodename = frameNode->string;
-                    if(fnodename == "duration") {
+                    const auto key = detail::classifyKey(frameNode->string);
+                    if(key == detail::Key::Duration) {
                         frame.duration = int(frameNode->valuedouble);
-                    } else if(fnodename == "tileid") {
-                        frame.tileID = int(frameNode->valueint) + m_firstGID;
+                    } else if(key == detail::Key::TileID) {
+                        frame.tileID = std::uint32_t(frameNode->valuedouble) + m_firstGID;
                     }
                 }
                 tile.animation.frames.push_back(frame);
             }
-        } else {
-            LOG("Tileset: could not parse node " + name, tmx::Logger::Type::Warning);
+            break;
+        default:
+            LOG(std::string("Tileset: could not parse node ") + tileNode->string, tmx::Logger::Type::Warning);
+            break;
         }
     }
     
     if (m_columnCount != 0) 
     {
-        std::uint32_t rowIndex = tile.ID % m_columnCount;
-        std::uint32_t columnIndex = tile.ID / m_columnCount;
-        tile.imagePosition.x = m_margin + rowIndex * (m_tileSize.x + m_spacing);
-        tile.imagePosition.y = m_margin + columnIndex * (m_tileSize.y + m_spacing);
+        tile.imagePosition = getImagePosition(tile.ID);
     }
 }
 
-void Tileset::createMissingTile(std::uint32_t ID)
+Vector2u Tileset::getImagePosition(std::uint32_t ID) const
 {
-    //first, we check if the tile does not yet exist
-    if (m_tileIndex.size() > ID && m_tileIndex[ID])
-    {
-        return;
-    }
-
-    Tile& tile = newTile(ID);
-    tile.imagePath = m_imagePath;
-    tile.imageSize = m_tileSize;
-
     std::uint32_t rowIndex = ID % m_columnCount;
     std::uint32_t columnIndex = ID / m_columnCount;
-    tile.imagePosition.x = m_margin + rowIndex * (m_tileSize.x + m_spacing);
-    tile.imagePosition.y = m_margin + columnIndex * (m_tileSize.y + m_spacing);
+    return Vector2u(m_margin + rowIndex * (m_tileSize.x + m_spacing),
+        m_margin + columnIndex * (m_tileSize.y + m_spacing));
 }
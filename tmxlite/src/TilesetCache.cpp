@@ -0,0 +1,132 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#include <tmxlite/TilesetCache.hpp>
+#include <tmxlite/Tileset.hpp>
+#include <tmxlite/detail/Arena.hpp>
+
+#include <algorithm>
+
+using namespace tmx;
+
+std::shared_ptr<const Tileset> TilesetCache::get(const std::string& path, std::uint32_t firstGID)
+{
+    std::shared_ptr<const Tileset> tileset;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto result = m_entries.find(path);
+        if (result != m_entries.end())
+        {
+            tileset = result->second.tileset;
+        }
+    }
+
+    //cached tile sets outlive any single map, so
+    //are never allocated from a map's arena
+    detail::Arena::Scope heapScope;
+
+    if (!tileset)
+    {
+        //loaded without holding the lock so that other files can be
+        //loaded at the same time. If the same file is loaded by two
+        //threads at once the first one to finish is kept.
+        auto loaded = std::make_shared<Tileset>();
+        if (!loaded->loadWithoutMap(path))
+        {
+            return nullptr;
+        }
+
+        const auto& tiles = loaded->getTiles();
+        bool animated = std::any_of(tiles.begin(), tiles.end(),
+            [](const Tileset::Tile& tile) { return !tile.animation.frames.empty(); });
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& entry = m_entries[path];
+        if (!entry.tileset)
+        {
+            entry.tileset = std::move(loaded);
+            entry.animated = animated;
+        }
+        tileset = entry.tileset;
+    }
+
+    if (firstGID == 0)
+    {
+        return tileset;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto result = m_entries.find(path);
+    if (result == m_entries.end() || !result->second.animated)
+    {
+        return tileset;
+    }
+
+    auto& offsetTileset = result->second.offsetTilesets[firstGID];
+    if (!offsetTileset)
+    {
+        auto copy = std::make_shared<Tileset>(*result->second.tileset);
+        copy->offsetFrames(firstGID);
+        offsetTileset = std::move(copy);
+    }
+    return offsetTileset;
+}
+
+std::size_t TilesetCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+std::size_t TilesetCache::removeUnused()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::size_t count = 0;
+    for (auto entry = m_entries.begin(); entry != m_entries.end();)
+    {
+        auto& offsetTilesets = entry->second.offsetTilesets;
+        for (auto offset = offsetTilesets.begin(); offset != offsetTilesets.end();)
+        {
+            offset = (offset->second.use_count() == 1) ? offsetTilesets.erase(offset) : std::next(offset);
+        }
+
+        if (offsetTilesets.empty() && entry->second.tileset.use_count() == 1)
+        {
+            entry = m_entries.erase(entry);
+            count++;
+        }
+        else
+        {
+            ++entry;
+        }
+    }
+    return count;
+}
+
+void TilesetCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
@@ -0,0 +1,120 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#include <tmxlite/UVTable.hpp>
+#include <tmxlite/Tileset.hpp>
+#include <tmxlite/TileLayer.hpp>
+
+#include <utility>
+
+using namespace tmx;
+
+constexpr std::size_t UVTable::QuadSize;
+constexpr std::size_t UVTable::VariantCount;
+
+UVTable::UVTable(const Tileset& tileset)
+{
+    build(tileset);
+}
+
+//public
+void UVTable::build(const Tileset& tileset)
+{
+    clear();
+
+    const auto& data = tileset.data();
+    m_tileCount = data.m_tileIndex.size();
+    m_uvs.resize(m_tileCount * VariantCount * QuadSize);
+
+    //corners of the quad on screen, in the order they are stored
+    static const std::uint8_t corners[4][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+
+    auto* output = m_uvs.data();
+    for (auto i = 0u; i < m_tileCount; ++i)
+    {
+        const auto tile = tileset.getTile(tileset.getFirstGID() + i);
+        const auto position = tile.getImagePosition();
+        const auto size = tile.getImageSize();
+
+        auto textureSize = data.m_imageSize;
+        if (tile.getData() && tile.getData()->imagePath != data.m_imagePath)
+        {
+            textureSize = size;
+        }
+
+        if (textureSize.x == 0 || textureSize.y == 0)
+        {
+            output += VariantCount * QuadSize;
+            continue;
+        }
+
+        const float u[2] =
+        {
+            static_cast<float>(position.x) / textureSize.x,
+            static_cast<float>(position.x + size.x) / textureSize.x
+        };
+        const float v[2] =
+        {
+            static_cast<float>(position.y) / textureSize.y,
+            static_cast<float>(position.y + size.y) / textureSize.y
+        };
+
+        //Tiled applies the diagonal flip first, then the horizontal
+        //and vertical flips, so the corner of the image shown at each
+        //corner of the quad is found by undoing them in reverse
+        for (auto variant = 0u; variant < VariantCount; ++variant)
+        {
+            const auto flags = static_cast<std::uint8_t>(variant << 1);
+            for (const auto& corner : corners)
+            {
+                auto x = corner[0];
+                auto y = corner[1];
+                if (flags & TileLayer::FlipFlag::Vertical)
+                {
+                    y ^= 1;
+                }
+
+                if (flags & TileLayer::FlipFlag::Horizontal)
+                {
+                    x ^= 1;
+                }
+
+                if (flags & TileLayer::FlipFlag::Diagonal)
+                {
+                    std::swap(x, y);
+                }
+
+                *output++ = u[x];
+                *output++ = v[y];
+            }
+        }
+    }
+}
+
+void UVTable::clear()
+{
+    m_uvs.clear();
+    m_tileCount = 0;
+}
@@ -0,0 +1,97 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#if defined USE_ZSTD || defined USE_EXTLIBS
+#include <zstd.h>
+#endif
+
+#include <tmxlite/ZstdDictionary.hpp>
+#include <tmxlite/FreeFuncs.hpp>
+#include <tmxlite/detail/Log.hpp>
+
+using namespace tmx;
+
+ZstdDictionary::ZstdDictionary()
+    : m_dictionary(nullptr)
+{
+
+}
+
+ZstdDictionary::~ZstdDictionary()
+{
+    release();
+}
+
+//public
+bool ZstdDictionary::loadFromFile(const std::string& path)
+{
+    std::string contents;
+    if (!readFileIntoString(path, &contents))
+    {
+        Logger::log("Failed to open zstd dictionary " + path, Logger::Type::Error);
+        release();
+        return false;
+    }
+    return loadFromMemory(contents.data(), contents.size());
+}
+
+bool ZstdDictionary::loadFromMemory(const void* data, std::size_t size)
+{
+    release();
+
+#if defined USE_ZSTD || defined USE_EXTLIBS
+    m_dictionary = ZSTD_createDDict(data, size);
+    if (m_dictionary == nullptr)
+    {
+        Logger::log("Failed to create zstd dictionary", Logger::Type::Error);
+        return false;
+    }
+    return true;
+#else
+    (void)data;
+    (void)size;
+    Logger::log("Library must be built with USE_EXTLIBS or USE_ZSTD for Zstd compression", Logger::Type::Error);
+    return false;
+#endif
+}
+
+std::uint32_t ZstdDictionary::getID() const
+{
+#if defined USE_ZSTD || defined USE_EXTLIBS
+    if (m_dictionary != nullptr)
+    {
+        return ZSTD_getDictID_fromDDict(m_dictionary);
+    }
+#endif
+    return 0;
+}
+
+//private
+void ZstdDictionary::release()
+{
+#if defined USE_ZSTD || defined USE_EXTLIBS
+    ZSTD_freeDDict(m_dictionary);
+#endif
+    m_dictionary = nullptr;
+}
@@ -0,0 +1,177 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#include <tmxlite/detail/Arena.hpp>
+
+#ifdef TMXLITE_USE_ARENA
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+using namespace tmx::detail;
+
+namespace
+{
+    //each allocation is preceded by a header recording whether it
+    //came from an arena, so that it can be freed from any thread
+    constexpr std::size_t HeaderSize = alignof(std::max_align_t) > sizeof(void*) ? alignof(std::max_align_t) : sizeof(void*);
+    constexpr std::size_t MinBlockSize = 64 * 1024;
+    constexpr std::size_t MaxBlockSize = 4 * 1024 * 1024;
+
+    //larger allocations, such as the storage of big vectors, are taken from
+    //the heap so that the space is reclaimed when they grow
+    constexpr std::size_t MaxArenaAllocation = 4 * 1024;
+
+    thread_local Arena* currentArena = nullptr;
+
+    std::size_t alignSize(std::size_t size)
+    {
+        return (size + HeaderSize - 1) & ~(HeaderSize - 1);
+    }
+}
+
+struct Arena::Block final
+{
+    Block* next = nullptr;
+    std::size_t size = 0;
+    std::size_t used = 0;
+
+    char* data() { return reinterpret_cast<char*>(this) + alignSize(sizeof(Block)); }
+};
+
+Arena::Arena()
+    : m_head(nullptr)
+{
+
+}
+
+Arena::~Arena()
+{
+    release();
+}
+
+Arena::Arena(Arena&& other) noexcept
+    : m_head(other.m_head)
+{
+    other.m_head = nullptr;
+}
+
+Arena& Arena::operator = (Arena&& other) noexcept
+{
+    std::swap(m_head, other.m_head);
+    return *this;
+}
+
+void* Arena::allocate(std::size_t size)
+{
+    size = alignSize(size);
+
+    if (m_head == nullptr || m_head->size - m_head->used < size)
+    {
+        const std::size_t blockSize = std::max(size, m_head ? std::min(m_head->size * 2, MaxBlockSize) : MinBlockSize);
+
+        auto* block = new (::operator new(alignSize(sizeof(Block)) + blockSize)) Block();
+        block->size = blockSize;
+        block->next = m_head;
+        m_head = block;
+    }
+
+    void* ptr = m_head->data() + m_head->used;
+    m_head->used += size;
+    return ptr;
+}
+
+void Arena::release()
+{
+    while (m_head != nullptr)
+    {
+        auto* next = m_head->next;
+        m_head->~Block();
+        ::operator delete(m_head);
+        m_head = next;
+    }
+}
+
+std::size_t Arena::getCapacity() const
+{
+    std::size_t capacity = 0;
+    for (auto* block = m_head; block != nullptr; block = block->next)
+    {
+        capacity += block->size;
+    }
+    return capacity;
+}
+
+Arena::Scope::Scope()
+    : m_previous(currentArena)
+{
+    currentArena = nullptr;
+}
+
+Arena::Scope::Scope(Arena& arena)
+    : m_previous(currentArena)
+{
+    currentArena = &arena;
+}
+
+Arena::Scope::~Scope()
+{
+    currentArena = m_previous;
+}
+
+void* tmx::detail::arenaAllocate(std::size_t size)
+{
+    char* memory = nullptr;
+    Arena* arena = (size <= MaxArenaAllocation) ? currentArena : nullptr;
+    if (arena != nullptr)
+    {
+        memory = static_cast<char*>(arena->allocate(HeaderSize + size));
+    }
+    else
+    {
+        memory = static_cast<char*>(::operator new(HeaderSize + size));
+    }
+    *reinterpret_cast<Arena**>(memory) = arena;
+    return memory + HeaderSize;
+}
+
+void tmx::detail::arenaDeallocate(void* ptr) noexcept
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+
+    char* memory = static_cast<char*>(ptr) - HeaderSize;
+    if (*reinterpret_cast<Arena**>(memory) == nullptr)
+    {
+        ::operator delete(memory);
+    }
+    //arena memory is reclaimed when the arena is released
+}
+
+#endif //TMXLITE_USE_ARENA
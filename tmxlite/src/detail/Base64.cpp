@@ -0,0 +1,256 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#include "Base64.hpp"
+#include "Simd.hpp"
+
+#include <cstdint>
+
+using namespace tmx::detail;
+
+namespace
+{
+    constexpr std::uint8_t Invalid = 0xff;
+
+    struct DecodeTable final
+    {
+        std::uint8_t values[256];
+
+        DecodeTable()
+            : values()
+        {
+            for (auto& v : values)
+            {
+                v = Invalid;
+            }
+
+            const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            for (std::uint8_t i = 0; i < 64; ++i)
+            {
+                values[static_cast<unsigned char>(alphabet[i])] = i;
+            }
+        }
+    };
+
+    const DecodeTable decodeTable;
+
+    std::size_t decodeScalar(const unsigned char* source, std::size_t length, unsigned char* dest)
+    {
+        const auto* table = decodeTable.values;
+        auto* out = dest;
+        std::size_t i = 0;
+
+        //whole blocks of four characters
+        while (i + 4 <= length)
+        {
+            const std::uint8_t a = table[source[i]];
+            const std::uint8_t b = table[source[i + 1]];
+            const std::uint8_t c = table[source[i + 2]];
+            const std::uint8_t d = table[source[i + 3]];
+            if ((a | b | c | d) == Invalid)
+            {
+                break;
+            }
+
+            const std::uint32_t value = (a << 18) | (b << 12) | (c << 6) | d;
+            out[0] = static_cast<unsigned char>(value >> 16);
+            out[1] = static_cast<unsigned char>(value >> 8);
+            out[2] = static_cast<unsigned char>(value);
+            out += 3;
+            i += 4;
+        }
+
+        //up to three remaining characters before the end or a terminator
+        std::uint32_t value = 0;
+        std::size_t count = 0;
+        while (i < length && count < 4 && table[source[i]] != Invalid)
+        {
+            value = (value << 6) | table[source[i++]];
+            count++;
+        }
+
+        if (count > 1)
+        {
+            value <<= 6 * (4 - count);
+            *out++ = static_cast<unsigned char>(value >> 16);
+            if (count > 2)
+            {
+                *out++ = static_cast<unsigned char>(value >> 8);
+            }
+        }
+
+        return static_cast<std::size_t>(out - dest);
+    }
+
+#ifdef TMXLITE_SIMD_X86
+    //The vector kernels translate and validate the characters with nibble
+    //lookups, then pack each group of four 6 bit values into three bytes.
+    //A block containing any character outside the alphabet is left to the
+    //scalar decoder, which stops at the first one as before.
+
+    //reads 16 characters and writes 16 bytes, 12 of which are valid
+    TMXLITE_TARGET("sse4.1")
+    bool decodeBlockSSE(const unsigned char* source, unsigned char* dest)
+    {
+        const __m128i lutLo = _mm_setr_epi8(
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+            0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+        const __m128i lutHi = _mm_setr_epi8(
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m128i lutRoll = _mm_setr_epi8(
+            0, 16, 19, 4, -65, -65, -71, -71,
+            0, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i mask2F = _mm_set1_epi8(0x2f);
+
+        __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+        const __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(input, 4), mask2F);
+        const __m128i loNibbles = _mm_and_si128(input, mask2F);
+        const __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+        const __m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+        if (!_mm_testz_si128(lo, hi))
+        {
+            return false;
+        }
+
+        const __m128i eq2F = _mm_cmpeq_epi8(input, mask2F);
+        const __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles));
+        input = _mm_add_epi8(input, roll);
+
+        const __m128i merged = _mm_maddubs_epi16(input, _mm_set1_epi32(0x01400140));
+        __m128i output = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        output = _mm_shuffle_epi8(output, _mm_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), output);
+        return true;
+    }
+
+    TMXLITE_TARGET("sse4.1")
+    std::size_t decodeSSE(const unsigned char* source, std::size_t length, unsigned char* dest)
+    {
+        std::size_t read = 0;
+        std::size_t written = 0;
+
+        //the store writes four bytes past the decoded block, so keep
+        //enough input in reserve that they stay within the buffer
+        while (length - read >= 24
+            && decodeBlockSSE(source + read, dest + written))
+        {
+            read += 16;
+            written += 12;
+        }
+        return written + decodeScalar(source + read, length - read, dest + written);
+    }
+
+    //reads 32 characters and writes 32 bytes, 24 of which are valid
+    TMXLITE_TARGET("avx2")
+    bool decodeBlockAVX2(const unsigned char* source, unsigned char* dest)
+    {
+        const __m256i lutLo = _mm256_setr_epi8(
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+            0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+            0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+        const __m256i lutHi = _mm256_setr_epi8(
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m256i lutRoll = _mm256_setr_epi8(
+            0, 16, 19, 4, -65, -65, -71, -71,
+            0, 0, 0, 0, 0, 0, 0, 0,
+            0, 16, 19, 4, -65, -65, -71, -71,
+            0, 0, 0, 0, 0, 0, 0, 0);
+        const __m256i mask2F = _mm256_set1_epi8(0x2f);
+
+        __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source));
+        const __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(input, 4), mask2F);
+        const __m256i loNibbles = _mm256_and_si256(input, mask2F);
+        const __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+        const __m256i lo = _mm256_shuffle_epi8(lutLo, loNibbles);
+        if (!_mm256_testz_si256(lo, hi))
+        {
+            return false;
+        }
+
+        const __m256i eq2F = _mm256_cmpeq_epi8(input, mask2F);
+        const __m256i roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(eq2F, hiNibbles));
+        input = _mm256_add_epi8(input, roll);
+
+        const __m256i merged = _mm256_maddubs_epi16(input, _mm256_set1_epi32(0x01400140));
+        __m256i output = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+        output = _mm256_shuffle_epi8(output, _mm256_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        output = _mm256_permutevar8x32_epi32(output, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest), output);
+        return true;
+    }
+
+    TMXLITE_TARGET("avx2")
+    std::size_t decodeAVX2(const unsigned char* source, std::size_t length, unsigned char* dest)
+    {
+        std::size_t read = 0;
+        std::size_t written = 0;
+
+        //as above, the store writes eight bytes past the decoded block
+        while (length - read >= 44
+            && decodeBlockAVX2(source + read, dest + written))
+        {
+            read += 32;
+            written += 24;
+        }
+        return written + decodeSSE(source + read, length - read, dest + written);
+    }
+#endif //TMXLITE_SIMD_X86
+
+    using DecodeFunc = std::size_t(*)(const unsigned char*, std::size_t, unsigned char*);
+
+    DecodeFunc selectDecoder()
+    {
+#ifdef TMXLITE_SIMD_X86
+        if (cpuSupports(CpuFeature::AVX2))
+        {
+            return decodeAVX2;
+        }
+
+        if (cpuSupports(CpuFeature::SSE41))
+        {
+            return decodeSSE;
+        }
+#endif
+        return decodeScalar;
+    }
+}
+
+std::size_t tmx::detail::base64Decode(const char* source, std::size_t length, unsigned char* dest)
+{
+    static const DecodeFunc decoder = selectDecoder();
+    return decoder(reinterpret_cast<const unsigned char*>(source), length, dest);
+}
+
+std::size_t tmx::detail::base64DecodeScalar(const char* source, std::size_t length, unsigned char* dest)
+{
+    return decodeScalar(reinterpret_cast<const unsigned char*>(source), length, dest);
+}
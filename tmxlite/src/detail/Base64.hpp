@@ -0,0 +1,59 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#include <cstddef>
+
+namespace tmx
+{
+    namespace detail
+    {
+        /*!
+        \brief Returns the number of bytes which must be available in the
+        destination buffer when decoding the given number of base64
+        characters with base64Decode().
+        */
+        inline std::size_t base64DecodedSize(std::size_t length)
+        {
+            return ((length + 3) / 4) * 3;
+        }
+
+        /*!
+        \brief Decodes base64 text into the given buffer, which must have
+        space for at least base64DecodedSize(length) bytes.
+        Decoding stops at the first padding or other non base64 character.
+        Blocks of input are decoded with SSE4.1 or AVX2 where the CPU
+        supports them, with the same results as the scalar decoder.
+        \returns The number of bytes written to dest
+        */
+        std::size_t base64Decode(const char* source, std::size_t length, unsigned char* dest);
+
+        /*!
+        \brief Decodes base64 text as base64Decode() does, but always with
+        the scalar decoder. Used to check the vector decoders against.
+        */
+        std::size_t base64DecodeScalar(const char* source, std::size_t length, unsigned char* dest);
+    }
+}
@@ -0,0 +1,1394 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#include "CompiledMap.hpp"
+
+#include <tmxlite/Map.hpp>
+#include <tmxlite/ImageLayer.hpp>
+#include <tmxlite/LayerGroup.hpp>
+#include <tmxlite/ObjectGroup.hpp>
+#include <tmxlite/Tileset.hpp>
+#include <tmxlite/detail/Log.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace tmx;
+using namespace tmx::detail;
+
+namespace
+{
+    const char Magic[8] = { 'T', 'M', 'X', 'L', 'B', 'I', 'N', '\0' };
+    constexpr std::uint32_t FormatVersion = 1;
+    constexpr std::uint32_t ByteOrderMark = 0x01020304;
+    constexpr std::uint32_t NoIndex = 0xffffffff;
+    constexpr std::size_t SectionAlignment = 8;
+
+    std::uint32_t packColour(const Colour& colour)
+    {
+        return std::uint32_t(colour.r) | (std::uint32_t(colour.g) << 8)
+            | (std::uint32_t(colour.b) << 16) | (std::uint32_t(colour.a) << 24);
+    }
+
+    Colour unpackColour(std::uint32_t value)
+    {
+        return Colour(value & 0xff, (value >> 8) & 0xff, (value >> 16) & 0xff, (value >> 24) & 0xff);
+    }
+}
+
+//all records are made only of 32 bit fields so that they contain no padding
+struct CompiledMap::Header final
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint64_t sectionOffsets[SectionCount];
+    std::uint64_t sectionCounts[SectionCount];
+};
+
+struct CompiledMap::Range final
+{
+    std::uint32_t first = 0;
+    std::uint32_t count = 0;
+};
+
+struct CompiledMap::StringRecord final
+{
+    std::uint32_t offset = 0;
+    std::uint32_t length = 0;
+};
+
+struct CompiledMap::MapRecord final
+{
+    std::uint32_t versionUpper = 0;
+    std::uint32_t versionLower = 0;
+    std::uint32_t className = 0;
+    std::uint32_t orientation = 0;
+    std::uint32_t renderOrder = 0;
+    std::uint32_t infinite = 0;
+    std::uint32_t tileCountX = 0;
+    std::uint32_t tileCountY = 0;
+    std::uint32_t tileSizeX = 0;
+    std::uint32_t tileSizeY = 0;
+    float hexSideLength = 0.f;
+    std::uint32_t staggerAxis = 0;
+    std::uint32_t staggerIndex = 0;
+    float parallaxOriginX = 0.f;
+    float parallaxOriginY = 0.f;
+    std::uint32_t backgroundColour = 0;
+    Range tilesets;
+    Range layers;
+    Range properties;
+    Range templateObjects;
+    Range templateTilesets;
+};
+
+struct CompiledMap::LayerRecord final
+{
+    std::uint32_t type = 0;
+    std::int32_t id = 0;
+    std::uint32_t name = 0;
+    std::uint32_t className = 0;
+    float opacity = 1.f;
+    std::uint32_t visible = 0;
+    std::int32_t offsetX = 0;
+    std::int32_t offsetY = 0;
+    std::int32_t startX = 0;
+    std::int32_t startY = 0;
+    float parallaxX = 0.f;
+    float parallaxY = 0.f;
+    std::uint32_t tintColour = 0;
+    std::uint32_t sizeX = 0;
+    std::uint32_t sizeY = 0;
+    Range properties;
+
+    //tile layers
+    std::uint32_t encoding = 0;
+    std::uint32_t compression = 0;
+    std::uint32_t tileSizeX = 0;
+    std::uint32_t tileSizeY = 0;
+    std::uint32_t tileCount = 0;
+    Range GIDs;
+    Range chunks;
+
+    //object groups
+    std::uint32_t colour = 0;
+    std::uint32_t drawOrder = 0;
+    Range objects;
+
+    //image layers
+    std::uint32_t imagePath = 0;
+    std::uint32_t workingDir = 0;
+    std::uint32_t transparencyColour = 0;
+    std::uint32_t hasTransparency = 0;
+    std::uint32_t imageSizeX = 0;
+    std::uint32_t imageSizeY = 0;
+    std::uint32_t repeatX = 0;
+    std::uint32_t repeatY = 0;
+
+    //layer groups
+    Range layers;
+};
+
+struct CompiledMap::ChunkRecord final
+{
+    std::int32_t positionX = 0;
+    std::int32_t positionY = 0;
+    std::int32_t sizeX = 0;
+    std::int32_t sizeY = 0;
+    Range GIDs;
+};
+
+struct CompiledMap::ObjectRecord final
+{
+    std::uint32_t UID = 0;
+    std::uint32_t name = 0;
+    std::uint32_t className = 0;
+    std::uint32_t templatePath = 0;
+    float positionX = 0.f;
+    float positionY = 0.f;
+    float left = 0.f;
+    float top = 0.f;
+    float width = 0.f;
+    float height = 0.f;
+    float rotation = 0.f;
+    std::uint32_t tileID = 0;
+    std::uint32_t flipFlags = 0;
+    std::uint32_t visible = 0;
+    std::uint32_t shape = 0;
+    Range points;
+    Range properties;
+    std::uint32_t fontFamily = 0;
+    std::uint32_t pixelSize = 0;
+    std::uint32_t wrap = 0;
+    std::uint32_t textColour = 0;
+    std::uint32_t bold = 0;
+    std::uint32_t italic = 0;
+    std::uint32_t underline = 0;
+    std::uint32_t strikethrough = 0;
+    std::uint32_t kerning = 0;
+    std::uint32_t hAlign = 0;
+    std::uint32_t vAlign = 0;
+    std::uint32_t content = 0;
+    std::uint32_t tilesetName = 0;
+};
+
+struct CompiledMap::PointRecord final
+{
+    float x = 0.f;
+    float y = 0.f;
+};
+
+struct CompiledMap::PropertyRecord final
+{
+    std::uint32_t name = 0;
+    std::uint32_t type = 0;
+    std::uint32_t propertyType = 0;
+    std::uint32_t value = 0;
+    std::uint32_t stringValue = 0;
+    std::uint32_t colourValue = 0;
+    Range classValue;
+};
+
+struct CompiledMap::TilesetRecord final
+{
+    std::uint32_t firstGID = 0;
+    std::uint32_t workingDir = 0;
+    std::uint32_t name = 0;
+    std::uint32_t className = 0;
+    std::uint32_t tileSizeX = 0;
+    std::uint32_t tileSizeY = 0;
+    std::uint32_t spacing = 0;
+    std::uint32_t margin = 0;
+    std::uint32_t tileCount = 0;
+    std::uint32_t columnCount = 0;
+    std::uint32_t objectAlignment = 0;
+    std::uint32_t tileOffsetX = 0;
+    std::uint32_t tileOffsetY = 0;
+    Range properties;
+    std::uint32_t imagePath = 0;
+    std::uint32_t imageSizeX = 0;
+    std::uint32_t imageSizeY = 0;
+    std::uint32_t transparencyColour = 0;
+    std::uint32_t hasTransparency = 0;
+    Range terrains;
+    Range tileIndices;
+    Range tiles;
+};
+
+struct CompiledMap::TileRecord final
+{
+    std::uint32_t ID = 0;
+    std::int32_t terrainIndices[4] = {};
+    std::uint32_t probability = 0;
+    Range frames;
+    Range properties;
+    std::uint32_t objectGroup = NoIndex;
+    std::uint32_t imagePath = 0;
+    std::uint32_t imageSizeX = 0;
+    std::uint32_t imageSizeY = 0;
+    std::uint32_t imagePositionX = 0;
+    std::uint32_t imagePositionY = 0;
+    std::uint32_t className = 0;
+};
+
+struct CompiledMap::FrameRecord final
+{
+    std::uint32_t tileID = 0;
+    std::uint32_t duration = 0;
+};
+
+struct CompiledMap::TerrainRecord final
+{
+    std::uint32_t name = 0;
+    std::uint32_t tileID = 0;
+    Range properties;
+};
+
+struct CompiledMap::TemplateRecord final
+{
+    std::uint32_t path = 0;
+    std::uint32_t index = 0;
+};
+
+//public
+bool CompiledMap::isCompiled(const char* data, std::size_t size)
+{
+    return size >= sizeof(Magic) && std::memcmp(data, Magic, sizeof(Magic)) == 0;
+}
+
+void CompiledMap::write(const Map& map, std::vector<char>& output)
+{
+    CompiledMap compiled(nullptr, 0);
+    compiled.addString(std::string());
+
+    MapRecord record;
+    record.versionUpper = map.m_version.upper;
+    record.versionLower = map.m_version.lower;
+    record.className = compiled.addString(toStdString(map.m_class));
+    record.orientation = static_cast<std::uint32_t>(map.m_orientation);
+    record.renderOrder = static_cast<std::uint32_t>(map.m_renderOrder);
+    record.infinite = map.m_infinite ? 1 : 0;
+    record.tileCountX = map.m_tileCount.x;
+    record.tileCountY = map.m_tileCount.y;
+    record.tileSizeX = map.m_tileSize.x;
+    record.tileSizeY = map.m_tileSize.y;
+    record.hexSideLength = map.m_hexSideLength;
+    record.staggerAxis = static_cast<std::uint32_t>(map.m_staggerAxis);
+    record.staggerIndex = static_cast<std::uint32_t>(map.m_staggerIndex);
+    record.parallaxOriginX = map.m_parallaxOrigin.x;
+    record.parallaxOriginY = map.m_parallaxOrigin.y;
+    record.backgroundColour = packColour(map.m_backgroundColour);
+    record.properties = compiled.writeProperties(map.m_properties);
+
+    record.tilesets.first = static_cast<std::uint32_t>(compiled.m_tables[Tilesets].size() / sizeof(TilesetRecord));
+    for (const auto& tileset : map.m_tilesets)
+    {
+        compiled.writeTileset(tileset);
+        record.tilesets.count++;
+    }
+    record.layers = compiled.writeLayers(map.m_layers);
+
+    record.templateObjects.first = static_cast<std::uint32_t>(compiled.m_tables[Templates].size() / sizeof(TemplateRecord));
+    for (const auto& templateObject : map.m_templateObjects)
+    {
+        TemplateRecord entry;
+        entry.path = compiled.addString(templateObject.first);
+        entry.index = compiled.writeObject(templateObject.second);
+        compiled.append(Templates, entry);
+        record.templateObjects.count++;
+    }
+
+    record.templateTilesets.first = static_cast<std::uint32_t>(compiled.m_tables[Templates].size() / sizeof(TemplateRecord));
+    for (const auto& templateTileset : map.m_templateTilesets)
+    {
+        TemplateRecord entry;
+        entry.path = compiled.addString(templateTileset.first);
+        entry.index = compiled.writeTileset(templateTileset.second);
+        compiled.append(Templates, entry);
+        record.templateTilesets.count++;
+    }
+    compiled.append(MapInfo, record);
+
+    //the header is followed by each table in turn
+    Header header;
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = FormatVersion;
+    header.byteOrder = ByteOrderMark;
+
+    std::size_t offset = sizeof(Header);
+    for (auto i = 0; i < SectionCount; ++i)
+    {
+        offset = (offset + SectionAlignment - 1) & ~(SectionAlignment - 1);
+        header.sectionOffsets[i] = offset;
+        header.sectionCounts[i] = compiled.m_tables[i].size() / getRecordSize(static_cast<Section>(i));
+        offset += compiled.m_tables[i].size();
+    }
+
+    output.assign(offset, 0);
+    std::memcpy(output.data(), &header, sizeof(header));
+    for (auto i = 0; i < SectionCount; ++i)
+    {
+        if (!compiled.m_tables[i].empty())
+        {
+            std::memcpy(output.data() + header.sectionOffsets[i], compiled.m_tables[i].data(), compiled.m_tables[i].size());
+        }
+    }
+}
+
+bool CompiledMap::read(const char* data, std::size_t size, Map& map)
+{
+    CompiledMap compiled(data, size);
+    if (!compiled.validate())
+    {
+        return false;
+    }
+    compiled.m_tileStorage = TileLayer::getStorage(map);
+    compiled.m_sparseThreshold = map.getSparseThreshold();
+
+    MapRecord record;
+    if (!compiled.get(MapInfo, 0, record)
+        || !compiled.readString(record.className, map.m_class)
+        || !compiled.readProperties(record.properties, map.m_properties))
+    {
+        Logger::log("Failed reading compiled map properties", Logger::Type::Error);
+        return false;
+    }
+
+    map.m_version.upper = static_cast<std::uint16_t>(record.versionUpper);
+    map.m_version.lower = static_cast<std::uint16_t>(record.versionLower);
+    map.m_orientation = static_cast<Orientation>(record.orientation);
+    map.m_renderOrder = static_cast<RenderOrder>(record.renderOrder);
+    map.m_infinite = record.infinite != 0;
+    map.m_tileCount = { record.tileCountX, record.tileCountY };
+    map.m_tileSize = { record.tileSizeX, record.tileSizeY };
+    map.m_hexSideLength = record.hexSideLength;
+    map.m_staggerAxis = static_cast<StaggerAxis>(record.staggerAxis);
+    map.m_staggerIndex = static_cast<StaggerIndex>(record.staggerIndex);
+    map.m_parallaxOrigin = { record.parallaxOriginX, record.parallaxOriginY };
+    map.m_backgroundColour = unpackColour(record.backgroundColour);
+
+    if (!compiled.checkRange(Tilesets, record.tilesets))
+    {
+        Logger::log("Invalid tile set range in compiled map", Logger::Type::Error);
+        return false;
+    }
+    map.m_tilesets.reserve(record.tilesets.count);
+    for (auto i = 0u; i < record.tilesets.count; ++i)
+    {
+        map.m_tilesets.emplace_back(map.m_workingDirectory);
+        if (!compiled.readTileset(record.tilesets.first + i, map.m_tilesets.back()))
+        {
+            Logger::log("Failed reading compiled tile set", Logger::Type::Error);
+            return false;
+        }
+    }
+
+    if (!compiled.readLayers(record.layers, map.m_layers))
+    {
+        Logger::log("Failed reading compiled map layers", Logger::Type::Error);
+        return false;
+    }
+
+    if (!compiled.checkRange(Templates, record.templateObjects)
+        || !compiled.checkRange(Templates, record.templateTilesets))
+    {
+        Logger::log("Invalid template range in compiled map", Logger::Type::Error);
+        return false;
+    }
+
+    for (auto i = 0u; i < record.templateObjects.count; ++i)
+    {
+        TemplateRecord entry;
+        std::string path;
+        Object object;
+        if (!compiled.get(Templates, record.templateObjects.first + i, entry)
+            || !compiled.readString(entry.path, path)
+            || !compiled.readObject(entry.index, object))
+        {
+            Logger::log("Failed reading compiled template", Logger::Type::Error);
+            return false;
+        }
+        map.m_templateObjects.insert(std::make_pair(path, std::move(object)));
+    }
+
+    for (auto i = 0u; i < record.templateTilesets.count; ++i)
+    {
+        TemplateRecord entry;
+        std::string path;
+        Tileset tileset(map.m_workingDirectory);
+        if (!compiled.get(Templates, record.templateTilesets.first + i, entry)
+            || !compiled.readString(entry.path, path)
+            || !compiled.readTileset(entry.index, tileset))
+        {
+            Logger::log("Failed reading compiled template tile set", Logger::Type::Error);
+            return false;
+        }
+        map.m_templateTilesets.insert(std::make_pair(path, std::move(tileset)));
+    }
+
+    return true;
+}
+
+//private
+CompiledMap::CompiledMap(const char* data, std::size_t size)
+    : m_data    (data),
+    m_size      (size),
+    m_sectionOffsets{},
+    m_sectionCounts {},
+    m_tileStorage   (TileLayer::Storage::Tiles),
+    m_sparseThreshold(0.f)
+{
+
+}
+
+std::size_t CompiledMap::getRecordSize(Section section)
+{
+    switch (section)
+    {
+    default:
+    case StringData: return 1;
+    case StringIndex: return sizeof(StringRecord);
+    case MapInfo: return sizeof(MapRecord);
+    case Layers: return sizeof(LayerRecord);
+    case Chunks: return sizeof(ChunkRecord);
+    case GIDs: return sizeof(std::uint32_t);
+    case Objects: return sizeof(ObjectRecord);
+    case Points: return sizeof(PointRecord);
+    case Properties: return sizeof(PropertyRecord);
+    case Tilesets: return sizeof(TilesetRecord);
+    case TileIndices: return sizeof(std::uint32_t);
+    case Tiles: return sizeof(TileRecord);
+    case Frames: return sizeof(FrameRecord);
+    case Terrains: return sizeof(TerrainRecord);
+    case Templates: return sizeof(TemplateRecord);
+    }
+}
+
+template <typename T>
+std::uint32_t CompiledMap::append(Section section, const T& record)
+{
+    auto& table = m_tables[section];
+    const auto index = static_cast<std::uint32_t>(table.size() / sizeof(T));
+    const auto* bytes = reinterpret_cast<const char*>(&record);
+    table.insert(table.end(), bytes, bytes + sizeof(T));
+    return index;
+}
+
+template <typename T>
+void CompiledMap::set(Section section, std::uint32_t index, const T& record)
+{
+    std::memcpy(m_tables[section].data() + index * sizeof(T), &record, sizeof(T));
+}
+
+std::uint32_t CompiledMap::addString(const std::string& str)
+{
+    auto result = m_stringIDs.find(str);
+    if (result != m_stringIDs.end())
+    {
+        return result->second;
+    }
+
+    StringRecord record;
+    record.offset = static_cast<std::uint32_t>(m_tables[StringData].size());
+    record.length = static_cast<std::uint32_t>(str.size());
+    m_tables[StringData].insert(m_tables[StringData].end(), str.begin(), str.end());
+
+    const auto id = append(StringIndex, record);
+    m_stringIDs.insert(std::make_pair(str, id));
+    return id;
+}
+
+CompiledMap::Range CompiledMap::writeProperties(const Vector<Property>& properties)
+{
+    //space is reserved for the whole list first, as the values of
+    //class properties are written to the same table
+    Range range;
+    range.first = static_cast<std::uint32_t>(m_tables[Properties].size() / sizeof(PropertyRecord));
+    range.count = static_cast<std::uint32_t>(properties.size());
+    m_tables[Properties].resize(m_tables[Properties].size() + properties.size() * sizeof(PropertyRecord));
+
+    for (auto i = 0u; i < range.count; ++i)
+    {
+        const auto& property = properties[i];
+
+        PropertyRecord record;
+        record.name = addString(toStdString(property.m_name));
+        record.type = static_cast<std::uint32_t>(property.m_type);
+        record.propertyType = addString(toStdString(property.m_propertyType));
+        record.stringValue = addString(toStdString(property.m_stringValue));
+        record.colourValue = packColour(property.m_colourValue);
+
+        switch (property.m_type)
+        {
+        default: break;
+        case Property::Type::Boolean:
+            record.value = property.m_boolValue ? 1 : 0;
+            break;
+        case Property::Type::Float:
+            std::memcpy(&record.value, &property.m_floatValue, sizeof(record.value));
+            break;
+        case Property::Type::Int:
+        case Property::Type::Object:
+            record.value = static_cast<std::uint32_t>(property.m_intValue);
+            break;
+        case Property::Type::Class:
+            record.classValue = writeProperties(property.m_classValue);
+            break;
+        }
+        set(Properties, range.first + i, record);
+    }
+    return range;
+}
+
+CompiledMap::Range CompiledMap::writeLayers(const std::vector<Layer::Ptr>& layers)
+{
+    //as with properties the layers of groups are written to
+    //the same table, so space is reserved for the list first
+    Range range;
+    range.first = static_cast<std::uint32_t>(m_tables[Layers].size() / sizeof(LayerRecord));
+    range.count = static_cast<std::uint32_t>(layers.size());
+    m_tables[Layers].resize(m_tables[Layers].size() + layers.size() * sizeof(LayerRecord));
+
+    for (auto i = 0u; i < range.count; ++i)
+    {
+        set(Layers, range.first + i, writeLayer(*layers[i]));
+    }
+    return range;
+}
+
+CompiledMap::LayerRecord CompiledMap::writeLayer(const Layer& layer)
+{
+    LayerRecord record;
+    record.type = static_cast<std::uint32_t>(layer.getType());
+    record.id = layer.m_id;
+    record.name = addString(toStdString(layer.m_name));
+    record.className = addString(toStdString(layer.m_class));
+    record.opacity = layer.m_opacity;
+    record.visible = layer.m_visible ? 1 : 0;
+    record.offsetX = layer.m_offset.x;
+    record.offsetY = layer.m_offset.y;
+    record.startX = layer.m_start.x;
+    record.startY = layer.m_start.y;
+    record.parallaxX = layer.m_parallaxFactor.x;
+    record.parallaxY = layer.m_parallaxFactor.y;
+    record.tintColour = packColour(layer.m_tintColour);
+    record.sizeX = layer.m_size.x;
+    record.sizeY = layer.m_size.y;
+    record.properties = writeProperties(layer.m_properties);
+
+    switch (layer.getType())
+    {
+    case Layer::Type::Tile:
+    {
+        const auto& tileLayer = layer.getLayerAs<TileLayer>();
+        const auto& chunks = tileLayer.getChunks();
+
+        record.encoding = static_cast<std::uint32_t>(tileLayer.m_encoding);
+        record.compression = static_cast<std::uint32_t>(tileLayer.m_compression);
+        record.tileSizeX = tileLayer.m_size.x;
+        record.tileSizeY = tileLayer.m_size.y;
+        record.tileCount = static_cast<std::uint32_t>(tileLayer.m_tileCount);
+        //written from whichever form the tiles are stored in,
+        //so that they aren't converted to tiles
+        const auto storage = tileLayer.m_storage;
+        switch (storage)
+        {
+        case TileLayer::Storage::Tiles:
+            record.GIDs = writeGIDs(tileLayer.m_tiles);
+            break;
+        case TileLayer::Storage::Arrays:
+            record.GIDs = writeGIDs(tileLayer.m_tileIDs, tileLayer.m_flipFlags);
+            break;
+        case TileLayer::Storage::GIDs:
+            record.GIDs = writeGIDs(tileLayer.m_GIDs);
+            break;
+        case TileLayer::Storage::Palette:
+            record.GIDs = writeGIDs(tileLayer.m_palette);
+            break;
+        case TileLayer::Storage::Sparse:
+            record.GIDs = writeGIDs(tileLayer.m_sparse);
+            break;
+        }
+
+        record.chunks.first = static_cast<std::uint32_t>(m_tables[Chunks].size() / sizeof(ChunkRecord));
+        record.chunks.count = static_cast<std::uint32_t>(chunks.size());
+        for (const auto& chunk : chunks)
+        {
+            ChunkRecord chunkRecord;
+            chunkRecord.positionX = chunk.position.x;
+            chunkRecord.positionY = chunk.position.y;
+            chunkRecord.sizeX = chunk.size.x;
+            chunkRecord.sizeY = chunk.size.y;
+            switch (storage)
+            {
+            case TileLayer::Storage::Tiles:
+                chunkRecord.GIDs = writeGIDs(chunk.tiles);
+                break;
+            case TileLayer::Storage::Arrays:
+                chunkRecord.GIDs = writeGIDs(chunk.tileIDs, chunk.flipFlags);
+                break;
+            case TileLayer::Storage::GIDs:
+                chunkRecord.GIDs = writeGIDs(chunk.GIDs);
+                break;
+            case TileLayer::Storage::Palette:
+                chunkRecord.GIDs = writeGIDs(chunk.palette);
+                break;
+            case TileLayer::Storage::Sparse:
+                chunkRecord.GIDs = writeGIDs(chunk.sparse);
+                break;
+            }
+            append(Chunks, chunkRecord);
+        }
+    }
+        break;
+    case Layer::Type::Object:
+    {
+        const auto& group = layer.getLayerAs<ObjectGroup>();
+        record.colour = packColour(group.m_colour);
+        record.drawOrder = static_cast<std::uint32_t>(group.m_drawOrder);
+        record.objects = writeObjects(group.m_objects);
+    }
+        break;
+    case Layer::Type::Image:
+    {
+        const auto& imageLayer = layer.getLayerAs<ImageLayer>();
+        record.imagePath = addString(imageLayer.m_filePath);
+        record.workingDir = addString(imageLayer.m_workingDir);
+        record.transparencyColour = packColour(imageLayer.m_transparencyColour);
+        record.hasTransparency = imageLayer.m_hasTransparency ? 1 : 0;
+        record.imageSizeX = imageLayer.m_imageSize.x;
+        record.imageSizeY = imageLayer.m_imageSize.y;
+        record.repeatX = imageLayer.m_hasRepeatX ? 1 : 0;
+        record.repeatY = imageLayer.m_hasRepeatY ? 1 : 0;
+    }
+        break;
+    case Layer::Type::Group:
+        record.layers = writeLayers(layer.getLayerAs<LayerGroup>().m_layers);
+        break;
+    }
+    return record;
+}
+
+CompiledMap::Range CompiledMap::writeObjects(const Vector<Object>& objects)
+{
+    //objects contain no other objects so can be written in order
+    Range range;
+    range.first = static_cast<std::uint32_t>(m_tables[Objects].size() / sizeof(ObjectRecord));
+    range.count = static_cast<std::uint32_t>(objects.size());
+    for (const auto& object : objects)
+    {
+        writeObject(object);
+    }
+    return range;
+}
+
+std::uint32_t CompiledMap::writeObject(const Object& object)
+{
+    ObjectRecord record;
+    record.UID = object.m_UID;
+    record.name = addString(toStdString(object.m_name));
+    record.className = addString(toStdString(object.m_class));
+    record.templatePath = addString(object.m_template);
+    record.positionX = object.m_position.x;
+    record.positionY = object.m_position.y;
+    record.left = object.m_AABB.left;
+    record.top = object.m_AABB.top;
+    record.width = object.m_AABB.width;
+    record.height = object.m_AABB.height;
+    record.rotation = object.m_rotation;
+    record.tileID = object.m_tileID;
+    record.flipFlags = object.m_flipFlags;
+    record.visible = object.m_visible ? 1 : 0;
+    record.shape = static_cast<std::uint32_t>(object.m_shape);
+
+    record.points.first = static_cast<std::uint32_t>(m_tables[Points].size() / sizeof(PointRecord));
+    record.points.count = static_cast<std::uint32_t>(object.m_points.size());
+    for (const auto& point : object.m_points)
+    {
+        PointRecord pointRecord;
+        pointRecord.x = point.x;
+        pointRecord.y = point.y;
+        append(Points, pointRecord);
+    }
+    record.properties = writeProperties(object.m_properties);
+
+    const auto& text = object.m_textData;
+    record.fontFamily = addString(toStdString(text.fontFamily));
+    record.pixelSize = text.pixelSize;
+    record.wrap = text.wrap ? 1 : 0;
+    record.textColour = packColour(text.colour);
+    record.bold = text.bold ? 1 : 0;
+    record.italic = text.italic ? 1 : 0;
+    record.underline = text.underline ? 1 : 0;
+    record.strikethrough = text.strikethough ? 1 : 0;
+    record.kerning = text.kerning ? 1 : 0;
+    record.hAlign = static_cast<std::uint32_t>(text.hAlign);
+    record.vAlign = static_cast<std::uint32_t>(text.vAlign);
+    record.content = addString(toStdString(text.content));
+    record.tilesetName = addString(toStdString(object.m_tilesetName));
+
+    return append(Objects, record);
+}
+
+std::uint32_t CompiledMap::writeTileset(const Tileset& tileset)
+{
+    //tile sets loaded through a TilesetCache are written out in full
+    const auto& data = tileset.data();
+
+    TilesetRecord record;
+    record.firstGID = tileset.m_firstGID;
+    record.workingDir = addString(tileset.m_workingDir);
+    record.name = addString(toStdString(data.m_name));
+    record.className = addString(toStdString(data.m_class));
+    record.tileSizeX = data.m_tileSize.x;
+    record.tileSizeY = data.m_tileSize.y;
+    record.spacing = data.m_spacing;
+    record.margin = data.m_margin;
+    record.tileCount = data.m_tileCount;
+    record.columnCount = data.m_columnCount;
+    record.objectAlignment = static_cast<std::uint32_t>(data.m_objectAlignment);
+    record.tileOffsetX = data.m_tileOffset.x;
+    record.tileOffsetY = data.m_tileOffset.y;
+    record.properties = writeProperties(data.m_properties);
+    record.imagePath = addString(toStdString(data.m_imagePath));
+    record.imageSizeX = data.m_imageSize.x;
+    record.imageSizeY = data.m_imageSize.y;
+    record.transparencyColour = packColour(data.m_transparencyColour);
+    record.hasTransparency = data.m_hasTransparency ? 1 : 0;
+
+    record.terrains.first = static_cast<std::uint32_t>(m_tables[Terrains].size() / sizeof(TerrainRecord));
+    record.terrains.count = static_cast<std::uint32_t>(data.m_terrainTypes.size());
+    for (const auto& terrain : data.m_terrainTypes)
+    {
+        TerrainRecord terrainRecord;
+        terrainRecord.name = addString(toStdString(terrain.name));
+        terrainRecord.tileID = terrain.tileID;
+        terrainRecord.properties = writeProperties(terrain.properties);
+        append(Terrains, terrainRecord);
+    }
+
+    record.tileIndices.first = static_cast<std::uint32_t>(m_tables[TileIndices].size() / sizeof(std::uint32_t));
+    record.tileIndices.count = static_cast<std::uint32_t>(data.m_tileIndex.size());
+    for (auto index : data.m_tileIndex)
+    {
+        append(TileIndices, index);
+    }
+
+    record.tiles.first = static_cast<std::uint32_t>(m_tables[Tiles].size() / sizeof(TileRecord));
+    record.tiles.count = static_cast<std::uint32_t>(data.m_tiles.size());
+    for (const auto& tile : data.m_tiles)
+    {
+        TileRecord tileRecord;
+        tileRecord.ID = tile.ID;
+        for (auto i = 0u; i < tile.terrainIndices.size(); ++i)
+        {
+            tileRecord.terrainIndices[i] = tile.terrainIndices[i];
+        }
+        tileRecord.probability = tile.probability;
+
+        tileRecord.frames.first = static_cast<std::uint32_t>(m_tables[Frames].size() / sizeof(FrameRecord));
+        tileRecord.frames.count = static_cast<std::uint32_t>(tile.animation.frames.size());
+        for (const auto& frame : tile.animation.frames)
+        {
+            FrameRecord frameRecord;
+            frameRecord.tileID = frame.tileID;
+            frameRecord.duration = frame.duration;
+            append(Frames, frameRecord);
+        }
+        tileRecord.properties = writeProperties(tile.properties);
+
+        //most tiles have no collision objects, so empty groups aren't stored
+        const auto& objectGroup = tile.objectGroup;
+        if (!objectGroup.getObjects().empty() || !objectGroup.Layer::getProperties().empty()
+            || !objectGroup.getName().empty())
+        {
+            tileRecord.objectGroup = append(Layers, writeLayer(objectGroup));
+        }
+
+        tileRecord.imagePath = addString(toStdString(tile.imagePath));
+        tileRecord.imageSizeX = tile.imageSize.x;
+        tileRecord.imageSizeY = tile.imageSize.y;
+        tileRecord.imagePositionX = tile.imagePosition.x;
+        tileRecord.imagePositionY = tile.imagePosition.y;
+        tileRecord.className = addString(toStdString(tile.className));
+        append(Tiles, tileRecord);
+    }
+
+    return append(Tilesets, record);
+}
+
+CompiledMap::Range CompiledMap::writeGIDs(const std::vector<TileLayer::Tile>& tiles)
+{
+    Range range;
+    range.first = static_cast<std::uint32_t>(m_tables[GIDs].size() / sizeof(std::uint32_t));
+    range.count = static_cast<std::uint32_t>(tiles.size());
+
+    auto& table = m_tables[GIDs];
+    auto offset = table.size();
+    table.resize(offset + tiles.size() * sizeof(std::uint32_t));
+    for (const auto& tile : tiles)
+    {
+        //stored in the same form as the map file, with the flip flags in the top bits
+        const std::uint32_t GID = tile.ID | (std::uint32_t(tile.flipFlags) << 28);
+        std::memcpy(table.data() + offset, &GID, sizeof(GID));
+        offset += sizeof(GID);
+    }
+    return range;
+}
+
+CompiledMap::Range CompiledMap::writeGIDs(const std::vector<std::uint32_t>& tileIDs, const std::vector<std::uint8_t>& flipFlags)
+{
+    Range range;
+    range.first = static_cast<std::uint32_t>(m_tables[GIDs].size() / sizeof(std::uint32_t));
+    range.count = static_cast<std::uint32_t>(tileIDs.size());
+
+    auto& table = m_tables[GIDs];
+    auto offset = table.size();
+    table.resize(offset + tileIDs.size() * sizeof(std::uint32_t));
+    for (auto i = 0u; i < tileIDs.size(); ++i)
+    {
+        const std::uint32_t GID = tileIDs[i] | (std::uint32_t(flipFlags[i]) << 28);
+        std::memcpy(table.data() + offset, &GID, sizeof(GID));
+        offset += sizeof(GID);
+    }
+    return range;
+}
+
+CompiledMap::Range CompiledMap::writeGIDs(const std::vector<std::uint32_t>& GIDs)
+{
+    Range range;
+    range.first = static_cast<std::uint32_t>(m_tables[Section::GIDs].size() / sizeof(std::uint32_t));
+    range.count = static_cast<std::uint32_t>(GIDs.size());
+
+    auto& table = m_tables[Section::GIDs];
+    const auto offset = table.size();
+    table.resize(offset + GIDs.size() * sizeof(std::uint32_t));
+    if (!GIDs.empty())
+    {
+        std::memcpy(table.data() + offset, GIDs.data(), GIDs.size() * sizeof(std::uint32_t));
+    }
+    return range;
+}
+
+CompiledMap::Range CompiledMap::writeGIDs(const TileLayer::Palette& palette)
+{
+    Range range;
+    range.first = static_cast<std::uint32_t>(m_tables[Section::GIDs].size() / sizeof(std::uint32_t));
+    range.count = static_cast<std::uint32_t>(palette.size());
+
+    auto& table = m_tables[Section::GIDs];
+    auto offset = table.size();
+    table.resize(offset + palette.size() * sizeof(std::uint32_t));
+    palette.forEach([&](const TileLayer::Tile& tile)
+        {
+            const std::uint32_t GID = tile.ID | (std::uint32_t(tile.flipFlags) << 28);
+            std::memcpy(table.data() + offset, &GID, sizeof(GID));
+            offset += sizeof(GID);
+        });
+    return range;
+}
+
+CompiledMap::Range CompiledMap::writeGIDs(const TileLayer::SparseTiles& sparse)
+{
+    Range range;
+    range.first = static_cast<std::uint32_t>(m_tables[Section::GIDs].size() / sizeof(std::uint32_t));
+    range.count = static_cast<std::uint32_t>(sparse.size());
+
+    //written in full, with the empty tiles as 0
+    auto& table = m_tables[Section::GIDs];
+    const auto offset = table.size();
+    table.resize(offset + sparse.size() * sizeof(std::uint32_t));
+    sparse.forEach([&](std::size_t position, const TileLayer::Tile& tile)
+        {
+            const std::uint32_t GID = tile.ID | (std::uint32_t(tile.flipFlags) << 28);
+            std::memcpy(table.data() + offset + position * sizeof(GID), &GID, sizeof(GID));
+        });
+    return range;
+}
+
+bool CompiledMap::validate()
+{
+    Header header;
+    if (m_size < sizeof(header))
+    {
+        Logger::log("Compiled map is too small", Logger::Type::Error);
+        return false;
+    }
+    std::memcpy(&header, m_data, sizeof(header));
+
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0)
+    {
+        Logger::log("Not a compiled map", Logger::Type::Error);
+        return false;
+    }
+
+    if (header.byteOrder != ByteOrderMark)
+    {
+        Logger::log("Compiled map was written with a different byte order", Logger::Type::Error);
+        return false;
+    }
+
+    if (header.version != FormatVersion)
+    {
+        Logger::log("Unsupported compiled map version " + std::to_string(header.version), Logger::Type::Error);
+        return false;
+    }
+
+    for (auto i = 0; i < SectionCount; ++i)
+    {
+        const auto offset = header.sectionOffsets[i];
+        const auto count = header.sectionCounts[i];
+        if (offset > m_size || count > (m_size - offset) / getRecordSize(static_cast<Section>(i)))
+        {
+            Logger::log("Compiled map is truncated or corrupt", Logger::Type::Error);
+            return false;
+        }
+        m_sectionOffsets[i] = offset;
+        m_sectionCounts[i] = count;
+    }
+
+    if (m_sectionCounts[MapInfo] != 1 || m_sectionCounts[StringIndex] == 0)
+    {
+        Logger::log("Compiled map is missing required data", Logger::Type::Error);
+        return false;
+    }
+    return true;
+}
+
+template <typename T>
+bool CompiledMap::get(Section section, std::uint32_t index, T& record) const
+{
+    if (index >= m_sectionCounts[section])
+    {
+        return false;
+    }
+    std::memcpy(&record, m_data + m_sectionOffsets[section] + std::uint64_t(index) * sizeof(T), sizeof(T));
+    return true;
+}
+
+bool CompiledMap::checkRange(Section section, const Range& range, std::uint32_t minFirst) const
+{
+    if (range.count == 0)
+    {
+        return true;
+    }
+    return range.first >= minFirst
+        && std::uint64_t(range.first) + range.count <= m_sectionCounts[section];
+}
+
+bool CompiledMap::readString(std::uint32_t id, String& output) const
+{
+    StringRecord record;
+    if (!get(StringIndex, id, record)
+        || std::uint64_t(record.offset) + record.length > m_sectionCounts[StringData])
+    {
+        return false;
+    }
+    output.assign(m_data + m_sectionOffsets[StringData] + record.offset, record.length);
+    return true;
+}
+
+#ifdef TMXLITE_USE_ARENA
+bool CompiledMap::readString(std::uint32_t id, std::string& output) const
+{
+    String str;
+    if (!readString(id, str))
+    {
+        return false;
+    }
+    output = toStdString(str);
+    return true;
+}
+#endif
+
+bool CompiledMap::readProperties(const Range& range, Vector<Property>& output, std::uint32_t minFirst) const
+{
+    if (!checkRange(Properties, range, minFirst))
+    {
+        return false;
+    }
+
+    output.resize(range.count);
+    for (auto i = 0u; i < range.count; ++i)
+    {
+        const auto index = range.first + i;
+        auto& property = output[i];
+
+        PropertyRecord record;
+        if (!get(Properties, index, record)
+            || record.type > static_cast<std::uint32_t>(Property::Type::Undef)
+            || !readString(record.name, property.m_name)
+            || !readString(record.propertyType, property.m_propertyType)
+            || !readString(record.stringValue, property.m_stringValue))
+        {
+            return false;
+        }
+        property.m_type = static_cast<Property::Type>(record.type);
+        property.m_colourValue = unpackColour(record.colourValue);
+
+        switch (property.m_type)
+        {
+        default: break;
+        case Property::Type::Boolean:
+            property.m_boolValue = record.value != 0;
+            break;
+        case Property::Type::Float:
+            std::memcpy(&property.m_floatValue, &record.value, sizeof(record.value));
+            break;
+        case Property::Type::Int:
+        case Property::Type::Object:
+            property.m_intValue = static_cast<int>(record.value);
+            break;
+        case Property::Type::Class:
+            if (!readProperties(record.classValue, property.m_classValue, index + 1))
+            {
+                return false;
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+bool CompiledMap::readLayers(const Range& range, std::vector<Layer::Ptr>& output, std::uint32_t minFirst) const
+{
+    if (!checkRange(Layers, range, minFirst))
+    {
+        return false;
+    }
+
+    output.reserve(range.count);
+    for (auto i = 0u; i < range.count; ++i)
+    {
+        Layer::Ptr layer;
+        if (!readLayer(range.first + i, layer))
+        {
+            return false;
+        }
+        output.push_back(std::move(layer));
+    }
+    return true;
+}
+
+bool CompiledMap::readLayer(std::uint32_t index, Layer::Ptr& output) const
+{
+    LayerRecord record;
+    if (!get(Layers, index, record))
+    {
+        return false;
+    }
+
+    switch (static_cast<Layer::Type>(record.type))
+    {
+    default:
+        return false;
+    case Layer::Type::Tile:
+    {
+        auto* layer = new TileLayer(record.tileCount);
+        output.reset(layer);
+
+        layer->m_encoding = static_cast<TileLayer::EncodingType>(record.encoding);
+        layer->m_compression = static_cast<TileLayer::CompressionType>(record.compression);
+        layer->m_size = { record.tileSizeX, record.tileSizeY };
+        layer->setStorage(m_tileStorage, m_sparseThreshold);
+        if (!readGIDs(record.GIDs, *layer, layer->getStore())
+            || !checkRange(Chunks, record.chunks))
+        {
+            return false;
+        }
+
+        layer->m_chunks.resize(record.chunks.count);
+        for (auto i = 0u; i < record.chunks.count; ++i)
+        {
+            ChunkRecord chunkRecord;
+            auto& chunk = layer->m_chunks[i];
+            if (!get(Chunks, record.chunks.first + i, chunkRecord)
+                || !readGIDs(chunkRecord.GIDs, *layer, TileLayer::getStore(chunk)))
+            {
+                return false;
+            }
+            chunk.position = { chunkRecord.positionX, chunkRecord.positionY };
+            chunk.size = { chunkRecord.sizeX, chunkRecord.sizeY };
+        }
+        layer->m_hasData = layer->getStoredCount(layer->getStore()) != 0 || !layer->m_chunks.empty();
+        layer->applySparseThreshold();
+        layer->buildChunkIndex();
+        layer->m_decoded.store(true, std::memory_order_release);
+    }
+        break;
+    case Layer::Type::Object:
+    {
+        //reads the common layer data too
+        auto* layer = new ObjectGroup();
+        output.reset(layer);
+        return readObjectGroup(index, *layer);
+    }
+    case Layer::Type::Image:
+    {
+        std::string workingDir;
+        if (!readString(record.workingDir, workingDir))
+        {
+            return false;
+        }
+
+        auto* layer = new ImageLayer(workingDir);
+        output.reset(layer);
+        if (!readString(record.imagePath, layer->m_filePath))
+        {
+            return false;
+        }
+        layer->m_transparencyColour = unpackColour(record.transparencyColour);
+        layer->m_hasTransparency = record.hasTransparency != 0;
+        layer->m_imageSize = { record.imageSizeX, record.imageSizeY };
+        layer->m_hasRepeatX = record.repeatX != 0;
+        layer->m_hasRepeatY = record.repeatY != 0;
+    }
+        break;
+    case Layer::Type::Group:
+    {
+        auto* layer = new LayerGroup();
+        output.reset(layer);
+        if (!readLayers(record.layers, layer->m_layers, index + 1))
+        {
+            return false;
+        }
+    }
+        break;
+    }
+
+    return readLayerCommon(record, *output);
+}
+
+bool CompiledMap::readLayerCommon(const LayerRecord& record, Layer& layer) const
+{
+    layer.m_id = record.id;
+    layer.m_opacity = record.opacity;
+    layer.m_visible = record.visible != 0;
+    layer.m_offset = { record.offsetX, record.offsetY };
+    layer.m_start = { record.startX, record.startY };
+    layer.m_parallaxFactor = { record.parallaxX, record.parallaxY };
+    layer.m_tintColour = unpackColour(record.tintColour);
+    layer.m_size = { record.sizeX, record.sizeY };
+    return readString(record.name, layer.m_name)
+        && readString(record.className, layer.m_class)
+        && readProperties(record.properties, layer.m_properties);
+}
+
+bool CompiledMap::readObjectGroup(std::uint32_t index, ObjectGroup& group) const
+{
+    LayerRecord record;
+    if (!get(Layers, index, record)
+        || record.type != static_cast<std::uint32_t>(Layer::Type::Object)
+        || !checkRange(Objects, record.objects))
+    {
+        return false;
+    }
+
+    group.m_colour = unpackColour(record.colour);
+    group.m_drawOrder = static_cast<ObjectGroup::DrawOrder>(record.drawOrder);
+    group.m_objects.resize(record.objects.count);
+    for (auto i = 0u; i < record.objects.count; ++i)
+    {
+        if (!readObject(record.objects.first + i, group.m_objects[i]))
+        {
+            return false;
+        }
+    }
+    return readLayerCommon(record, group);
+}
+
+bool CompiledMap::readObject(std::uint32_t index, Object& object) const
+{
+    ObjectRecord record;
+    if (!get(Objects, index, record)
+        || !checkRange(Points, record.points))
+    {
+        return false;
+    }
+
+    object.m_UID = record.UID;
+    object.m_position = { record.positionX, record.positionY };
+    object.m_AABB = { record.left, record.top, record.width, record.height };
+    object.m_rotation = record.rotation;
+    object.m_tileID = record.tileID;
+    object.m_flipFlags = static_cast<std::uint8_t>(record.flipFlags);
+    object.m_visible = record.visible != 0;
+    object.m_shape = static_cast<Object::Shape>(record.shape);
+
+    object.m_points.resize(record.points.count);
+    for (auto i = 0u; i < record.points.count; ++i)
+    {
+        PointRecord point;
+        get(Points, record.points.first + i, point);
+        object.m_points[i] = { point.x, point.y };
+    }
+
+    auto& text = object.m_textData;
+    text.pixelSize = record.pixelSize;
+    text.wrap = record.wrap != 0;
+    text.colour = unpackColour(record.textColour);
+    text.bold = record.bold != 0;
+    text.italic = record.italic != 0;
+    text.underline = record.underline != 0;
+    text.strikethough = record.strikethrough != 0;
+    text.kerning = record.kerning != 0;
+    text.hAlign = static_cast<Text::HAlign>(record.hAlign);
+    text.vAlign = static_cast<Text::VAlign>(record.vAlign);
+
+    return readString(record.name, object.m_name)
+        && readString(record.className, object.m_class)
+        && readString(record.templatePath, object.m_template)
+        && readString(record.fontFamily, text.fontFamily)
+        && readString(record.content, text.content)
+        && readString(record.tilesetName, object.m_tilesetName)
+        && readProperties(record.properties, object.m_properties);
+}
+
+bool CompiledMap::readTileset(std::uint32_t index, Tileset& tileset) const
+{
+    TilesetRecord record;
+    if (!get(Tilesets, index, record)
+        || !checkRange(Terrains, record.terrains)
+        || !checkRange(TileIndices, record.tileIndices)
+        || !checkRange(Tiles, record.tiles)
+        || !readString(record.workingDir, tileset.m_workingDir)
+        || !readString(record.name, tileset.m_name)
+        || !readString(record.className, tileset.m_class)
+        || !readString(record.imagePath, tileset.m_imagePath)
+        || !readProperties(record.properties, tileset.m_properties))
+    {
+        return false;
+    }
+
+    tileset.m_firstGID = record.firstGID;
+    tileset.m_tileSize = { record.tileSizeX, record.tileSizeY };
+    tileset.m_spacing = record.spacing;
+    tileset.m_margin = record.margin;
+    tileset.m_tileCount = record.tileCount;
+    tileset.m_columnCount = record.columnCount;
+    tileset.m_objectAlignment = static_cast<Tileset::ObjectAlignment>(record.objectAlignment);
+    tileset.m_tileOffset = { record.tileOffsetX, record.tileOffsetY };
+    tileset.m_imageSize = { record.imageSizeX, record.imageSizeY };
+    tileset.m_transparencyColour = unpackColour(record.transparencyColour);
+    tileset.m_hasTransparency = record.hasTransparency != 0;
+
+    tileset.m_terrainTypes.resize(record.terrains.count);
+    for (auto i = 0u; i < record.terrains.count; ++i)
+    {
+        TerrainRecord terrainRecord;
+        auto& terrain = tileset.m_terrainTypes[i];
+        get(Terrains, record.terrains.first + i, terrainRecord);
+        terrain.tileID = terrainRecord.tileID;
+        if (!readString(terrainRecord.name, terrain.name)
+            || !readProperties(terrainRecord.properties, terrain.properties))
+        {
+            return false;
+        }
+    }
+
+    //indices refer to tiles by their position plus one, with 0 for no tile
+    tileset.m_tileIndex.resize(record.tileIndices.count);
+    for (auto i = 0u; i < record.tileIndices.count; ++i)
+    {
+        auto& tileIndex = tileset.m_tileIndex[i];
+        get(TileIndices, record.tileIndices.first + i, tileIndex);
+        if (tileIndex > record.tiles.count)
+        {
+            return false;
+        }
+    }
+
+    tileset.m_tiles.resize(record.tiles.count);
+    for (auto i = 0u; i < record.tiles.count; ++i)
+    {
+        TileRecord tileRecord;
+        auto& tile = tileset.m_tiles[i];
+        get(Tiles, record.tiles.first + i, tileRecord);
+        if (!checkRange(Frames, tileRecord.frames)
+            || !readString(tileRecord.imagePath, tile.imagePath)
+            || !readString(tileRecord.className, tile.className)
+            || !readProperties(tileRecord.properties, tile.properties)
+            || (tileRecord.objectGroup != NoIndex && !readObjectGroup(tileRecord.objectGroup, tile.objectGroup)))
+        {
+            return false;
+        }
+
+        tile.ID = tileRecord.ID;
+        for (auto j = 0u; j < tile.terrainIndices.size(); ++j)
+        {
+            tile.terrainIndices[j] = tileRecord.terrainIndices[j];
+        }
+        tile.probability = tileRecord.probability;
+        tile.imageSize = { tileRecord.imageSizeX, tileRecord.imageSizeY };
+        tile.imagePosition = { tileRecord.imagePositionX, tileRecord.imagePositionY };
+
+        tile.animation.frames.resize(tileRecord.frames.count);
+        for (auto j = 0u; j < tileRecord.frames.count; ++j)
+        {
+            FrameRecord frame;
+            get(Frames, tileRecord.frames.first + j, frame);
+            tile.animation.frames[j].tileID = frame.tileID;
+            tile.animation.frames[j].duration = frame.duration;
+        }
+    }
+    return true;
+}
+
+bool CompiledMap::readGIDs(const Range& range, TileLayer& layer, const TileLayer::TileStore& store) const
+{
+    if (!checkRange(Section::GIDs, range))
+    {
+        return false;
+    }
+
+    //copied in blocks as the table may not be aligned, and
+    //split by the layer into the form it stores its tiles in
+    const char* data = m_data + m_sectionOffsets[Section::GIDs] + std::uint64_t(range.first) * sizeof(std::uint32_t);
+    switch (layer.m_storage)
+    {
+    case TileLayer::Storage::GIDs:
+        store.GIDs.resize(range.count);
+        if (range.count != 0)
+        {
+            std::memcpy(store.GIDs.data(), data, range.count * sizeof(std::uint32_t));
+        }
+        return true;
+    default:
+        layer.reserveTiles(store, range.count);
+        break;
+    }
+
+    std::uint32_t block[TileLayer::DecodeBlockSize];
+    for (std::size_t i = 0; i < range.count; i += TileLayer::DecodeBlockSize)
+    {
+        const auto count = std::min<std::size_t>(range.count - i, TileLayer::DecodeBlockSize);
+        std::memcpy(block, data + i * sizeof(std::uint32_t), count * sizeof(std::uint32_t));
+        layer.createTiles(block, count, store);
+    }
+    store.palette.finish();
+    store.sparse.finish();
+    return true;
+}
@@ -0,0 +1,171 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#pragma once
+
+#include <tmxlite/Property.hpp>
+#include <tmxlite/TileLayer.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tmx
+{
+    class Map;
+    class Tileset;
+    class Object;
+    class ObjectGroup;
+    class Property;
+
+    namespace detail
+    {
+        /*!
+        \brief Writes a parsed Map to the compiled binary format, and
+        reads it back without any parsing or decompression.
+        A compiled map is a header followed by a set of flat tables, one
+        for each type of record: layers, chunks, raw GIDs, objects,
+        properties, tile sets and strings. Records refer to each other
+        by their index within a table, and to lists of records as a range
+        of consecutive indices. Values are stored in the byte order of the
+        machine which wrote them, and files written on a machine of a
+        different byte order or by another version are rejected.
+        */
+        class CompiledMap final
+        {
+        public:
+            /*!
+            \brief Returns true if the data starts with the header of a
+            compiled map, regardless of its version.
+            */
+            static bool isCompiled(const char* data, std::size_t size);
+
+            /*!
+            \brief Writes the given Map to the output buffer.
+            Any tile layers which have not yet been decoded are decoded.
+            */
+            static void write(const Map&, std::vector<char>& output);
+
+            /*!
+            \brief Reads a compiled map into the given Map, which is
+            expected to have been reset.
+            \returns false if the data is not a valid compiled map
+            */
+            static bool read(const char* data, std::size_t size, Map&);
+
+            enum Section
+            {
+                StringIndex,
+                StringData,
+                MapInfo,
+                Layers,
+                Chunks,
+                GIDs,
+                Objects,
+                Points,
+                Properties,
+                Tilesets,
+                TileIndices,
+                Tiles,
+                Frames,
+                Terrains,
+                Templates,
+                SectionCount
+            };
+
+        private:
+            CompiledMap(const char* data, std::size_t size);
+
+            const char* m_data;
+            std::size_t m_size;
+            std::uint64_t m_sectionOffsets[SectionCount];
+            std::uint64_t m_sectionCounts[SectionCount];
+
+            std::vector<char> m_tables[SectionCount];
+
+            //set when reading, to store tiles as the Map::TileStorage of the map
+            TileLayer::Storage m_tileStorage;
+            float m_sparseThreshold;
+            std::unordered_map<std::string, std::uint32_t> m_stringIDs;
+
+            //records stored in the tables, defined in CompiledMap.cpp
+            struct Header;
+            struct Range;
+            struct MapRecord;
+            struct LayerRecord;
+            struct ChunkRecord;
+            struct ObjectRecord;
+            struct PointRecord;
+            struct PropertyRecord;
+            struct TilesetRecord;
+            struct TileRecord;
+            struct FrameRecord;
+            struct TerrainRecord;
+            struct TemplateRecord;
+            struct StringRecord;
+            static std::size_t getRecordSize(Section);
+
+            //writing
+            template <typename T>
+            std::uint32_t append(Section, const T&);
+            template <typename T>
+            void set(Section, std::uint32_t index, const T&);
+            std::uint32_t addString(const std::string&);
+            Range writeProperties(const Vector<Property>&);
+            Range writeLayers(const std::vector<Layer::Ptr>&);
+            LayerRecord writeLayer(const Layer&);
+            Range writeObjects(const Vector<Object>&);
+            std::uint32_t writeObject(const Object&);
+            std::uint32_t writeTileset(const Tileset&);
+            Range writeGIDs(const std::vector<TileLayer::Tile>&);
+            Range writeGIDs(const std::vector<std::uint32_t>& tileIDs, const std::vector<std::uint8_t>& flipFlags);
+            Range writeGIDs(const std::vector<std::uint32_t>& GIDs);
+            Range writeGIDs(const TileLayer::Palette&);
+            Range writeGIDs(const TileLayer::SparseTiles&);
+
+            //reading
+            bool validate();
+            template <typename T>
+            bool get(Section, std::uint32_t index, T&) const;
+            //minFirst is used by nested ranges, which must start after
+            //their parent so that a malformed file can't form a loop
+            bool checkRange(Section, const Range&, std::uint32_t minFirst = 0) const;
+            bool readString(std::uint32_t id, String&) const;
+#ifdef TMXLITE_USE_ARENA
+            bool readString(std::uint32_t id, std::string&) const;
+#endif
+            bool readProperties(const Range&, Vector<Property>&, std::uint32_t minFirst = 0) const;
+            bool readLayers(const Range&, std::vector<Layer::Ptr>&, std::uint32_t minFirst = 0) const;
+            bool readLayer(std::uint32_t index, Layer::Ptr&) const;
+            bool readLayerCommon(const LayerRecord&, Layer&) const;
+            bool readObjectGroup(std::uint32_t index, ObjectGroup&) const;
+            bool readObject(std::uint32_t index, Object&) const;
+            bool readTileset(std::uint32_t index, Tileset&) const;
+            bool readGIDs(const Range&, TileLayer&, const TileLayer::TileStore&) const;
+        };
+    }
+}
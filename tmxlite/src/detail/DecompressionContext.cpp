@@ -0,0 +1,232 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#include "DecompressionContext.hpp"
+#include "Gzip.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using namespace tmx::detail;
+
+DecompressionContext::DecompressionContext()
+    : m_inflating   (false)
+#if defined USE_ZSTD || defined USE_EXTLIBS
+    , m_zstdContext (nullptr)
+#endif
+#ifdef USE_LIBDEFLATE
+    , m_deflateDecompressor(nullptr)
+#endif
+{
+    std::memset(&m_stream, 0, sizeof(m_stream));
+}
+
+DecompressionContext::~DecompressionContext()
+{
+    endInflate();
+#if defined USE_ZSTD || defined USE_EXTLIBS
+    ZSTD_freeDCtx(m_zstdContext);
+#endif
+#ifdef USE_LIBDEFLATE
+    if (m_deflateDecompressor != nullptr)
+    {
+        libdeflate_free_decompressor(m_deflateDecompressor);
+    }
+#endif
+
+    for (auto& block : m_blocks)
+    {
+        std::free(block.data);
+    }
+}
+
+//public
+DecompressionContext& DecompressionContext::getThreadContext()
+{
+    thread_local DecompressionContext context;
+    return context;
+}
+
+z_stream* DecompressionContext::beginInflate(bool raw)
+{
+    endInflate();
+
+    std::memset(&m_stream, 0, sizeof(m_stream));
+    m_stream.zalloc = &DecompressionContext::allocate;
+    m_stream.zfree = &DecompressionContext::release;
+    m_stream.opaque = this;
+
+    //miniz only accepts a window size of 15, and has no gzip support,
+    //so gzip headers are read by the caller with raw streams used
+    //for the deflate data
+    const auto result = raw ? inflateInit2(&m_stream, -MAX_WBITS) : inflateInit(&m_stream);
+    if (result != Z_OK)
+    {
+        return nullptr;
+    }
+
+    m_inflating = true;
+    return &m_stream;
+}
+
+void DecompressionContext::endInflate()
+{
+    if (m_inflating)
+    {
+        inflateEnd(&m_stream);
+        m_inflating = false;
+    }
+}
+
+#if defined USE_ZSTD || defined USE_EXTLIBS
+ZSTD_DCtx* DecompressionContext::beginZstd(const ZSTD_DDict* dictionary)
+{
+    if (m_zstdContext == nullptr)
+    {
+        m_zstdContext = ZSTD_createDCtx();
+        if (m_zstdContext == nullptr)
+        {
+            return nullptr;
+        }
+    }
+
+    //passing nullptr removes any dictionary used by the previous frame
+    if (ZSTD_isError(ZSTD_DCtx_reset(m_zstdContext, ZSTD_reset_session_only))
+        || ZSTD_isError(ZSTD_DCtx_refDDict(m_zstdContext, dictionary)))
+    {
+        return nullptr;
+    }
+    return m_zstdContext;
+}
+#endif
+
+#ifdef USE_LIBDEFLATE
+libdeflate_result DecompressionContext::inflateWhole(const unsigned char* source, std::size_t size,
+    unsigned char* dest, std::size_t destSize, std::size_t& written)
+{
+    written = 0;
+    if (m_deflateDecompressor == nullptr)
+    {
+        m_deflateDecompressor = libdeflate_alloc_decompressor();
+        if (m_deflateDecompressor == nullptr)
+        {
+            return LIBDEFLATE_BAD_DATA;
+        }
+    }
+
+    std::size_t readSize = 0;
+    const auto result = isGzip(source, size) ?
+        libdeflate_gzip_decompress_ex(m_deflateDecompressor, source, size, dest, destSize, &readSize, &written) :
+        libdeflate_zlib_decompress_ex(m_deflateDecompressor, source, size, dest, destSize, &readSize, &written);
+
+    if (result == LIBDEFLATE_SUCCESS && readSize != size)
+    {
+        //trailing data after the end of the stream
+        written = 0;
+        return LIBDEFLATE_BAD_DATA;
+    }
+    return result;
+}
+
+bool DecompressionContext::inflateWhole(const unsigned char* source, std::size_t size,
+    std::vector<unsigned char>& dest, std::size_t expectedSize)
+{
+    const auto start = dest.size();
+    auto outSize = std::max(expectedSize, std::size_t(1));
+    for (;;)
+    {
+        dest.resize(start + outSize);
+
+        std::size_t written = 0;
+        const auto result = inflateWhole(source, size, dest.data() + start, outSize, written);
+        switch (result)
+        {
+        default:
+            dest.resize(start);
+            return false;
+        case LIBDEFLATE_SUCCESS:
+            dest.resize(start + written);
+            return true;
+        case LIBDEFLATE_INSUFFICIENT_SPACE:
+            //the expected size was too small
+            outSize *= 2;
+            break;
+        }
+    }
+}
+
+void DecompressionContext::trimBuffers()
+{
+    static constexpr std::size_t MaxBufferSize = 1024 * 1024;
+    for (auto* buffer : { &m_inputBuffer, &m_outputBuffer })
+    {
+        if (buffer->capacity() > MaxBufferSize)
+        {
+            std::vector<unsigned char>().swap(*buffer);
+        }
+    }
+}
+#endif
+
+//private
+void* DecompressionContext::allocate(void* opaque, AllocSize items, AllocSize size)
+{
+    //blocks are kept once released, so each stream
+    //is given the same blocks as the one before it
+    auto* context = static_cast<DecompressionContext*>(opaque);
+    const std::size_t bytes = static_cast<std::size_t>(items) * size;
+    for (auto& block : context->m_blocks)
+    {
+        if (!block.used && block.size >= bytes)
+        {
+            block.used = true;
+            return block.data;
+        }
+    }
+
+    Block block;
+    block.data = std::malloc(bytes);
+    if (block.data == nullptr)
+    {
+        return nullptr;
+    }
+    block.size = bytes;
+    block.used = true;
+    context->m_blocks.push_back(block);
+    return block.data;
+}
+
+void DecompressionContext::release(void* opaque, void* address)
+{
+    auto* context = static_cast<DecompressionContext*>(opaque);
+    for (auto& block : context->m_blocks)
+    {
+        if (block.data == address)
+        {
+            block.used = false;
+            return;
+        }
+    }
+}
@@ -0,0 +1,162 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#ifndef USE_EXTLIBS
+#include "../miniz.h"
+#else
+#include <zlib.h>
+#endif
+
+#if defined USE_ZSTD || defined USE_EXTLIBS
+#include <zstd.h>
+#endif
+
+#ifdef USE_LIBDEFLATE
+#include <libdeflate.h>
+#endif
+
+#include <cstddef>
+#include <vector>
+
+namespace tmx
+{
+    namespace detail
+    {
+        /*!
+        \brief Holds the decompression state used to inflate tile data so
+        that it can be reused by every layer and chunk of a map, rather than
+        being allocated and released for each one.
+        Contexts are not thread safe, each thread uses its own context
+        returned by getThreadContext().
+        */
+        class DecompressionContext final
+        {
+        public:
+            DecompressionContext();
+            ~DecompressionContext();
+
+            DecompressionContext(const DecompressionContext&) = delete;
+            DecompressionContext& operator = (const DecompressionContext&) = delete;
+
+            /*!
+            \brief Returns the context belonging to the calling thread
+            */
+            static DecompressionContext& getThreadContext();
+
+            /*!
+            \brief Starts inflating a new zlib stream. Memory used by previous
+            streams is reused, so once a context has been used no further
+            allocations are made.
+            \param raw If true the stream is raw deflate data with no zlib
+            header or trailer, such as the body of a gzip member
+            \returns nullptr if the stream could not be started
+            */
+            z_stream* beginInflate(bool raw = false);
+
+            /*!
+            \brief Ends the stream started by beginInflate()
+            */
+            void endInflate();
+
+#if defined USE_ZSTD || defined USE_EXTLIBS
+            /*!
+            \brief Returns the zstd context of this context, reset to read
+            a new frame, or nullptr if it could not be created.
+            \param dictionary Dictionary to decompress the frame with,
+            or nullptr to use none
+            */
+            ZSTD_DCtx* beginZstd(const ZSTD_DDict* dictionary);
+#endif
+
+#ifdef USE_LIBDEFLATE
+            /*!
+            \brief Decompresses a whole zlib or gzip stream, detected by its
+            header, in a single call to libdeflate.
+            \param written Set to the number of bytes written to dest
+            \returns LIBDEFLATE_INSUFFICIENT_SPACE if dest is too small for the
+            output, or LIBDEFLATE_BAD_DATA if the data is invalid or does not
+            end with the stream.
+            */
+            libdeflate_result inflateWhole(const unsigned char* source, std::size_t size,
+                unsigned char* dest, std::size_t destSize, std::size_t& written);
+
+            /*!
+            \brief Decompresses a whole zlib or gzip stream, appending the output
+            to dest, which is grown as necessary.
+            \param expectedSize Expected size of the output, if known
+            \returns false if the data could not be decompressed, in which
+            case dest is unchanged
+            */
+            bool inflateWhole(const unsigned char* source, std::size_t size,
+                std::vector<unsigned char>& dest, std::size_t expectedSize);
+
+            /*!
+            \brief Buffers which may be used to hold the input and output of
+            inflateWhole(). Their contents are only valid until the next use.
+            */
+            std::vector<unsigned char>& getInputBuffer() { return m_inputBuffer; }
+            std::vector<unsigned char>& getOutputBuffer() { return m_outputBuffer; }
+
+            /*!
+            \brief Releases the memory held by the buffers if they have grown
+            large, so that one large layer does not keep it for the life
+            of the thread.
+            */
+            void trimBuffers();
+#endif
+
+        private:
+#ifdef USE_EXTLIBS
+            using AllocSize = uInt;
+#else
+            using AllocSize = std::size_t;
+#endif
+            struct Block final
+            {
+                void* data = nullptr;
+                std::size_t size = 0;
+                bool used = false;
+            };
+            std::vector<Block> m_blocks;
+
+            z_stream m_stream;
+            bool m_inflating;
+
+#if defined USE_ZSTD || defined USE_EXTLIBS
+            ZSTD_DCtx* m_zstdContext;
+#endif
+
+#ifdef USE_LIBDEFLATE
+            libdeflate_decompressor* m_deflateDecompressor;
+            std::vector<unsigned char> m_inputBuffer;
+            std::vector<unsigned char> m_outputBuffer;
+#endif
+
+            static void* allocate(void* opaque, AllocSize items, AllocSize size);
+            static void release(void* opaque, void* address);
+        };
+    }
+}
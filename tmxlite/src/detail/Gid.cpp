@@ -0,0 +1,124 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#include "Gid.hpp"
+#include "Simd.hpp"
+
+using namespace tmx::detail;
+
+namespace
+{
+    void unpackScalar(const std::uint32_t* GIDs, std::size_t count, std::uint32_t* IDs, std::uint8_t* flipFlags)
+    {
+        for (auto i = 0u; i < count; ++i)
+        {
+            IDs[i] = GIDs[i] & ~GIDFlagMask;
+            flipFlags[i] = static_cast<std::uint8_t>(GIDs[i] >> 28);
+        }
+    }
+
+#ifdef TMXLITE_SIMD_X86
+    //The flags are shifted down to the bottom of each 32 bit lane then
+    //narrowed to bytes with saturating packs, which leave values from
+    //0 to 15 unchanged.
+
+    TMXLITE_TARGET("sse2")
+    void unpackSSE2(const std::uint32_t* GIDs, std::size_t count, std::uint32_t* IDs, std::uint8_t* flipFlags)
+    {
+        const __m128i mask = _mm_set1_epi32(static_cast<int>(~GIDFlagMask));
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i values[4];
+            for (auto j = 0; j < 4; ++j)
+            {
+                values[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(GIDs + i + j * 4));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(IDs + i + j * 4), _mm_and_si128(values[j], mask));
+                values[j] = _mm_srli_epi32(values[j], 28);
+            }
+
+            const __m128i low = _mm_packs_epi32(values[0], values[1]);
+            const __m128i high = _mm_packs_epi32(values[2], values[3]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(flipFlags + i), _mm_packus_epi16(low, high));
+        }
+        unpackScalar(GIDs + i, count - i, IDs + i, flipFlags + i);
+    }
+
+    TMXLITE_TARGET("avx2")
+    void unpackAVX2(const std::uint32_t* GIDs, std::size_t count, std::uint32_t* IDs, std::uint8_t* flipFlags)
+    {
+        const __m256i mask = _mm256_set1_epi32(static_cast<int>(~GIDFlagMask));
+
+        //the packs work within each 128 bit half, leaving groups of
+        //four flags in the order 0, 2, 4, 6, 1, 3, 5, 7
+        const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+        std::size_t i = 0;
+        for (; i + 32 <= count; i += 32)
+        {
+            __m256i values[4];
+            for (auto j = 0; j < 4; ++j)
+            {
+                values[j] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(GIDs + i + j * 8));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(IDs + i + j * 8), _mm256_and_si256(values[j], mask));
+                values[j] = _mm256_srli_epi32(values[j], 28);
+            }
+
+            const __m256i low = _mm256_packs_epi32(values[0], values[1]);
+            const __m256i high = _mm256_packs_epi32(values[2], values[3]);
+            const __m256i flags = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(low, high), order);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(flipFlags + i), flags);
+        }
+        unpackSSE2(GIDs + i, count - i, IDs + i, flipFlags + i);
+    }
+#endif //TMXLITE_SIMD_X86
+
+    using UnpackFunc = void(*)(const std::uint32_t*, std::size_t, std::uint32_t*, std::uint8_t*);
+
+    UnpackFunc selectUnpacker()
+    {
+#ifdef TMXLITE_SIMD_X86
+        if (cpuSupports(CpuFeature::AVX2))
+        {
+            return unpackAVX2;
+        }
+
+        if (cpuSupports(CpuFeature::SSE2))
+        {
+            return unpackSSE2;
+        }
+#endif
+        return unpackScalar;
+    }
+}
+
+void tmx::detail::unpackGIDs(const std::uint32_t* GIDs, std::size_t count, std::uint32_t* IDs, std::uint8_t* flipFlags)
+{
+    static const UnpackFunc unpacker = selectUnpacker();
+    unpacker(GIDs, count, IDs, flipFlags);
+}
+
+void tmx::detail::unpackGIDsScalar(const std::uint32_t* GIDs, std::size_t count, std::uint32_t* IDs, std::uint8_t* flipFlags)
+{
+    unpackScalar(GIDs, count, IDs, flipFlags);
+}
@@ -0,0 +1,51 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tmx
+{
+    namespace detail
+    {
+        //the top four bits of a GID hold the flip flags of the tile
+        static constexpr std::uint32_t GIDFlagMask = 0xf0000000;
+
+        /*!
+        \brief Splits count GIDs, as stored in a map file, into their
+        tile IDs and flip flags.
+        Blocks of GIDs are split with SSE2 or AVX2 where the CPU supports
+        them, with the same results as the scalar version.
+        */
+        void unpackGIDs(const std::uint32_t* GIDs, std::size_t count, std::uint32_t* IDs, std::uint8_t* flipFlags);
+
+        /*!
+        \brief Splits GIDs as unpackGIDs() does, but always with the
+        scalar version. Used to check the vector versions against.
+        */
+        void unpackGIDsScalar(const std::uint32_t* GIDs, std::size_t count, std::uint32_t* IDs, std::uint8_t* flipFlags);
+    }
+}
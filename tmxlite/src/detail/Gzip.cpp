@@ -0,0 +1,91 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#include "Gzip.hpp"
+
+using namespace tmx::detail;
+
+namespace
+{
+    //tables for slicing by 8, where table[n][i] is the CRC
+    //of byte i followed by n zero bytes
+    struct CrcTables final
+    {
+        std::uint32_t table[8][256];
+
+        CrcTables()
+        {
+            for (auto i = 0u; i < 256; ++i)
+            {
+                auto crc = static_cast<std::uint32_t>(i);
+                for (auto j = 0; j < 8; ++j)
+                {
+                    crc = (crc >> 1) ^ ((crc & 1) ? 0xedb88320u : 0u);
+                }
+                table[0][i] = crc;
+            }
+
+            for (auto i = 0u; i < 256; ++i)
+            {
+                for (auto n = 1u; n < 8; ++n)
+                {
+                    table[n][i] = (table[n - 1][i] >> 8) ^ table[0][table[n - 1][i] & 0xff];
+                }
+            }
+        }
+    };
+
+    const CrcTables& getTables()
+    {
+        static const CrcTables tables;
+        return tables;
+    }
+}
+
+std::uint32_t tmx::detail::gzipCrc32(std::uint32_t crc, const unsigned char* data, std::size_t size)
+{
+    const auto& table = getTables().table;
+    crc = ~crc;
+
+    while (size >= 8)
+    {
+        //bytes are combined explicitly so that this works on any byte order
+        const auto low = crc ^ (static_cast<std::uint32_t>(data[0]) | static_cast<std::uint32_t>(data[1]) << 8
+            | static_cast<std::uint32_t>(data[2]) << 16 | static_cast<std::uint32_t>(data[3]) << 24);
+
+        crc = table[7][low & 0xff] ^ table[6][(low >> 8) & 0xff]
+            ^ table[5][(low >> 16) & 0xff] ^ table[4][low >> 24]
+            ^ table[3][data[4]] ^ table[2][data[5]]
+            ^ table[1][data[6]] ^ table[0][data[7]];
+
+        data += 8;
+        size -= 8;
+    }
+
+    while (size-- != 0)
+    {
+        crc = (crc >> 8) ^ table[0][(crc ^ *data++) & 0xff];
+    }
+    return ~crc;
+}
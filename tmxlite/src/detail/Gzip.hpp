@@ -0,0 +1,147 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tmx
+{
+    namespace detail
+    {
+        //size of the CRC32 and uncompressed size which end a gzip member
+        static constexpr std::size_t GzipTrailerSize = 8;
+
+        //size of the magic number, method, flags, mtime, extra flags and
+        //OS which start every gzip header
+        static constexpr std::size_t GzipFixedHeaderSize = 10;
+
+        /*!
+        \brief Returns true if the data starts with the gzip magic number.
+        The first byte of a zlib header can never be 0x1f, so either may
+        be passed.
+        */
+        inline bool isGzip(const unsigned char* data, std::size_t size)
+        {
+            return size > 1 && data[0] == 0x1f && data[1] == 0x8b;
+        }
+
+        /*!
+        \brief Returns true if the data starts with the fixed size part of
+        a gzip header for a member compressed with deflate, with no
+        reserved flags set.
+        */
+        inline bool checkGzipFixedHeader(const unsigned char* data, std::size_t size)
+        {
+            return size >= GzipFixedHeaderSize && isGzip(data, size)
+                && data[2] == 8 && (data[3] & 0xe0) == 0;
+        }
+
+        /*!
+        \brief Reads the header of a gzip member compressed with deflate.
+        \returns The size of the header, which is followed by raw deflate
+        data, or 0 if the header is invalid or incomplete. A header is only
+        incomplete if checkGzipFixedHeader() is true for the same data.
+        */
+        inline std::size_t readGzipHeader(const unsigned char* data, std::size_t size)
+        {
+            enum Flags
+            {
+                HeaderCRC = 0x2,
+                Extra = 0x4,
+                Name = 0x8,
+                Comment = 0x10
+            };
+
+            if (!checkGzipFixedHeader(data, size))
+            {
+                return 0;
+            }
+            std::size_t position = GzipFixedHeaderSize;
+
+            const auto flags = data[3];
+            if (flags & Extra)
+            {
+                if (size < position + 2)
+                {
+                    return 0;
+                }
+                position += 2 + (data[position] | (data[position + 1] << 8));
+            }
+
+            const auto skipString = [&]()
+            {
+                while (position < size && data[position] != 0)
+                {
+                    position++;
+                }
+                position++;
+            };
+
+            if (flags & Name)
+            {
+                skipString();
+            }
+
+            if (flags & Comment)
+            {
+                skipString();
+            }
+
+            if (flags & HeaderCRC)
+            {
+                position += 2;
+            }
+            return position <= size ? position : 0;
+        }
+
+        /*!
+        \brief Updates a CRC32, as stored in the trailer of a gzip member,
+        with the given data. Pass a crc of 0 to start a new checksum.
+        Eight bytes are processed at a time, where miniz only handles four
+        bits at a time.
+        */
+        std::uint32_t gzipCrc32(std::uint32_t crc, const unsigned char* data, std::size_t size);
+
+        /*!
+        \brief Returns true if the trailer of a gzip member matches the
+        CRC32 and size of the data it was decompressed to.
+        */
+        inline bool checkGzipTrailer(const unsigned char* trailer, std::uint32_t crc, std::uint64_t size)
+        {
+            const auto readValue = [trailer](std::size_t offset)
+            {
+                return static_cast<std::uint32_t>(trailer[offset])
+                    | static_cast<std::uint32_t>(trailer[offset + 1]) << 8
+                    | static_cast<std::uint32_t>(trailer[offset + 2]) << 16
+                    | static_cast<std::uint32_t>(trailer[offset + 3]) << 24;
+            };
+
+            //the size is stored modulo 2^32
+            return readValue(0) == crc
+                && readValue(4) == static_cast<std::uint32_t>(size);
+        }
+    }
+}
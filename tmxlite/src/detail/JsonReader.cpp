@@ -0,0 +1,636 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#include "JsonReader.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+using namespace tmx::detail;
+
+namespace
+{
+    bool isWhitespace(char c)
+    {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    void appendUtf8(std::string& out, std::uint32_t codepoint)
+    {
+        if (codepoint < 0x80)
+        {
+            out.push_back(static_cast<char>(codepoint));
+        }
+        else if (codepoint < 0x800)
+        {
+            out.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+            out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }
+        else if (codepoint < 0x10000)
+        {
+            out.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }
+        else
+        {
+            out.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }
+    }
+
+    bool parseHex4(const char* str, std::uint32_t& out)
+    {
+        out = 0;
+        for (auto i = 0; i < 4; ++i)
+        {
+            char c = str[i];
+            out <<= 4;
+            if (c >= '0' && c <= '9')
+            {
+                out |= static_cast<std::uint32_t>(c - '0');
+            }
+            else if (c >= 'a' && c <= 'f')
+            {
+                out |= static_cast<std::uint32_t>(c - 'a' + 10);
+            }
+            else if (c >= 'A' && c <= 'F')
+            {
+                out |= static_cast<std::uint32_t>(c - 'A' + 10);
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+JsonValue::JsonValue()
+    : m_node    (),
+    m_tree      (nullptr)
+{
+
+}
+
+JsonValue::~JsonValue()
+{
+    clear();
+}
+
+void JsonValue::clear()
+{
+    if (m_tree)
+    {
+        cJSON_Delete(m_tree);
+        m_tree = nullptr;
+    }
+    std::memset(&m_node, 0, sizeof(m_node));
+}
+
+JsonReader::JsonReader(const char* data, std::size_t size)
+    : m_data    (data),
+    m_size      (size),
+    m_position  (0),
+    m_error     (data == nullptr)
+{
+    //skip any UTF-8 byte order mark
+    if (m_size >= 3 && std::memcmp(m_data, "\xEF\xBB\xBF", 3) == 0)
+    {
+        m_position = 3;
+    }
+}
+
+//public
+JsonReader::Type JsonReader::peek()
+{
+    skipWhitespace();
+    if (m_error || m_position >= m_size)
+    {
+        return Type::Invalid;
+    }
+
+    switch (m_data[m_position])
+    {
+    default:
+        if (m_data[m_position] == '-' || (m_data[m_position] >= '0' && m_data[m_position] <= '9'))
+        {
+            return Type::Number;
+        }
+        return Type::Invalid;
+    case '{': return Type::Object;
+    case '[': return Type::Array;
+    case '"': return Type::String;
+    case 't': return Type::True;
+    case 'f': return Type::False;
+    case 'n': return Type::Null;
+    }
+}
+
+bool JsonReader::beginObject()
+{
+    return expect('{');
+}
+
+bool JsonReader::nextKey()
+{
+    skipWhitespace();
+    if (m_error || m_position >= m_size)
+    {
+        return fail();
+    }
+
+    if (m_data[m_position] == ',')
+    {
+        m_position++;
+        skipWhitespace();
+    }
+
+    if (m_position < m_size && m_data[m_position] == '}')
+    {
+        m_position++;
+        return false;
+    }
+
+    m_key.clear();
+    if (!readStringInto(m_key))
+    {
+        return false;
+    }
+    return expect(':');
+}
+
+bool JsonReader::beginArray()
+{
+    return expect('[');
+}
+
+bool JsonReader::nextElement()
+{
+    skipWhitespace();
+    if (m_error || m_position >= m_size)
+    {
+        return fail();
+    }
+
+    if (m_data[m_position] == ',')
+    {
+        m_position++;
+        skipWhitespace();
+    }
+
+    if (m_position < m_size && m_data[m_position] == ']')
+    {
+        m_position++;
+        return false;
+    }
+    return m_position < m_size;
+}
+
+bool JsonReader::readString(std::string& out)
+{
+    out.clear();
+    skipWhitespace();
+    return readStringInto(out);
+}
+
+bool JsonReader::readNumber(double& out)
+{
+    std::size_t start = 0, length = 0;
+    if (!numberSpan(start, length))
+    {
+        return false;
+    }
+
+    //strtod() needs a terminated string, and the buffer may not be
+    char buffer[64];
+    if (length >= sizeof(buffer))
+    {
+        return fail();
+    }
+    std::memcpy(buffer, m_data + start, length);
+    buffer[length] = 0;
+    out = std::strtod(buffer, nullptr);
+    return true;
+}
+
+bool JsonReader::readBool(bool& out)
+{
+    skipWhitespace();
+    if (m_size - m_position >= 4 && std::memcmp(m_data + m_position, "true", 4) == 0)
+    {
+        m_position += 4;
+        out = true;
+        return true;
+    }
+
+    if (m_size - m_position >= 5 && std::memcmp(m_data + m_position, "false", 5) == 0)
+    {
+        m_position += 5;
+        out = false;
+        return true;
+    }
+    return fail();
+}
+
+bool JsonReader::readUnsigned(std::uint32_t& out)
+{
+    skipWhitespace();
+    std::uint64_t value = 0;
+    std::size_t i = m_position;
+    while (i < m_size && m_data[i] >= '0' && m_data[i] <= '9')
+    {
+        value = value * 10 + static_cast<std::uint64_t>(m_data[i] - '0');
+        if (value > std::numeric_limits<std::uint32_t>::max())
+        {
+            break;
+        }
+        i++;
+    }
+
+    //fall back to a double for anything which isn't a plain integer
+    if (i == m_position || (i < m_size && (m_data[i] == '.' || m_data[i] == 'e' || m_data[i] == 'E' || (m_data[i] >= '0' && m_data[i] <= '9'))))
+    {
+        double d = 0.0;
+        if (!readNumber(d))
+        {
+            return false;
+        }
+        if (d <= 0.0)
+        {
+            out = 0;
+        }
+        else if (d >= static_cast<double>(std::numeric_limits<std::uint32_t>::max()))
+        {
+            out = std::numeric_limits<std::uint32_t>::max();
+        }
+        else
+        {
+            out = static_cast<std::uint32_t>(d);
+        }
+        return true;
+    }
+
+    m_position = i;
+    out = static_cast<std::uint32_t>(value);
+    return true;
+}
+
+bool JsonReader::skipValue()
+{
+    switch (peek())
+    {
+    default:
+    case Type::Invalid:
+        return fail();
+    case Type::String:
+        return skipString();
+    case Type::Number:
+    {
+        std::size_t start = 0, length = 0;
+        return numberSpan(start, length);
+    }
+    case Type::True:
+    case Type::False:
+    {
+        bool b = false;
+        return readBool(b);
+    }
+    case Type::Null:
+        if (m_size - m_position >= 4 && std::memcmp(m_data + m_position, "null", 4) == 0)
+        {
+            m_position += 4;
+            return true;
+        }
+        return fail();
+    case Type::Object:
+    case Type::Array:
+        break;
+    }
+
+    //containers are skipped by tracking depth rather than recursing
+    std::size_t depth = 0;
+    while (m_position < m_size)
+    {
+        char c = m_data[m_position];
+        if (c == '"')
+        {
+            if (!skipString())
+            {
+                return false;
+            }
+            continue;
+        }
+
+        m_position++;
+        if (c == '{' || c == '[')
+        {
+            depth++;
+        }
+        else if (c == '}' || c == ']')
+        {
+            if (--depth == 0)
+            {
+                return true;
+            }
+        }
+    }
+    return fail();
+}
+
+bool JsonReader::readValue(JsonValue& out, const char* name)
+{
+    out.clear();
+    auto& node = out.m_node;
+
+    switch (peek())
+    {
+    default:
+    case Type::Invalid:
+        return fail();
+    case Type::String:
+        if (!readString(out.m_string))
+        {
+            return false;
+        }
+        node.type = cJSON_String;
+        node.valuestring = &out.m_string[0];
+        break;
+    case Type::Number:
+    {
+        double value = 0.0;
+        if (!readNumber(value))
+        {
+            return false;
+        }
+        node.type = cJSON_Number;
+        node.valuedouble = value;
+        if (value >= std::numeric_limits<int>::max())
+        {
+            node.valueint = std::numeric_limits<int>::max();
+        }
+        else if (value <= std::numeric_limits<int>::min())
+        {
+            node.valueint = std::numeric_limits<int>::min();
+        }
+        else
+        {
+            node.valueint = static_cast<int>(value);
+        }
+    }
+        break;
+    case Type::True:
+    case Type::False:
+    {
+        bool value = false;
+        if (!readBool(value))
+        {
+            return false;
+        }
+        node.type = value ? cJSON_True : cJSON_False;
+        node.valueint = value ? 1 : 0;
+    }
+        break;
+    case Type::Null:
+        if (!skipValue())
+        {
+            return false;
+        }
+        node.type = cJSON_NULL;
+        break;
+    case Type::Object:
+    case Type::Array:
+    {
+        //nested values are small (properties, points, text...) so
+        //these are handed to cJSON a single value at a time
+        std::size_t start = m_position;
+        if (!skipValue())
+        {
+            return false;
+        }
+        out.m_tree = cJSON_ParseWithLength(m_data + start, m_position - start);
+        if (!out.m_tree)
+        {
+            return fail();
+        }
+        out.m_tree->string = const_cast<char*>(name);
+        out.m_tree->type |= cJSON_StringIsConst;
+        return true;
+    }
+    }
+
+    node.string = const_cast<char*>(name);
+    node.type |= cJSON_StringIsConst;
+    return true;
+}
+
+bool JsonReader::findValue(const char* key, JsonValue& out)
+{
+    auto start = m_position;
+    auto savedKey = m_key;
+
+    bool found = false;
+    if (beginObject())
+    {
+        while (nextKey())
+        {
+            if (m_key == key)
+            {
+                found = readValue(out, key);
+                break;
+            }
+
+            if (!skipValue())
+            {
+                break;
+            }
+        }
+    }
+
+    setPosition(start);
+    m_key = savedKey;
+    return found;
+}
+
+//private
+void JsonReader::skipWhitespace()
+{
+    while (m_position < m_size && isWhitespace(m_data[m_position]))
+    {
+        m_position++;
+    }
+}
+
+bool JsonReader::expect(char c)
+{
+    skipWhitespace();
+    if (m_error || m_position >= m_size || m_data[m_position] != c)
+    {
+        return fail();
+    }
+    m_position++;
+    return true;
+}
+
+bool JsonReader::fail()
+{
+    m_error = true;
+    return false;
+}
+
+bool JsonReader::readStringInto(std::string& out)
+{
+    if (m_error || m_position >= m_size || m_data[m_position] != '"')
+    {
+        return fail();
+    }
+    m_position++;
+
+    while (m_position < m_size)
+    {
+        //copy runs of plain characters in one go
+        auto runStart = m_position;
+        while (m_position < m_size && m_data[m_position] != '"' && m_data[m_position] != '\\')
+        {
+            m_position++;
+        }
+        out.append(m_data + runStart, m_position - runStart);
+
+        if (m_position >= m_size)
+        {
+            break;
+        }
+
+        if (m_data[m_position] == '"')
+        {
+            m_position++;
+            return true;
+        }
+
+        //escape sequence
+        m_position++;
+        if (m_position >= m_size)
+        {
+            break;
+        }
+
+        char c = m_data[m_position++];
+        switch (c)
+        {
+        default: return fail();
+        case '"': out.push_back('"'); break;
+        case '\\': out.push_back('\\'); break;
+        case '/': out.push_back('/'); break;
+        case 'b': out.push_back('\b'); break;
+        case 'f': out.push_back('\f'); break;
+        case 'n': out.push_back('\n'); break;
+        case 'r': out.push_back('\r'); break;
+        case 't': out.push_back('\t'); break;
+        case 'u':
+        {
+            std::uint32_t codepoint = 0;
+            if (m_size - m_position < 4 || !parseHex4(m_data + m_position, codepoint))
+            {
+                return fail();
+            }
+            m_position += 4;
+
+            //surrogate pair
+            if (codepoint >= 0xD800 && codepoint <= 0xDBFF)
+            {
+                std::uint32_t low = 0;
+                if (m_size - m_position < 6 || m_data[m_position] != '\\' || m_data[m_position + 1] != 'u'
+                    || !parseHex4(m_data + m_position + 2, low)
+                    || low < 0xDC00 || low > 0xDFFF)
+                {
+                    return fail();
+                }
+                m_position += 6;
+                codepoint = 0x10000 + (((codepoint & 0x3FF) << 10) | (low & 0x3FF));
+            }
+            appendUtf8(out, codepoint);
+        }
+            break;
+        }
+    }
+    return fail();
+}
+
+bool JsonReader::skipString()
+{
+    if (m_error || m_position >= m_size || m_data[m_position] != '"')
+    {
+        return fail();
+    }
+    m_position++;
+
+    while (m_position < m_size)
+    {
+        const void* next = std::memchr(m_data + m_position, '"', m_size - m_position);
+        if (!next)
+        {
+            break;
+        }
+
+        auto quote = static_cast<std::size_t>(static_cast<const char*>(next) - m_data);
+
+        //count the backslashes preceding the quote to see if it is escaped
+        std::size_t slashes = 0;
+        while (quote - slashes > m_position && m_data[quote - slashes - 1] == '\\')
+        {
+            slashes++;
+        }
+
+        m_position = quote + 1;
+        if ((slashes % 2) == 0)
+        {
+            return true;
+        }
+    }
+    return fail();
+}
+
+bool JsonReader::numberSpan(std::size_t& start, std::size_t& length)
+{
+    skipWhitespace();
+    start = m_position;
+    while (m_position < m_size)
+    {
+        char c = m_data[m_position];
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')
+        {
+            m_position++;
+        }
+        else
+        {
+            break;
+        }
+    }
+    length = m_position - start;
+    return length != 0 || fail();
+}
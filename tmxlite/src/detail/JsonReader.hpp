@@ -0,0 +1,186 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#ifdef USE_EXTLIBS
+#include <cJSON/cJSON.h>
+#else
+#include "cJSON.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace tmx
+{
+    namespace detail
+    {
+        /*!
+        \brief Returns true if the node holds a JSON true value, or the
+        string "true" as used by the XML style attributes.
+        */
+        inline bool isTrue(const cJSON& node)
+        {
+            return (node.type & 0xFF) == cJSON_True
+                || (node.valuestring != nullptr && std::strcmp(node.valuestring, "true") == 0);
+        }
+
+        /*!
+        \brief Holds a single value read by JsonReader::readValue() in the
+        form of a cJSON node, so that it can be handed to the existing
+        cJSON based parsing functions.
+        Scalar values are stored in place without allocating a tree. Objects
+        and arrays are parsed into a small cJSON tree which is released when
+        the next value is read, or when the JsonValue is destroyed.
+        */
+        class JsonValue final
+        {
+        public:
+            JsonValue();
+            ~JsonValue();
+
+            JsonValue(const JsonValue&) = delete;
+            JsonValue& operator = (const JsonValue&) = delete;
+
+            const cJSON& get() const { return m_tree ? *m_tree : m_node; }
+
+        private:
+            friend class JsonReader;
+
+            cJSON m_node;
+            cJSON* m_tree;
+            std::string m_string;
+
+            void clear();
+        };
+
+        /*!
+        \brief Pull style tokenizer which reads a JSON document directly
+        from a buffer without building a document tree.
+        The buffer does not need to be null terminated, and must outlive
+        the reader. Keys returned by getKey() are only valid until the
+        next call to nextKey().
+        */
+        class JsonReader final
+        {
+        public:
+            enum class Type
+            {
+                Object,
+                Array,
+                String,
+                Number,
+                True,
+                False,
+                Null,
+                Invalid
+            };
+
+            JsonReader(const char* data, std::size_t size);
+
+            /*!
+            \brief Returns the type of the next value without consuming it
+            */
+            Type peek();
+
+            /*!
+            \brief Consumes the opening brace of an object
+            */
+            bool beginObject();
+
+            /*!
+            \brief Reads the next key of the current object, including the
+            following colon. Returns false once the closing brace has been
+            consumed, or if an error occurred.
+            */
+            bool nextKey();
+
+            const std::string& getKey() const { return m_key; }
+
+            /*!
+            \brief Consumes the opening bracket of an array
+            */
+            bool beginArray();
+
+            /*!
+            \brief Moves to the next element of the current array. Returns
+            false once the closing bracket has been consumed, or if an error
+            occurred.
+            */
+            bool nextElement();
+
+            bool readString(std::string& out);
+            bool readNumber(double& out);
+            bool readBool(bool& out);
+
+            /*!
+            \brief Reads an unsigned 32 bit integer, such as a tile GID.
+            Plain integers are read without going through a double.
+            */
+            bool readUnsigned(std::uint32_t& out);
+
+            /*!
+            \brief Skips the next value, including any nested values
+            */
+            bool skipValue();
+
+            /*!
+            \brief Reads the next value into the given JsonValue.
+            \param name Name given to the resulting node, usually the
+            current key. Array elements are unnamed and should pass nullptr.
+            */
+            bool readValue(JsonValue& out, const char* name);
+
+            /*!
+            \brief Searches the keys of the object starting at the current
+            position for the given key and reads its value.
+            The reader position is left unchanged.
+            \returns false if the key was not found
+            */
+            bool findValue(const char* key, JsonValue& out);
+
+            std::size_t getPosition() const { return m_position; }
+            void setPosition(std::size_t position) { m_position = position; m_error = false; }
+
+            bool failed() const { return m_error; }
+
+        private:
+            const char* m_data;
+            std::size_t m_size;
+            std::size_t m_position;
+            bool m_error;
+            std::string m_key;
+
+            void skipWhitespace();
+            bool expect(char c);
+            bool fail();
+            bool readStringInto(std::string& out);
+            bool skipString();
+            bool numberSpan(std::size_t& start, std::size_t& length);
+        };
+    }
+}
@@ -0,0 +1,72 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#include "Keys.hpp"
+
+using namespace tmx::detail;
+
+namespace
+{
+    //FNV-1a, usable in constant expressions so that it can
+    //be used for case labels
+    constexpr std::uint32_t hashKey(const char* str, std::size_t length)
+    {
+        std::uint32_t hash = 2166136261u;
+        for (auto i = 0u; i < length; ++i)
+        {
+            hash ^= static_cast<unsigned char>(str[i]);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    template <std::size_t N>
+    constexpr std::uint32_t hashKey(const char (&str)[N])
+    {
+        return hashKey(str, N - 1);
+    }
+
+    template <std::size_t N>
+    bool matchKey(const char* str, std::size_t length, const char (&key)[N])
+    {
+        return length == N - 1 && std::memcmp(str, key, N - 1) == 0;
+    }
+}
+
+Key tmx::detail::classifyKey(const char* str, std::size_t length)
+{
+    //two keys with the same hash will fail to compile here with
+    //a duplicate case value, rather than silently mismatching
+    switch (hashKey(str, length))
+    {
+    default:
+        return Key::Unknown;
+#define TMXLITE_KEY_CASE(key, name) \
+    case hashKey(name): \
+        return matchKey(str, length, name) ? Key::key : Key::Unknown;
+    TMXLITE_KEYS(TMXLITE_KEY_CASE)
+#undef TMXLITE_KEY_CASE
+    }
+}
@@ -0,0 +1,162 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+/*
+List of the JSON keys recognised by the parser, as (Key, "key") pairs.
+Add new keys here, the Key enum and classifyKey() are generated from it.
+*/
+#define TMXLITE_KEYS(ENTRY) \
+    ENTRY(Animation, "animation") \
+    ENTRY(BackgroundColour, "backgroundcolor") \
+    ENTRY(Bold, "bold") \
+    ENTRY(Chunks, "chunks") \
+    ENTRY(Class, "class") \
+    ENTRY(Colour, "color") \
+    ENTRY(Columns, "columns") \
+    ENTRY(Compression, "compression") \
+    ENTRY(CompressionLevel, "compressionlevel") \
+    ENTRY(Data, "data") \
+    ENTRY(Default, "default") \
+    ENTRY(DrawOrder, "draworder") \
+    ENTRY(Duration, "duration") \
+    ENTRY(Ellipse, "ellipse") \
+    ENTRY(Encoding, "encoding") \
+    ENTRY(FirstGID, "firstgid") \
+    ENTRY(FontFamily, "fontfamily") \
+    ENTRY(GID, "gid") \
+    ENTRY(HAlign, "halign") \
+    ENTRY(Height, "height") \
+    ENTRY(HexSideLength, "hexsidelength") \
+    ENTRY(ID, "id") \
+    ENTRY(Image, "image") \
+    ENTRY(ImageHeight, "imageheight") \
+    ENTRY(ImageWidth, "imagewidth") \
+    ENTRY(Infinite, "infinite") \
+    ENTRY(Italic, "italic") \
+    ENTRY(Kerning, "kerning") \
+    ENTRY(Layers, "layers") \
+    ENTRY(Margin, "margin") \
+    ENTRY(Name, "name") \
+    ENTRY(NextLayerID, "nextlayerid") \
+    ENTRY(NextObjectID, "nextobjectid") \
+    ENTRY(Object, "object") \
+    ENTRY(ObjectAlignment, "objectalignment") \
+    ENTRY(ObjectGroup, "objectgroup") \
+    ENTRY(Objects, "objects") \
+    ENTRY(OffsetX, "offsetx") \
+    ENTRY(OffsetY, "offsety") \
+    ENTRY(Opacity, "opacity") \
+    ENTRY(Orientation, "orientation") \
+    ENTRY(ParallaxOriginX, "parallaxoriginx") \
+    ENTRY(ParallaxOriginY, "parallaxoriginy") \
+    ENTRY(ParallaxX, "parallaxx") \
+    ENTRY(ParallaxY, "parallaxy") \
+    ENTRY(PixelSize, "pixelsize") \
+    ENTRY(Point, "point") \
+    ENTRY(Polygon, "polygon") \
+    ENTRY(Polyline, "polyline") \
+    ENTRY(Probability, "probability") \
+    ENTRY(Properties, "properties") \
+    ENTRY(PropertyType, "propertytype") \
+    ENTRY(RenderOrder, "renderorder") \
+    ENTRY(RepeatX, "repeatx") \
+    ENTRY(RepeatY, "repeaty") \
+    ENTRY(Rotation, "rotation") \
+    ENTRY(Source, "source") \
+    ENTRY(Spacing, "spacing") \
+    ENTRY(StaggerAxis, "staggeraxis") \
+    ENTRY(StaggerIndex, "staggerindex") \
+    ENTRY(StartX, "startx") \
+    ENTRY(StartY, "starty") \
+    ENTRY(Strikeout, "strikeout") \
+    ENTRY(Template, "template") \
+    ENTRY(Terrain, "terrain") \
+    ENTRY(TerrainTypes, "terraintypes") \
+    ENTRY(Text, "text") \
+    ENTRY(Tile, "tile") \
+    ENTRY(TileCount, "tilecount") \
+    ENTRY(TiledVersion, "tiledversion") \
+    ENTRY(TileHeight, "tileheight") \
+    ENTRY(TileID, "tileid") \
+    ENTRY(TileOffset, "tileoffset") \
+    ENTRY(Tiles, "tiles") \
+    ENTRY(Tileset, "tileset") \
+    ENTRY(Tilesets, "tilesets") \
+    ENTRY(TileWidth, "tilewidth") \
+    ENTRY(TintColor, "tintcolor") \
+    ENTRY(TintColour, "tintcolour") \
+    ENTRY(TransparentColour, "transparentcolor") \
+    ENTRY(Type, "type") \
+    ENTRY(Underline, "underline") \
+    ENTRY(VAlign, "valign") \
+    ENTRY(Value, "value") \
+    ENTRY(Version, "version") \
+    ENTRY(Visible, "visible") \
+    ENTRY(Width, "width") \
+    ENTRY(Wrap, "wrap") \
+    ENTRY(X, "x") \
+    ENTRY(Y, "y")
+
+namespace tmx
+{
+    namespace detail
+    {
+        /*!
+        \brief Identifies a JSON key, so that parsing functions can switch
+        on a key instead of comparing it against each possible name.
+        \see classifyKey()
+        */
+        enum class Key : std::uint16_t
+        {
+            Unknown,
+#define TMXLITE_KEY_ENUM(key, name) key,
+            TMXLITE_KEYS(TMXLITE_KEY_ENUM)
+#undef TMXLITE_KEY_ENUM
+        };
+
+        /*!
+        \brief Returns the Key matching the given string, or Key::Unknown.
+        The string does not need to be null terminated.
+        */
+        Key classifyKey(const char* str, std::size_t length);
+
+        inline Key classifyKey(const char* str)
+        {
+            return str ? classifyKey(str, std::strlen(str)) : Key::Unknown;
+        }
+
+        inline Key classifyKey(const std::string& str)
+        {
+            return classifyKey(str.data(), str.size());
+        }
+    }
+}
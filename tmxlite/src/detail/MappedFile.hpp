@@ -0,0 +1,69 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace tmx
+{
+    namespace detail
+    {
+        /*!
+        \brief Maps the contents of a file into memory as read only.
+        The mapping is released when the MappedFile is destroyed.
+        */
+        class MappedFile final
+        {
+        public:
+            MappedFile();
+            ~MappedFile();
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator = (const MappedFile&) = delete;
+
+            /*!
+            \brief Attempts to map the file at the given path.
+            \returns false if the file could not be opened or mapped.
+            Empty files are opened successfully, with a size of zero.
+            */
+            bool open(const std::string& path);
+
+            void close();
+
+            const char* getData() const { return m_data; }
+            std::size_t getSize() const { return m_size; }
+
+        private:
+            const char* m_data;
+            std::size_t m_size;
+#ifdef _WIN32
+            void* m_file;
+            void* m_mapping;
+#endif
+        };
+    }
+}
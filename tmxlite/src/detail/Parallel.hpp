@@ -0,0 +1,93 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace tmx
+{
+    namespace detail
+    {
+        /*!
+        \brief Returns the number of threads to use for a requested
+        count, where 0 selects one per hardware thread.
+        */
+        inline std::size_t resolveThreadCount(std::size_t count)
+        {
+            if (count == 0)
+            {
+                count = std::max(1u, std::thread::hardware_concurrency());
+            }
+            return count;
+        }
+
+        /*!
+        \brief Calls func(i) for every i in [0, count), sharing the calls
+        between up to threadCount threads including the calling thread.
+        Returns once every call has completed. Calls are handed out in
+        order, so longer tasks should be placed first where possible.
+        */
+        template <typename Func>
+        void parallelFor(std::size_t count, std::size_t threadCount, Func&& func)
+        {
+            threadCount = std::min(resolveThreadCount(threadCount), count);
+            if (threadCount < 2)
+            {
+                for (auto i = 0u; i < count; ++i)
+                {
+                    func(i);
+                }
+                return;
+            }
+
+            std::atomic<std::size_t> next(0);
+            auto worker = [&]()
+            {
+                for (auto i = next++; i < count; i = next++)
+                {
+                    func(i);
+                }
+            };
+
+            std::vector<std::thread> threads;
+            threads.reserve(threadCount - 1);
+            for (auto i = 1u; i < threadCount; ++i)
+            {
+                threads.emplace_back(worker);
+            }
+            worker();
+
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+        }
+    }
+}
@@ -0,0 +1,85 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#include "Simd.hpp"
+
+#if defined(TMXLITE_SIMD_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+bool tmx::detail::cpuSupports(CpuFeature feature)
+{
+#ifdef TMXLITE_SIMD_X86
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    if (maxLeaf < 1)
+    {
+        return false;
+    }
+
+    __cpuid(info, 1);
+    const bool sse2 = (info[3] & (1 << 26)) != 0;
+    const bool sse41 = (info[2] & (1 << 19)) != 0;
+    switch (feature)
+    {
+    default:
+    case CpuFeature::SSE2:
+        return sse2;
+    case CpuFeature::SSE41:
+        return sse41;
+    case CpuFeature::AVX2:
+        break;
+    }
+
+    //AVX state must also be enabled by the OS
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!sse41 || !osxsave || !avx || maxLeaf < 7
+        || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    switch (feature)
+    {
+    default:
+    case CpuFeature::SSE2:
+        return __builtin_cpu_supports("sse2") != 0;
+    case CpuFeature::SSE41:
+        return __builtin_cpu_supports("sse4.1") != 0;
+    case CpuFeature::AVX2:
+        return __builtin_cpu_supports("avx2") != 0;
+    }
+#endif
+#else
+    (void)feature;
+    return false;
+#endif
+}
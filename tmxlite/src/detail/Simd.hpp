@@ -0,0 +1,58 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#if !defined(TMXLITE_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+#define TMXLITE_SIMD_X86
+#include <immintrin.h>
+#endif
+
+//allows functions to use instructions beyond those the file is compiled for,
+//so that they can be selected at run time with cpuSupports()
+#if defined(__GNUC__) || defined(__clang__)
+#define TMXLITE_TARGET(x) __attribute__((target(x)))
+#else
+#define TMXLITE_TARGET(x)
+#endif
+
+namespace tmx
+{
+    namespace detail
+    {
+        enum class CpuFeature
+        {
+            SSE2,
+            SSE41,
+            AVX2
+        };
+
+        /*!
+        \brief Returns true if the CPU, and for AVX2 the OS, supports the
+        given feature. Always false when not compiled for x86, or when
+        TMXLITE_NO_SIMD is defined.
+        */
+        bool cpuSupports(CpuFeature feature);
+    }
+}
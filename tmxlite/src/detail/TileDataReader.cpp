@@ -0,0 +1,624 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#include <tmxlite/detail/Log.hpp>
+#include "Base64.hpp"
+#include "TileDataReader.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace tmx;
+using namespace tmx::detail;
+
+constexpr std::size_t TileDataReader::BlockSize;
+
+TileDataReader::TileDataReader(const char* data, std::size_t length, TileLayer::CompressionType compression,
+    const ZstdDictionary* dictionary, std::size_t expectedCount)
+    : m_data        (data),
+    m_length        (length),
+    m_compression   (compression),
+    m_expectedCount (expectedCount),
+    m_sourceEnd     (false),
+    m_started       (false),
+    m_finished      (false),
+    m_error         (false),
+    m_inputBegin    (0),
+    m_inputEnd      (0),
+    m_context       (DecompressionContext::getThreadContext()),
+    m_inflateStream (nullptr),
+    m_gzip          (false),
+    m_crc           (0),
+    m_outputSize    (0),
+    m_tailSize      (0)
+#ifdef USE_LIBDEFLATE
+    , m_output      (nullptr),
+    m_outputBegin   (0),
+    m_outputEnd     (0)
+#endif
+#if defined USE_ZSTD || defined USE_EXTLIBS
+    , m_zstdContext (nullptr),
+    m_zstdDictionary(dictionary != nullptr ? dictionary->m_dictionary : nullptr)
+#endif
+{
+    //skip any whitespace preceding the data, decoding stops at the first
+    //whitespace or padding character following it
+    while (m_length != 0 && std::isspace(static_cast<unsigned char>(*m_data)))
+    {
+        m_data++;
+        m_length--;
+    }
+
+    switch (m_compression)
+    {
+    default:
+    case TileLayer::CompressionType::None:
+        break;
+    case TileLayer::CompressionType::Zstd:
+#if defined USE_ZSTD || defined USE_EXTLIBS
+        m_zstdContext = m_context.beginZstd(m_zstdDictionary);
+        if (m_zstdContext == nullptr)
+        {
+            Logger::log("Failed to create Zstd decompression context", Logger::Type::Error);
+            fail();
+        }
+#else
+        (void)dictionary;
+        Logger::log("Library must be built with USE_EXTLIBS or USE_ZSTD for Zstd compression", Logger::Type::Error);
+        fail();
+#endif
+        break;
+    case TileLayer::CompressionType::GZip:
+    case TileLayer::CompressionType::Zlib:
+        //streams are started by the first read, once the
+        //header has been decoded
+        break;
+    }
+}
+
+TileDataReader::~TileDataReader()
+{
+    if (m_inflateStream != nullptr)
+    {
+        m_context.endInflate();
+    }
+
+#ifdef USE_LIBDEFLATE
+    if (m_output != nullptr)
+    {
+        m_context.trimBuffers();
+    }
+#endif
+}
+
+//public
+std::size_t TileDataReader::read(std::uint32_t* dest, std::size_t count)
+{
+    //the bytes are read into the destination then converted in place,
+    //so that no intermediate buffer is needed
+    auto* bytes = reinterpret_cast<unsigned char*>(dest);
+    const auto size = readBytes(bytes, count * 4);
+
+    //data stream is in bytes so we need to OR into 32 bit values,
+    //ignoring any incomplete value at the end
+    const auto readCount = size / 4;
+    for (auto i = 0u; i < readCount; ++i)
+    {
+        const auto* b = bytes + i * 4;
+        dest[i] = static_cast<std::uint32_t>(b[0]) | static_cast<std::uint32_t>(b[1]) << 8
+            | static_cast<std::uint32_t>(b[2]) << 16 | static_cast<std::uint32_t>(b[3]) << 24;
+    }
+    return readCount;
+}
+
+//private
+bool TileDataReader::fillInput()
+{
+    if (m_inputBegin != m_inputEnd)
+    {
+        return true;
+    }
+
+    if (m_sourceEnd)
+    {
+        return false;
+    }
+
+    const auto length = std::min(m_length, BlockSize);
+    const auto size = base64Decode(m_data, length, m_input);
+    m_data += length;
+    m_length -= length;
+
+    //decoding stops early at padding or any other invalid character
+    if (m_length == 0 || size < (length / 4) * 3)
+    {
+        m_sourceEnd = true;
+    }
+
+    m_inputBegin = 0;
+    m_inputEnd = size;
+    return size != 0;
+}
+
+std::size_t TileDataReader::readBytes(unsigned char* dest, std::size_t size)
+{
+    if (m_error || m_finished)
+    {
+        return 0;
+    }
+
+    switch (m_compression)
+    {
+    default:
+    case TileLayer::CompressionType::None:
+        break;
+    case TileLayer::CompressionType::GZip:
+    case TileLayer::CompressionType::Zlib:
+#ifdef USE_LIBDEFLATE
+        if (!m_started)
+        {
+            m_started = true;
+            return inflateLibdeflate(dest, size);
+        }
+        return readOutput(dest, size);
+#else
+        if (!m_started)
+        {
+            m_started = true;
+            if (!beginInflate())
+            {
+                return 0;
+            }
+
+            std::size_t written = 0;
+            if (inflateWhole(dest, size, written))
+            {
+                return written;
+            }
+        }
+        return inflateBytes(dest, size);
+#endif
+    case TileLayer::CompressionType::Zstd:
+        if (!m_started)
+        {
+            m_started = true;
+            std::size_t written = 0;
+            if (decompressZstdWhole(dest, size, written))
+            {
+                return written;
+            }
+        }
+        return decompressZstd(dest, size);
+    }
+
+    std::size_t written = 0;
+    while (written < size && fillInput())
+    {
+        const auto count = std::min(size - written, m_inputEnd - m_inputBegin);
+        std::memcpy(dest + written, m_input + m_inputBegin, count);
+        m_inputBegin += count;
+        written += count;
+    }
+
+    if (written < size)
+    {
+        m_finished = true;
+    }
+    return written;
+}
+
+bool TileDataReader::beginInflate()
+{
+    //gzip members are a header followed by raw deflate data, which
+    //is read here as miniz has no support for gzip
+    if (fillInput() && isGzip(m_input + m_inputBegin, m_inputEnd - m_inputBegin))
+    {
+        if (!skipGzipHeader())
+        {
+            LOG("gzip decompression failed, the header is invalid.", Logger::Type::Error);
+            fail();
+            return false;
+        }
+        m_gzip = true;
+    }
+
+    m_inflateStream = m_context.beginInflate(m_gzip);
+    if (m_inflateStream == nullptr)
+    {
+        LOG("inflate init failed", Logger::Type::Error);
+        fail();
+        return false;
+    }
+    return true;
+}
+
+bool TileDataReader::skipGzipHeader()
+{
+    const auto headerSize = readGzipHeader(m_input + m_inputBegin, m_inputEnd - m_inputBegin);
+    if (headerSize != 0)
+    {
+        m_inputBegin += headerSize;
+        return true;
+    }
+
+    //the optional extra field, name and comment can make the header
+    //larger than the input window, in which case it is gathered from
+    //as many windows as it takes
+    std::vector<unsigned char> header(m_input + m_inputBegin, m_input + m_inputEnd);
+    m_inputBegin = m_inputEnd;
+
+    while ((header.size() < GzipFixedHeaderSize || checkGzipFixedHeader(header.data(), header.size()))
+        && fillInput())
+    {
+        header.insert(header.end(), m_input + m_inputBegin, m_input + m_inputEnd);
+
+        const auto size = readGzipHeader(header.data(), header.size());
+        if (size != 0)
+        {
+            //the header was incomplete without this window,
+            //so the deflate data starts somewhere within it
+            m_inputBegin = m_inputEnd - (header.size() - size);
+            return true;
+        }
+        m_inputBegin = m_inputEnd;
+    }
+    return false;
+}
+
+std::size_t TileDataReader::inflateBytes(unsigned char* dest, std::size_t size)
+{
+    auto& stream = *m_inflateStream;
+    stream.next_out = dest;
+    stream.avail_out = static_cast<unsigned int>(size);
+
+    while (stream.avail_out != 0)
+    {
+        if (stream.avail_in == 0 && fillInput())
+        {
+            takeInput();
+        }
+
+        const auto result = inflate(&stream, Z_NO_FLUSH);
+        if (result == Z_STREAM_END)
+        {
+            const auto written = size - stream.avail_out;
+            return endInflate(dest, written) ? written : 0;
+        }
+
+        switch (result)
+        {
+        default: break;
+        case Z_BUF_ERROR:
+            //no progress is possible, which with input remaining
+            //means the output is full and is handled by the loop
+            if (stream.avail_in != 0)
+            {
+                break;
+            }
+            LOG("zlib decompression failed, the data ended early.", Logger::Type::Error);
+            fail();
+            return 0;
+        case Z_NEED_DICT:
+        case Z_STREAM_ERROR:
+        case Z_DATA_ERROR:
+        case Z_MEM_ERROR:
+            Logger::log("inflate() returned " + std::to_string(result), Logger::Type::Error);
+            fail();
+            return 0;
+        }
+    }
+
+    updateChecksum(dest, size);
+    return size;
+}
+
+bool TileDataReader::inflateWhole(unsigned char* dest, std::size_t size, std::size_t& written)
+{
+    //when all of the data fits in the input window and the output is large
+    //enough for the tile count it can be inflated with a single Z_FINISH,
+    //which lets miniz write directly to the output rather than through
+    //its dictionary
+    if (!fillInput() || !m_sourceEnd)
+    {
+        return false;
+    }
+
+    auto& stream = *m_inflateStream;
+    const auto inputBegin = m_inputBegin;
+    takeInput();
+    stream.next_out = dest;
+    stream.avail_out = static_cast<unsigned int>(size);
+
+    const auto result = inflate(&stream, Z_FINISH);
+    if (result == Z_STREAM_END)
+    {
+        written = size - stream.avail_out;
+        if (!endInflate(dest, written))
+        {
+            written = 0;
+        }
+        return true;
+    }
+
+    //otherwise start again with a new stream, which reports any error
+    m_inputBegin = inputBegin;
+    m_inflateStream = m_context.beginInflate(m_gzip);
+    if (m_inflateStream == nullptr)
+    {
+        LOG("inflate init failed", Logger::Type::Error);
+        fail();
+        written = 0;
+        return true;
+    }
+    return false;
+}
+
+bool TileDataReader::endInflate(const unsigned char* dest, std::size_t size)
+{
+    //called at the end of the deflate stream with the
+    //output of the current read
+    auto& stream = *m_inflateStream;
+    m_finished = true;
+
+    std::size_t remaining = stream.avail_in;
+    if (m_gzip)
+    {
+        updateChecksum(dest, size);
+
+        //miniz may have read the start of the trailer along with the end of
+        //the stream, so the trailer is taken from the end of the input
+        while (fillInput())
+        {
+            remaining += m_inputEnd - m_inputBegin;
+            keepTail(m_input + m_inputBegin, m_inputEnd - m_inputBegin);
+            m_inputBegin = m_inputEnd;
+        }
+
+        if (remaining <= GzipTrailerSize
+            && (m_tailSize != GzipTrailerSize
+                || !checkGzipTrailer(m_tail, m_crc, m_outputSize)))
+        {
+            LOG("gzip decompression failed, the checksum or size of the data is incorrect.", Logger::Type::Error);
+            fail();
+            return false;
+        }
+    }
+    else if (fillInput())
+    {
+        remaining += m_inputEnd - m_inputBegin;
+    }
+
+    if (remaining > (m_gzip ? GzipTrailerSize : 0))
+    {
+        LOG("zlib decompression failed, found data after the end of the stream.", Logger::Type::Error);
+        fail();
+        return false;
+    }
+    return true;
+}
+
+void TileDataReader::takeInput()
+{
+    auto& stream = *m_inflateStream;
+    stream.next_in = m_input + m_inputBegin;
+    stream.avail_in = static_cast<unsigned int>(m_inputEnd - m_inputBegin);
+    if (m_gzip)
+    {
+        keepTail(m_input + m_inputBegin, m_inputEnd - m_inputBegin);
+    }
+    m_inputBegin = m_inputEnd;
+}
+
+void TileDataReader::keepTail(const unsigned char* data, std::size_t size)
+{
+    //keeps the last GzipTrailerSize bytes passed to the stream
+    if (size >= GzipTrailerSize)
+    {
+        std::memcpy(m_tail, data + size - GzipTrailerSize, GzipTrailerSize);
+        m_tailSize = GzipTrailerSize;
+    }
+    else
+    {
+        std::memmove(m_tail, m_tail + size, GzipTrailerSize - size);
+        std::memcpy(m_tail + GzipTrailerSize - size, data, size);
+        m_tailSize = std::min(m_tailSize + size, GzipTrailerSize);
+    }
+}
+
+void TileDataReader::updateChecksum(const unsigned char* dest, std::size_t size)
+{
+    //zlib streams are checked by inflate() itself
+    if (m_gzip)
+    {
+        m_crc = gzipCrc32(m_crc, dest, size);
+        m_outputSize += size;
+    }
+}
+
+#ifdef USE_LIBDEFLATE
+std::size_t TileDataReader::inflateLibdeflate(unsigned char* dest, std::size_t size)
+{
+    //libdeflate only works on whole buffers, so all of the data is decoded
+    //first then inflated directly into dest if it has room for all of the
+    //expected output, or into the context's buffer otherwise
+    auto& input = m_context.getInputBuffer();
+    input.resize(base64DecodedSize(m_length));
+    input.resize(base64Decode(m_data, m_length, input.data()));
+    m_data += m_length;
+    m_length = 0;
+    m_sourceEnd = true;
+
+    const auto expectedSize = m_expectedCount * 4;
+    auto outputSize = expectedSize;
+    if (size >= expectedSize)
+    {
+        std::size_t written = 0;
+        const auto result = m_context.inflateWhole(input.data(), input.size(), dest, size, written);
+        if (result == LIBDEFLATE_SUCCESS)
+        {
+            m_finished = true;
+            return written;
+        }
+
+        if (result != LIBDEFLATE_INSUFFICIENT_SPACE)
+        {
+            Logger::log("libdeflate returned " + std::to_string(result), Logger::Type::Error);
+            fail();
+            return 0;
+        }
+        outputSize = size * 2;
+    }
+
+    auto& output = m_context.getOutputBuffer();
+    output.clear();
+    if (!m_context.inflateWhole(input.data(), input.size(), output, outputSize))
+    {
+        LOG("zlib decompression failed, the data is invalid.", Logger::Type::Error);
+        fail();
+        return 0;
+    }
+
+    m_output = output.data();
+    m_outputBegin = 0;
+    m_outputEnd = output.size();
+    return readOutput(dest, size);
+}
+
+std::size_t TileDataReader::readOutput(unsigned char* dest, std::size_t size)
+{
+    const auto count = std::min(size, m_outputEnd - m_outputBegin);
+    if (count != 0)
+    {
+        std::memcpy(dest, m_output + m_outputBegin, count);
+        m_outputBegin += count;
+    }
+
+    if (count < size)
+    {
+        m_finished = true;
+    }
+    return count;
+}
+#endif
+
+bool TileDataReader::decompressZstdWhole(unsigned char* dest, std::size_t size, std::size_t& written)
+{
+#if defined USE_ZSTD || defined USE_EXTLIBS
+    //as with inflateWhole() data which fits in the input window is
+    //decompressed in a single call, if the frame header says that the
+    //output fits in dest
+    if (!fillInput() || !m_sourceEnd)
+    {
+        return false;
+    }
+
+    const auto* source = m_input + m_inputBegin;
+    const auto sourceSize = m_inputEnd - m_inputBegin;
+    const auto contentSize = ZSTD_getFrameContentSize(source, sourceSize);
+    if (contentSize == ZSTD_CONTENTSIZE_UNKNOWN
+        || contentSize == ZSTD_CONTENTSIZE_ERROR
+        || contentSize > size
+        || ZSTD_findFrameCompressedSize(source, sourceSize) != sourceSize)
+    {
+        return false;
+    }
+
+    m_inputBegin = m_inputEnd;
+    m_finished = true;
+    written = 0;
+
+    const auto result = ZSTD_decompress_usingDDict(m_zstdContext, dest, size, source, sourceSize, m_zstdDictionary);
+    if (ZSTD_isError(result))
+    {
+        Logger::log("Failed to decompress layer data.\nError: " + std::string(ZSTD_getErrorName(result)), Logger::Type::Error);
+        fail();
+        return true;
+    }
+    written = result;
+    return true;
+#else
+    (void)dest;
+    (void)size;
+    (void)written;
+    return false;
+#endif
+}
+
+std::size_t TileDataReader::decompressZstd(unsigned char* dest, std::size_t size)
+{
+#if defined USE_ZSTD || defined USE_EXTLIBS
+    ZSTD_outBuffer output = { dest, size, 0 };
+    while (output.pos < output.size)
+    {
+        //the stream may still hold output once the input has run out
+        const bool hasInput = fillInput();
+        const auto written = output.pos;
+
+        ZSTD_inBuffer input = { m_input + m_inputBegin, m_inputEnd - m_inputBegin, 0 };
+        const auto result = ZSTD_decompressStream(m_zstdContext, &output, &input);
+        m_inputBegin += input.pos;
+
+        if (ZSTD_isError(result))
+        {
+            Logger::log("Failed to decompress layer data.\nError: " + std::string(ZSTD_getErrorName(result)), Logger::Type::Error);
+            fail();
+            return 0;
+        }
+
+        if (result == 0)
+        {
+            //end of the frame
+            m_finished = true;
+            if (fillInput())
+            {
+                LOG("Zstd decompression failed, found data after the end of the frame.", Logger::Type::Error);
+                fail();
+                return 0;
+            }
+            break;
+        }
+
+        if (!hasInput && output.pos == written)
+        {
+            LOG("Zstd decompression failed, the data ended early.", Logger::Type::Error);
+            fail();
+            return 0;
+        }
+    }
+    return output.pos;
+#else
+    (void)dest;
+    (void)size;
+    return 0;
+#endif
+}
+
+void TileDataReader::fail()
+{
+    m_error = true;
+    m_finished = true;
+}
@@ -0,0 +1,133 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#include <tmxlite/TileLayer.hpp>
+#include <tmxlite/ZstdDictionary.hpp>
+#include "DecompressionContext.hpp"
+#include "Gzip.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tmx
+{
+    namespace detail
+    {
+        /*!
+        \brief Reads the tile GIDs from base64 encoded, and optionally
+        compressed, tile layer data.
+        The data is decoded in small blocks which are inflated directly
+        into the buffer passed to read(), so that no copy of the whole
+        decoded or decompressed data is made. Data which fits in a single
+        block and a single call to read() is inflated in one step.
+        Zlib and gzip data are told apart by their headers, whichever
+        compression type is given.
+        When built with USE_LIBDEFLATE zlib and gzip data are instead
+        decoded and inflated whole by libdeflate, directly into the
+        buffer passed to the first read() if it is large enough for the
+        expected GID count.
+        Decompression uses the DecompressionContext of the calling thread.
+        The encoded data must outlive the reader.
+        */
+        class TileDataReader final
+        {
+        public:
+            /*!
+            \param dictionary Dictionary used to read zstd compressed data,
+            or nullptr if the data was compressed without one
+            \param expectedCount Number of GIDs the data is expected to hold,
+            or 0 if unknown. This is only used to size buffers.
+            */
+            TileDataReader(const char* data, std::size_t length, TileLayer::CompressionType compression,
+                const ZstdDictionary* dictionary = nullptr, std::size_t expectedCount = 0);
+            ~TileDataReader();
+
+            TileDataReader(const TileDataReader&) = delete;
+            TileDataReader& operator = (const TileDataReader&) = delete;
+
+            /*!
+            \brief Reads up to count GIDs into dest.
+            \returns The number of GIDs read. This is less than count only
+            once the end of the data has been reached, or an error occurred.
+            */
+            std::size_t read(std::uint32_t* dest, std::size_t count);
+
+            bool failed() const { return m_error; }
+
+        private:
+            //characters of base64 decoded into the input window at a time
+            static constexpr std::size_t BlockSize = 4096;
+
+            const char* m_data;
+            std::size_t m_length;
+            TileLayer::CompressionType m_compression;
+            std::size_t m_expectedCount;
+            bool m_sourceEnd;
+            bool m_started;
+            bool m_finished;
+            bool m_error;
+
+            unsigned char m_input[(BlockSize / 4) * 3];
+            std::size_t m_inputBegin;
+            std::size_t m_inputEnd;
+
+            DecompressionContext& m_context;
+            z_stream* m_inflateStream;
+            bool m_gzip;
+            std::uint32_t m_crc;
+            std::uint64_t m_outputSize;
+            unsigned char m_tail[GzipTrailerSize];
+            std::size_t m_tailSize;
+#ifdef USE_LIBDEFLATE
+            const unsigned char* m_output;
+            std::size_t m_outputBegin;
+            std::size_t m_outputEnd;
+#endif
+#if defined USE_ZSTD || defined USE_EXTLIBS
+            ZSTD_DCtx* m_zstdContext;
+            const ZSTD_DDict* m_zstdDictionary;
+#endif
+
+            bool fillInput();
+            std::size_t readBytes(unsigned char* dest, std::size_t size);
+            bool beginInflate();
+            bool skipGzipHeader();
+            std::size_t inflateBytes(unsigned char* dest, std::size_t size);
+            bool inflateWhole(unsigned char* dest, std::size_t size, std::size_t& written);
+            bool endInflate(const unsigned char* dest, std::size_t size);
+            void updateChecksum(const unsigned char* dest, std::size_t size);
+            void takeInput();
+            void keepTail(const unsigned char* data, std::size_t size);
+#ifdef USE_LIBDEFLATE
+            std::size_t inflateLibdeflate(unsigned char* dest, std::size_t size);
+            std::size_t readOutput(unsigned char* dest, std::size_t size);
+#endif
+            bool decompressZstdWhole(unsigned char* dest, std::size_t size, std::size_t& written);
+            std::size_t decompressZstd(unsigned char* dest, std::size_t size);
+            void fail();
+        };
+    }
+}
@@ -0,0 +1,250 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#include "Test.hpp"
+
+#include <tmxlite/AnimationClock.hpp>
+#include <tmxlite/AnimationTable.hpp>
+#include <tmxlite/Map.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace tmx;
+
+namespace
+{
+    const std::string AssetPath = TEST_ASSETS_PATH;
+
+    const std::uint32_t AnimationCount = 10240;
+    const std::uint32_t FirstGID = 1;
+    const std::uint32_t TileCount = AnimationCount + 16;
+    const std::uint32_t FlagBits[] = { 0x10000000, 0x20000000, 0x40000000, 0x80000000 };
+
+    struct Frame final
+    {
+        std::uint32_t GID = 0;
+        std::uint32_t duration = 0;
+    };
+
+    struct Animation final
+    {
+        std::uint32_t GID = 0;
+        std::vector<Frame> frames;
+    };
+
+    std::uint32_t nextRandom(std::uint32_t& state)
+    {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    //animations of between 1 and 6 frames, some of which last no time
+    //at all, and some animations in which no frame lasts any time
+    std::vector<Animation> makeAnimations()
+    {
+        std::vector<Animation> animations(AnimationCount);
+        std::uint32_t state = 1234;
+        for (auto i = 0u; i < AnimationCount; ++i)
+        {
+            auto& animation = animations[i];
+            animation.GID = FirstGID + i;
+
+            const auto frameCount = 1 + nextRandom(state) % 6;
+            for (auto j = 0u; j < frameCount; ++j)
+            {
+                Frame frame;
+                frame.GID = FirstGID + nextRandom(state) % TileCount;
+                if (i % 61 != 0 && nextRandom(state) % 4 != 0)
+                {
+                    frame.duration = 1 + nextRandom(state) % 400;
+                }
+                animation.frames.push_back(frame);
+            }
+        }
+        return animations;
+    }
+
+    std::string makeMap(const std::vector<Animation>& animations)
+    {
+        std::string tiles;
+        for (const auto& animation : animations)
+        {
+            if (!tiles.empty())
+            {
+                tiles += ",";
+            }
+            tiles += "{\"id\":" + std::to_string(animation.GID - FirstGID) + ",\"animation\":[";
+            for (auto i = 0u; i < animation.frames.size(); ++i)
+            {
+                const auto& frame = animation.frames[i];
+                tiles += (i == 0 ? "{" : ",{");
+                tiles += "\"tileid\":" + std::to_string(frame.GID - FirstGID);
+                tiles += ",\"duration\":" + std::to_string(frame.duration) + "}";
+            }
+            tiles += "]}";
+        }
+
+        return R"({
+            "type": "map", "orientation": "orthogonal", "width": 1, "height": 1,
+            "tilewidth": 16, "tileheight": 16, "infinite": false, "layers": [],
+            "tilesets": [ { "firstgid": )" + std::to_string(FirstGID) + R"(, "name": "animated",
+                "image": "images/tiles.png", "imagewidth": 2048, "imageheight": 2048,
+                "columns": 128, "tilecount": )" + std::to_string(TileCount) + R"(,
+                "tilewidth": 16, "tileheight": 16, "margin": 0, "spacing": 0,
+                "tiles": [ )" + tiles + " ] } ] }";
+    }
+
+    //the first frame which ends after the time since the animation last
+    //started, or the first frame if it lasts no time at all. Times
+    //before the start of the animation show it as it starts.
+    std::uint32_t findFrameGID(const Animation& animation, double time)
+    {
+        std::uint64_t duration = 0;
+        for (const auto& frame : animation.frames)
+        {
+            duration += frame.duration;
+        }
+
+        if (duration != 0)
+        {
+            const auto position = time > 0.0 ? std::fmod(time, static_cast<double>(duration)) : 0.0;
+            std::uint64_t end = 0;
+            for (const auto& frame : animation.frames)
+            {
+                end += frame.duration;
+                if (position < end)
+                {
+                    return frame.GID;
+                }
+            }
+        }
+        return animation.frames[0].GID;
+    }
+
+    //compares every animation with the clock and the table at the
+    //clock's time, and the animations reported as changed with those
+    //whose frame differs from the last check
+    void checkClock(const std::vector<Animation>& animations, const AnimationTable& table,
+        const AnimationClock& clock, std::vector<std::uint32_t>& lastGIDs)
+    {
+        const auto time = clock.getTime();
+        std::vector<std::uint32_t> changed;
+        std::size_t mismatches = 0;
+        for (auto i = 0u; i < animations.size(); ++i)
+        {
+            const auto& animation = animations[i];
+            const auto expected = findFrameGID(animation, time);
+
+            //bits of the flag taken from the index, so that each
+            //combination of flip flags is checked
+            const auto flags = FlagBits[i % 4] | FlagBits[(i / 4) % 4];
+            if (clock.getGID(animation.GID) != expected
+                || clock.getGID(animation.GID | flags) != (expected | flags)
+                || table.getFrameGID(animation.GID | flags, time) != (expected | flags))
+            {
+                mismatches++;
+            }
+
+            if (expected != lastGIDs[i])
+            {
+                changed.push_back(i);
+                lastGIDs[i] = expected;
+            }
+        }
+
+        if (!TMX_CHECK(mismatches == 0))
+        {
+            std::cerr << "    time: " << time << ", mismatches: " << mismatches << std::endl;
+        }
+        TMX_CHECK(changed == clock.getChangedAnimations());
+    }
+
+    void testAnimations()
+    {
+        const auto animations = makeAnimations();
+
+        Map map;
+        if (!TMX_CHECK(map.loadFromString(makeMap(animations), AssetPath)))
+        {
+            return;
+        }
+
+        const auto& table = map.getAnimationTable();
+        if (!TMX_CHECK(table.getAnimations().size() == AnimationCount))
+        {
+            return;
+        }
+
+        for (auto i = 0u; i < AnimationCount; ++i)
+        {
+            const auto& animation = table.getAnimations()[i];
+            TMX_CHECK(animation.GID == animations[i].GID);
+            TMX_CHECK(animation.frameCount == animations[i].frames.size());
+            TMX_CHECK(table.findAnimation(animations[i].GID | 0x80000000) == std::int32_t(i));
+        }
+
+        //tiles which aren't animated are returned as they are
+        TMX_CHECK(table.findAnimation(0) == -1);
+        TMX_CHECK(table.findAnimation(FirstGID + AnimationCount) == -1);
+        TMX_CHECK(table.getFrameGID(FirstGID + AnimationCount + 1, 100.0) == FirstGID + AnimationCount + 1);
+
+        AnimationClock clock(table);
+        std::vector<std::uint32_t> lastGIDs(AnimationCount);
+        for (auto i = 0u; i < AnimationCount; ++i)
+        {
+            lastGIDs[i] = findFrameGID(animations[i], 0.0);
+        }
+        TMX_CHECK(clock.getCurrentGIDs() == lastGIDs);
+
+        for (auto step = 0u; step < 400; ++step)
+        {
+            //going back in time every so often, sometimes to before the start
+            if (step % 37 == 36)
+            {
+                clock.setTime(static_cast<double>((step * 7919) % 3000) - 20.0);
+            }
+            else
+            {
+                clock.update(7.3);
+            }
+            checkClock(animations, table, clock, lastGIDs);
+        }
+
+        const auto unanimated = FirstGID + AnimationCount + 2;
+        TMX_CHECK(clock.getGID(unanimated) == unanimated);
+        TMX_CHECK(clock.getGID(unanimated | 0xa0000000) == (unanimated | 0xa0000000));
+    }
+}
+
+int main()
+{
+    testAnimations();
+
+    return tmx::test::result("AnimationTests");
+}
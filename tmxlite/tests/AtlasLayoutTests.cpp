@@ -0,0 +1,185 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#include "Test.hpp"
+
+#include <tmxlite/AtlasLayout.hpp>
+#include <tmxlite/Map.hpp>
+#include <tmxlite/TileLayer.hpp>
+#include <tmxlite/UVTable.hpp>
+
+#include <cstdint>
+#include <string>
+
+using namespace tmx;
+
+namespace
+{
+    const std::string AssetPath = TEST_ASSETS_PATH;
+
+    bool operator == (const Vector2u& l, const Vector2u& r)
+    {
+        return l.x == r.x && l.y == r.y;
+    }
+
+    //tile set strings use the map's allocator when built with USE_ARENA
+    template <typename T>
+    bool endsWith(const T& value, const std::string& suffix)
+    {
+        const std::string str = value.c_str();
+        return str.size() >= suffix.size()
+            && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    bool sameRect(const AtlasLayout::TileRect* tileRect, int left, int top, int width, int height)
+    {
+        return tileRect != nullptr && tileRect->page == 0
+            && tileRect->rect.left == left && tileRect->rect.top == top
+            && tileRect->rect.width == width && tileRect->rect.height == height;
+    }
+
+    //the tiles of an image collection tile set each have an image of their
+    //own, and the tile set has neither an image nor any columns
+    void testCollection(Map::ParseMode mode)
+    {
+        Map map;
+        map.setParseMode(mode);
+        if (!TMX_CHECK(map.load(AssetPath + "collection.json"))
+            || !TMX_CHECK(map.getTilesets().size() == 2))
+        {
+            return;
+        }
+
+        const auto& collection = map.getTilesets()[1];
+        TMX_CHECK(collection.getFirstGID() == 21);
+        TMX_CHECK(collection.getColumnCount() == 0);
+        TMX_CHECK(collection.getImagePath().empty());
+        TMX_CHECK(collection.getLastGID() == 24);
+
+        const auto tree = collection.getTile(21);
+        TMX_CHECK(tree && endsWith(tree.getImagePath(), "images/tree.png"));
+        TMX_CHECK(tree.getImageSize() == Vector2u(32, 48));
+        TMX_CHECK(tree.getImagePosition() == Vector2u());
+
+        const auto rock = collection.getTile(24);
+        TMX_CHECK(rock && endsWith(rock.getImagePath(), "images/rock.png"));
+        TMX_CHECK(rock.getImageSize() == Vector2u(24, 20));
+        TMX_CHECK(rock.getData() != nullptr && rock.getData()->properties.size() == 1);
+
+        //each tile covers the whole of its own image
+        const UVTable table(collection);
+        if (TMX_CHECK(table.getTileCount() == 4))
+        {
+            const std::uint32_t tileIDs[] = { 0, 3 };
+            for (auto tileID : tileIDs)
+            {
+                const auto* quad = table.getQuad(tileID);
+                TMX_CHECK(quad[0] == 0.f && quad[1] == 0.f && quad[2] == 1.f && quad[3] == 0.f
+                    && quad[4] == 1.f && quad[5] == 1.f && quad[6] == 0.f && quad[7] == 1.f);
+
+                //the horizontal flip swaps the left and right edges
+                quad = table.getQuad(tileID, TileLayer::FlipFlag::Horizontal);
+                TMX_CHECK(quad[0] == 1.f && quad[1] == 0.f && quad[2] == 0.f && quad[3] == 0.f);
+            }
+        }
+
+        AtlasLayout atlas;
+        if (!TMX_CHECK(atlas.build(map)))
+        {
+            return;
+        }
+
+        //placed tallest first, in a single row
+        const auto& images = atlas.getImages();
+        if (!TMX_CHECK(images.size() == 3))
+        {
+            return;
+        }
+        TMX_CHECK(endsWith(images[0].path, "images/tiles.png") && images[0].size == Vector2u(80, 64));
+        TMX_CHECK(endsWith(images[1].path, "images/tree.png") && images[1].size == Vector2u(32, 48));
+        TMX_CHECK(endsWith(images[2].path, "images/rock.png") && images[2].size == Vector2u(24, 20));
+        TMX_CHECK(images[0].position == Vector2u(0, 0));
+        TMX_CHECK(images[1].position == Vector2u(81, 0));
+        TMX_CHECK(images[2].position == Vector2u(114, 0));
+
+        if (TMX_CHECK(atlas.getPageSizes().size() == 1))
+        {
+            TMX_CHECK(atlas.getPageSizes()[0] == Vector2u(138, 64));
+        }
+
+        TMX_CHECK(atlas.getTileRects().size() == 25);
+        TMX_CHECK(atlas.getTileRect(0) == nullptr);
+        TMX_CHECK(sameRect(atlas.getTileRect(1), 0, 0, 16, 16));
+        TMX_CHECK(sameRect(atlas.getTileRect(2), 16, 0, 16, 16));
+        TMX_CHECK(sameRect(atlas.getTileRect(20), 64, 48, 16, 16));
+        TMX_CHECK(sameRect(atlas.getTileRect(21), 81, 0, 32, 48));
+        TMX_CHECK(sameRect(atlas.getTileRect(24), 114, 0, 24, 20));
+
+        //IDs the collection doesn't declare have no image
+        TMX_CHECK(atlas.getTileRect(22) == nullptr);
+        TMX_CHECK(atlas.getTileRect(23) == nullptr);
+        TMX_CHECK(atlas.getTileRect(25) == nullptr);
+
+        //flip flags are ignored
+        TMX_CHECK(atlas.getTileRect(21 | 0x80000000) == atlas.getTileRect(21));
+        TMX_CHECK(atlas.getTileRect(24 | 0x20000000) == atlas.getTileRect(24));
+
+        //the layer refers to the collection tiles, flags and all
+        const auto& layer = map.getLayers()[0]->getLayerAs<TileLayer>();
+        const auto& tiles = layer.getTiles();
+        if (TMX_CHECK(tiles.size() == 16))
+        {
+            TMX_CHECK(tiles[0].ID == 21 && tiles[1].ID == 24);
+            TMX_CHECK(tiles[4].ID == 21 && tiles[4].flipFlags == TileLayer::FlipFlag::Horizontal);
+            TMX_CHECK(tiles[5].ID == 24 && tiles[5].flipFlags == TileLayer::FlipFlag::Diagonal);
+        }
+    }
+
+    //a tile set with neither an image nor tiles with images is rejected
+    void testMissingImages()
+    {
+        const std::string json = R"({
+            "type": "map", "orientation": "orthogonal", "width": 1, "height": 1,
+            "tilewidth": 16, "tileheight": 16, "infinite": false,
+            "tilesets": [ { "firstgid": 1, "name": "empty", "columns": 0, "tilecount": 1,
+                "tilewidth": 16, "tileheight": 16, "tiles": [ { "id": 0, "probability": 1 } ] } ],
+            "layers": [] })";
+
+        Map map;
+        if (TMX_CHECK(map.loadFromString(json, AssetPath)))
+        {
+            TMX_CHECK(map.getTilesets().empty());
+        }
+    }
+}
+
+int main()
+{
+    testCollection(Map::ParseMode::Document);
+    testCollection(Map::ParseMode::Streaming);
+    testMissingImages();
+
+    return tmx::test::result("AtlasLayoutTests");
+}
@@ -0,0 +1,238 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#include "Test.hpp"
+
+#include "detail/Base64.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace tmx::detail;
+
+namespace
+{
+    const std::string Alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    //bytes written past the space required by base64DecodedSize()
+    //are caught by filling the end of the buffer with a known value
+    constexpr std::size_t GuardSize = 64;
+    constexpr unsigned char GuardValue = 0xcd;
+
+    std::string makeInput(std::size_t length, std::uint32_t seed)
+    {
+        std::string result;
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            result.push_back(Alphabet[(seed >> 24) & 63]);
+        }
+        return result;
+    }
+
+    std::string describe(const std::string& input)
+    {
+        std::string result;
+        for (auto c : input)
+        {
+            const auto value = static_cast<unsigned char>(c);
+            if (value < 0x20 || value > 0x7e)
+            {
+                const char* hex = "0123456789abcdef";
+                result += "\\x";
+                result.push_back(hex[value >> 4]);
+                result.push_back(hex[value & 15]);
+            }
+            else
+            {
+                result.push_back(c);
+            }
+        }
+        return "\"" + result + "\" (" + std::to_string(input.size()) + " characters)";
+    }
+
+    using DecodeFunc = std::size_t(*)(const char*, std::size_t, unsigned char*);
+
+    std::vector<unsigned char> decode(DecodeFunc func, const std::string& input, bool& guardIntact)
+    {
+        //copied so that the input ends exactly where the decoders are told it does
+        const std::vector<char> source(input.begin(), input.end());
+        const auto size = base64DecodedSize(source.size());
+
+        std::vector<unsigned char> output(size + GuardSize, GuardValue);
+        const auto count = func(source.data(), source.size(), output.data());
+
+        guardIntact = count <= size;
+        for (auto i = size; i < output.size(); ++i)
+        {
+            guardIntact = guardIntact && output[i] == GuardValue;
+        }
+
+        output.resize(std::min(count, size));
+        return output;
+    }
+
+    //decodes the input with both the scalar decoder and the decoder
+    //selected for this CPU, and checks that the results are the same
+    bool compare(const std::string& input)
+    {
+        bool scalarGuard = false;
+        bool dispatchedGuard = false;
+        const auto scalar = decode(base64DecodeScalar, input, scalarGuard);
+        const auto dispatched = decode(base64Decode, input, dispatchedGuard);
+
+        if (!TMX_CHECK(scalarGuard) || !TMX_CHECK(dispatchedGuard) || !TMX_CHECK(scalar == dispatched))
+        {
+            std::cerr << "    input: " << describe(input) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void testKnownValues()
+    {
+        const struct
+        {
+            const char* input;
+            const char* expected;
+        } values[] =
+        {
+            { "", "" },
+            { "TQ==", "M" },
+            { "TWE=", "Ma" },
+            { "TWFu", "Man" },
+            { "TWFueQ", "Many" },
+            { "TWFueSBoYW5kcyBtYWtlIGxpZ2h0IHdvcmsu", "Many hands make light work." },
+            { "TWFu TWFu", "Man" },
+            { "TW-Fu", "M" }
+        };
+
+        for (const auto& value : values)
+        {
+            const std::string input(value.input);
+            const std::string expected(value.expected);
+
+            bool guardIntact = false;
+            for (auto func : { DecodeFunc(base64DecodeScalar), DecodeFunc(base64Decode) })
+            {
+                const auto output = decode(func, input, guardIntact);
+                if (!TMX_CHECK(guardIntact)
+                    || !TMX_CHECK(std::string(output.begin(), output.end()) == expected))
+                {
+                    std::cerr << "    input: " << describe(input) << std::endl;
+                }
+            }
+        }
+    }
+
+    //every length either side of the 24 and 44 character
+    //limits used by the SSE4.1 and AVX2 loops
+    void testLengths()
+    {
+        for (std::size_t length = 0; length <= 64; ++length)
+        {
+            for (std::uint32_t seed = 0; seed < 8; ++seed)
+            {
+                compare(makeInput(length, seed));
+            }
+        }
+
+        //all 64 characters of the alphabet in each lane of a block
+        for (std::size_t offset = 0; offset < Alphabet.size(); ++offset)
+        {
+            compare(Alphabet.substr(offset) + Alphabet.substr(0, offset));
+        }
+    }
+
+    void testPadding()
+    {
+        for (std::size_t length = 0; length <= 64; ++length)
+        {
+            auto input = makeInput(length, 1);
+            while (input.size() % 4 != 0)
+            {
+                input.push_back('=');
+            }
+            compare(input);
+
+            //decoding stops at the padding even when more data follows
+            compare(input + makeInput(64 - length, 2));
+            compare(input + "====");
+        }
+    }
+
+    //a single character which is not part of the alphabet, including
+    //whitespace, placed at each position of inputs around the block limits
+    void testInvalidCharacters()
+    {
+        const std::size_t lengths[] = { 4, 16, 23, 24, 25, 32, 43, 44, 45, 48, 63, 64 };
+        for (auto length : lengths)
+        {
+            const auto base = makeInput(length, static_cast<std::uint32_t>(length));
+            for (std::size_t position = 0; position < length; ++position)
+            {
+                for (int value = 0; value < 256; ++value)
+                {
+                    const auto c = static_cast<char>(value);
+                    if (Alphabet.find(c) != std::string::npos)
+                    {
+                        continue;
+                    }
+
+                    auto input = base;
+                    input[position] = c;
+                    if (!compare(input))
+                    {
+                        return;
+                    }
+                }
+            }
+        }
+
+        //whitespace as it appears in hand formatted map files
+        const std::string whitespace[] = { " ", "\n", "\r\n", "\t", "   \n   " };
+        for (const auto& space : whitespace)
+        {
+            for (std::size_t position = 0; position <= 64; ++position)
+            {
+                auto input = makeInput(64, 3);
+                input.insert(position, space);
+                compare(input);
+            }
+        }
+    }
+}
+
+int main()
+{
+    testKnownValues();
+    testLengths();
+    testPadding();
+    testInvalidCharacters();
+
+    return tmx::test::result("Base64Tests");
+}
@@ -0,0 +1,184 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#include "Test.hpp"
+
+#include <tmxlite/Map.hpp>
+#include <tmxlite/LayerGroup.hpp>
+#include <tmxlite/TileLayer.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace tmx;
+
+namespace
+{
+    const std::string AssetPath = TEST_ASSETS_PATH;
+
+    //infinite.json has chunks on a grid. The layers of chunks.json have
+    //chunks on a grid at negative positions, chunks far apart which are
+    //found through a hash map, and chunks of different sizes or not on
+    //a grid, which are found with a search
+    const std::string MapFiles[] = { "infinite.json", "chunks.json" };
+
+    void addTileLayers(const std::vector<Layer::Ptr>& layers, std::vector<const TileLayer*>& output)
+    {
+        for (const auto& layer : layers)
+        {
+            if (layer->getType() == Layer::Type::Tile)
+            {
+                output.push_back(&layer->getLayerAs<TileLayer>());
+            }
+            else if (layer->getType() == Layer::Type::Group)
+            {
+                addTileLayers(layer->getLayerAs<LayerGroup>().getLayers(), output);
+            }
+        }
+    }
+
+    //the first chunk containing the position, found without the index
+    const TileLayer::Chunk* findChunk(const TileLayer& layer, int x, int y)
+    {
+        for (const auto& chunk : layer.getChunks())
+        {
+            if (std::int64_t(x) >= chunk.position.x && std::int64_t(x) < std::int64_t(chunk.position.x) + chunk.size.x
+                && std::int64_t(y) >= chunk.position.y && std::int64_t(y) < std::int64_t(chunk.position.y) + chunk.size.y)
+            {
+                return &chunk;
+            }
+        }
+        return nullptr;
+    }
+
+    bool checkPosition(const TileLayer& layer, int x, int y)
+    {
+        const auto* expected = findChunk(layer, x, y);
+        TileLayer::Tile expectedTile;
+        if (expected != nullptr)
+        {
+            expectedTile = expected->tiles[std::size_t(y - expected->position.y) * std::size_t(expected->size.x) + std::size_t(x - expected->position.x)];
+        }
+
+        const auto tile = layer.getTile(x, y);
+        if (!TMX_CHECK(layer.getChunk(x, y) == expected)
+            || !TMX_CHECK(tile.ID == expectedTile.ID && tile.flipFlags == expectedTile.flipFlags))
+        {
+            std::cerr << "    layer: " << layer.getName() << ", position: " << x << ", " << y << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void checkLayer(const TileLayer& layer)
+    {
+        const auto& chunks = layer.getChunks();
+        if (!TMX_CHECK(!chunks.empty()))
+        {
+            return;
+        }
+
+        int left = std::numeric_limits<int>::max();
+        int top = std::numeric_limits<int>::max();
+        int right = std::numeric_limits<int>::min();
+        int bottom = std::numeric_limits<int>::min();
+        for (const auto& chunk : chunks)
+        {
+            left = std::min(left, chunk.position.x);
+            top = std::min(top, chunk.position.y);
+            right = std::max(right, chunk.position.x + chunk.size.x);
+            bottom = std::max(bottom, chunk.position.y + chunk.size.y);
+
+            //every tile of every chunk, and the tiles around it
+            for (auto y = chunk.position.y - 1; y <= chunk.position.y + chunk.size.y; ++y)
+            {
+                for (auto x = chunk.position.x - 1; x <= chunk.position.x + chunk.size.x; ++x)
+                {
+                    if (!checkPosition(layer, x, y))
+                    {
+                        return;
+                    }
+                }
+            }
+        }
+
+        //random positions in and around the area covered by the chunks
+        std::uint32_t seed = 12345;
+        const auto width = std::int64_t(right) - left + 64;
+        const auto height = std::int64_t(bottom) - top + 64;
+        for (auto i = 0; i < 20000; ++i)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            const auto x = static_cast<int>(left - 32 + std::int64_t(seed >> 8) % width);
+            seed = seed * 1664525u + 1013904223u;
+            const auto y = static_cast<int>(top - 32 + std::int64_t(seed >> 8) % height);
+            if (!checkPosition(layer, x, y))
+            {
+                return;
+            }
+        }
+
+        //and positions far outside of it
+        const int limits[] = { std::numeric_limits<int>::min(), -1000000, -1, 0, 1000000, std::numeric_limits<int>::max() };
+        for (auto x : limits)
+        {
+            for (auto y : limits)
+            {
+                checkPosition(layer, x, y);
+            }
+        }
+    }
+
+    void testChunks(Map::TileDecoding decoding)
+    {
+        for (const auto& file : MapFiles)
+        {
+            Map map;
+            map.setTileDecoding(decoding);
+            if (!TMX_CHECK(map.load(AssetPath + file)))
+            {
+                continue;
+            }
+
+            std::vector<const TileLayer*> layers;
+            addTileLayers(map.getLayers(), layers);
+            for (const auto* layer : layers)
+            {
+                checkLayer(*layer);
+            }
+        }
+    }
+}
+
+int main()
+{
+    testChunks(Map::TileDecoding::Eager);
+    testChunks(Map::TileDecoding::Lazy);
+
+    return tmx::test::result("ChunkIndexTests");
+}
@@ -0,0 +1,168 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#include "MapComparison.hpp"
+
+#include "detail/CompiledMap.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace tmx;
+
+namespace
+{
+    const std::string AssetPath = TEST_ASSETS_PATH;
+    const std::string MapFiles[] = { "finite.json", "infinite.json" };
+
+    std::vector<char> compile(const Map& map)
+    {
+        std::vector<char> output;
+        detail::CompiledMap::write(map, output);
+        return output;
+    }
+
+    void testRoundTrip()
+    {
+        for (const auto& file : MapFiles)
+        {
+            Map map;
+            if (!TMX_CHECK(map.load(AssetPath + file)))
+            {
+                continue;
+            }
+
+            const auto data = compile(map);
+            TMX_CHECK(detail::CompiledMap::isCompiled(data.data(), data.size()));
+
+            Map compiled;
+            if (TMX_CHECK(compiled.loadFromMemory(data.data(), data.size(), AssetPath)))
+            {
+                test::compareMaps(map, compiled);
+
+                //compiling the compiled map gives the same data again
+                TMX_CHECK(compile(compiled) == data);
+            }
+
+            //and through a file with saveCompiled()
+            const std::string path = "CompiledMapTests.tmxc";
+            if (TMX_CHECK(map.saveCompiled(path)))
+            {
+                Map saved;
+                if (TMX_CHECK(saved.load(path)))
+                {
+                    test::compareMaps(map, saved);
+                }
+                std::remove(path.c_str());
+            }
+        }
+    }
+
+    bool loads(const std::vector<char>& data)
+    {
+        Map map;
+        return map.loadFromMemory(data.data(), data.size(), AssetPath);
+    }
+
+    //every cut into the header, then at intervals through the tables
+    void testTruncated()
+    {
+        Map map;
+        if (!TMX_CHECK(map.load(AssetPath + MapFiles[1])))
+        {
+            return;
+        }
+        const auto data = compile(map);
+
+        for (std::size_t size = 0; size < data.size(); size += (size < 512 || size + 64 > data.size()) ? 1 : 61)
+        {
+            if (!TMX_CHECK(!loads(std::vector<char>(data.begin(), data.begin() + size))))
+            {
+                std::cerr << "    loaded with " << size << " of " << data.size() << " bytes" << std::endl;
+                return;
+            }
+        }
+    }
+
+    void testCorrupt()
+    {
+        Map map;
+        if (!TMX_CHECK(map.load(AssetPath + MapFiles[1])))
+        {
+            return;
+        }
+        const auto data = compile(map);
+
+        //header fields which must be rejected: the magic number, the
+        //version and byte order, and sections outside of the data
+        constexpr std::size_t SectionCount = detail::CompiledMap::SectionCount;
+        const std::size_t offsetsStart = 16;
+        const std::size_t countsStart = offsetsStart + SectionCount * 8;
+        for (std::size_t i = 0; i < 16; ++i)
+        {
+            auto corrupt = data;
+            corrupt[i] ^= 0x40;
+            TMX_CHECK(!loads(corrupt));
+        }
+
+        for (std::size_t i = 0; i < SectionCount; ++i)
+        {
+            auto offset = data;
+            const std::uint64_t outside = data.size() + 1;
+            std::memcpy(offset.data() + offsetsStart + i * 8, &outside, 8);
+            TMX_CHECK(!loads(offset));
+
+            auto count = data;
+            const std::uint64_t tooMany = 0xffffffffu;
+            std::memcpy(count.data() + countsStart + i * 8, &tooMany, 8);
+            TMX_CHECK(!loads(count));
+        }
+
+        //any other damage may still give a valid map, but must
+        //not read outside of the data or otherwise crash
+        const unsigned char values[] = { 0x00, 0xff, 0x7f };
+        for (auto value : values)
+        {
+            for (std::size_t i = countsStart + SectionCount * 8; i < data.size(); i += 3)
+            {
+                auto corrupt = data;
+                corrupt[i] = static_cast<char>(value);
+                loads(corrupt);
+            }
+        }
+    }
+}
+
+int main()
+{
+    testRoundTrip();
+    testTruncated();
+    testCorrupt();
+
+    return tmx::test::result("CompiledMapTests");
+}
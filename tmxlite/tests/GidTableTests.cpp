@@ -0,0 +1,211 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#include "Test.hpp"
+
+#include <tmxlite/Map.hpp>
+#include <tmxlite/ObjectGroup.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace tmx;
+
+namespace
+{
+    const std::string AssetPath = TEST_ASSETS_PATH;
+
+    //the first GID and tile count of each tile set of a map
+    using TilesetList = std::vector<std::pair<std::uint32_t, std::uint32_t>>;
+
+    std::string makeTileset(std::uint32_t firstGID, std::uint32_t tileCount)
+    {
+        const auto count = std::to_string(tileCount);
+        return "{\"firstgid\":" + std::to_string(firstGID) + ",\"name\":\"tiles" + std::to_string(firstGID)
+            + "\",\"image\":\"images/tiles.png\",\"imagewidth\":" + std::to_string(tileCount * 16)
+            + ",\"imageheight\":16,\"tilewidth\":16,\"tileheight\":16,\"margin\":0,\"spacing\":0,\"tilecount\":"
+            + count + ",\"columns\":" + count + "}";
+    }
+
+    //a map with the given tile sets, and a tile object both with
+    //and without a template, whose tile set is found separately
+    std::string makeMap(const TilesetList& tilesets)
+    {
+        std::string output = "{\"type\":\"map\",\"version\":\"1.10\",\"orientation\":\"orthogonal\",\"renderorder\":\"right-down\","
+            "\"width\":1,\"height\":1,\"tilewidth\":16,\"tileheight\":16,\"infinite\":false,"
+            "\"layers\":[{\"id\":1,\"name\":\"objects\",\"type\":\"objectgroup\",\"x\":0,\"y\":0,\"opacity\":1,\"visible\":true,\"objects\":["
+            "{\"id\":1,\"template\":\"tiletemplate.tj\",\"x\":16,\"y\":16},"
+            "{\"id\":2,\"name\":\"tile\",\"type\":\"\",\"gid\":2684354562,\"x\":0,\"y\":0,\"width\":16,\"height\":16,\"rotation\":0,\"visible\":true}]}],"
+            "\"tilesets\":[";
+        for (auto i = 0u; i < tilesets.size(); ++i)
+        {
+            output += (i == 0 ? "" : ",") + makeTileset(tilesets[i].first, tilesets[i].second);
+        }
+        return output + "]}";
+    }
+
+    //the tile set Tiled uses for a GID is the one with the greatest
+    //first GID not above it, or the last of those if several tile
+    //sets share it. The GID belongs to no tile set if it's past the
+    //end of that tile set.
+    Map::TileLocation findLinear(const Map& map, std::uint32_t GID)
+    {
+        GID &= 0x0fffffff;
+
+        const auto& tilesets = map.getTilesets();
+        std::int32_t found = -1;
+        for (auto i = 0u; i < tilesets.size(); ++i)
+        {
+            if (tilesets[i].getFirstGID() <= GID
+                && (found < 0 || tilesets[i].getFirstGID() >= tilesets[found].getFirstGID()))
+            {
+                found = static_cast<std::int32_t>(i);
+            }
+        }
+
+        Map::TileLocation location;
+        if (found >= 0 && tilesets[found].hasTile(GID))
+        {
+            location.tileset = &tilesets[found];
+            location.index = found;
+            location.tileID = GID - tilesets[found].getFirstGID();
+        }
+        return location;
+    }
+
+    bool checkGID(const Map& map, std::uint32_t GID)
+    {
+        const auto expected = findLinear(map, GID);
+        for (std::uint32_t flags = 0; flags < 16; ++flags)
+        {
+            const auto location = map.findTile(GID | (flags << 28));
+            if (!TMX_CHECK(location.tileset == expected.tileset && location.index == expected.index
+                && location.tileID == expected.tileID))
+            {
+                std::cerr << "    GID: " << GID << ", flags: " << flags << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void testMap(const TilesetList& tilesets)
+    {
+        Map map;
+        if (!TMX_CHECK(map.loadFromString(makeMap(tilesets), AssetPath))
+            || !TMX_CHECK(map.getTilesets().size() == tilesets.size()))
+        {
+            return;
+        }
+
+        //GID 0 is always empty, as is anything past the last tile set
+        std::uint32_t lastGID = 0;
+        for (const auto& tileset : map.getTilesets())
+        {
+            lastGID = std::max(lastGID, tileset.getLastGID());
+        }
+        TMX_CHECK(map.findTile(0).tileset == nullptr);
+        TMX_CHECK(map.findTile(lastGID + 1).tileset == nullptr);
+        TMX_CHECK(map.findTile(0x0fffffff).tileset == nullptr);
+        TMX_CHECK(map.findTile(0xffffffff).tileset == nullptr);
+
+        //either side of the start and end of every tile set
+        std::vector<std::uint32_t> GIDs = { 0, 1, 2, lastGID, lastGID + 1, lastGID + 2, 0x0fffffff };
+        for (const auto& tileset : map.getTilesets())
+        {
+            for (auto offset = 0u; offset < 3; ++offset)
+            {
+                GIDs.push_back(tileset.getFirstGID() + offset);
+                GIDs.push_back(tileset.getFirstGID() - offset);
+                GIDs.push_back(tileset.getLastGID() + offset);
+                GIDs.push_back(tileset.getLastGID() - offset);
+            }
+        }
+
+        //and every GID where there aren't too many of them
+        if (lastGID < 10000)
+        {
+            for (auto GID = 0u; GID < lastGID + 4; ++GID)
+            {
+                GIDs.push_back(GID);
+            }
+        }
+
+        for (auto GID : GIDs)
+        {
+            if (!checkGID(map, GID))
+            {
+                break;
+            }
+        }
+
+        //tile objects from a template use the template's tile set, which
+        //tiletemplate.tj starts at GID 3, other objects the map's tile sets
+        const auto& objects = map.getLayers()[0]->getLayerAs<ObjectGroup>().getObjects();
+        if (TMX_CHECK(objects.size() == 2))
+        {
+            const auto templated = map.findTile(objects[0]);
+            TMX_CHECK(templated.tileset != nullptr && templated.index == -1 && templated.tileID == 6);
+            if (templated.tileset != nullptr)
+            {
+                TMX_CHECK(templated.tileset->getFirstGID() == 3);
+                TMX_CHECK(templated.tileset == &map.getTemplateTilesets().begin()->second);
+            }
+
+            const auto tile = map.findTile(objects[1]);
+            const auto expected = findLinear(map, objects[1].getTileID());
+            TMX_CHECK(tile.tileset == expected.tileset && tile.index == expected.index && tile.tileID == expected.tileID);
+        }
+    }
+}
+
+int main()
+{
+    const TilesetList maps[] =
+    {
+        //dense first GIDs, which are looked up in a table
+        { { 1, 20 }, { 21, 8 }, { 29, 100 } },
+        { { 1, 1 } },
+        //tile sets with unused GIDs between them, and out of order
+        { { 5, 10 }, { 100, 3 }, { 40, 20 } },
+        //sparse first GIDs, which are looked up in a list of ranges
+        { { 1, 4 }, { 2000000, 16 }, { 50000000, 8 } },
+        { { 0x0ffffff0, 4 }, { 7, 7 } },
+        //tile sets which overlap, or share a first GID, either way
+        { { 1, 20 }, { 11, 4 }, { 11, 8 }, { 15, 30 } },
+        { { 10, 40 }, { 1, 100 }, { 30, 2 } },
+        { { 1, 20 }, { 11, 4 }, { 11, 8 }, { 15, 30 }, { 30000000, 10 }, { 30000005, 2 } },
+    };
+
+    for (const auto& tilesets : maps)
+    {
+        testMap(tilesets);
+    }
+
+    return tmx::test::result("GidTableTests");
+}
@@ -0,0 +1,156 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#include "Test.hpp"
+
+#include "detail/Gid.hpp"
+
+#include <cstdint>
+#include <vector>
+
+using namespace tmx::detail;
+
+namespace
+{
+    //outputs written past the given count are caught by
+    //filling the end of the buffers with a known value
+    constexpr std::size_t GuardSize = 64;
+    constexpr std::uint32_t GuardID = 0xcdcdcdcd;
+    constexpr std::uint8_t GuardFlags = 0xcd;
+
+    struct Unpacked final
+    {
+        std::vector<std::uint32_t> IDs;
+        std::vector<std::uint8_t> flipFlags;
+        bool guardIntact = true;
+    };
+
+    using UnpackFunc = void(*)(const std::uint32_t*, std::size_t, std::uint32_t*, std::uint8_t*);
+
+    //unpacks count GIDs starting at offset, so that the
+    //vector versions are also given unaligned buffers
+    Unpacked unpack(UnpackFunc func, const std::vector<std::uint32_t>& GIDs, std::size_t offset)
+    {
+        const auto count = GIDs.size() - offset;
+        std::vector<std::uint32_t> IDs(offset + count + GuardSize, GuardID);
+        std::vector<std::uint8_t> flipFlags(offset + count + GuardSize, GuardFlags);
+        func(GIDs.data() + offset, count, IDs.data() + offset, flipFlags.data() + offset);
+
+        Unpacked result;
+        for (auto i = 0u; i < IDs.size(); ++i)
+        {
+            if (i >= offset && i < offset + count)
+            {
+                result.IDs.push_back(IDs[i]);
+                result.flipFlags.push_back(flipFlags[i]);
+            }
+            else
+            {
+                result.guardIntact = result.guardIntact && IDs[i] == GuardID && flipFlags[i] == GuardFlags;
+            }
+        }
+        return result;
+    }
+
+    //GIDs with every combination of the four flag bits, in an order
+    //which puts different flags in each lane of the vector versions
+    std::vector<std::uint32_t> makeGIDs(std::size_t count, std::uint32_t seed)
+    {
+        std::vector<std::uint32_t> result;
+        for (auto i = 0u; i < count; ++i)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            const auto flags = static_cast<std::uint32_t>((i * 7 + (seed >> 28)) & 15);
+            result.push_back((flags << 28) | (seed & ~GIDFlagMask));
+        }
+        return result;
+    }
+
+    //unpacks the GIDs with both the scalar version and the version
+    //selected for this CPU, and checks that the results are the same
+    void compare(const std::vector<std::uint32_t>& GIDs, std::size_t offset)
+    {
+        const auto scalar = unpack(unpackGIDsScalar, GIDs, offset);
+        const auto dispatched = unpack(unpackGIDs, GIDs, offset);
+
+        if (!TMX_CHECK(scalar.guardIntact) || !TMX_CHECK(dispatched.guardIntact)
+            || !TMX_CHECK(scalar.IDs == dispatched.IDs) || !TMX_CHECK(scalar.flipFlags == dispatched.flipFlags))
+        {
+            std::cerr << "    count: " << GIDs.size() - offset << ", offset: " << offset << std::endl;
+        }
+    }
+
+    void testFlagCombinations()
+    {
+        const std::uint32_t IDs[] = { 0u, 1u, 0x12345u, 0x0fffffffu };
+
+        std::vector<std::uint32_t> GIDs;
+        for (auto ID : IDs)
+        {
+            for (std::uint32_t flags = 0; flags < 16; ++flags)
+            {
+                GIDs.push_back((flags << 28) | ID);
+            }
+        }
+
+        const auto scalar = unpack(unpackGIDsScalar, GIDs, 0);
+        bool split = true;
+        for (auto i = 0u; i < GIDs.size(); ++i)
+        {
+            split = split && scalar.IDs[i] == IDs[i / 16] && scalar.flipFlags[i] == i % 16;
+        }
+        TMX_CHECK(split);
+
+        compare(GIDs, 0);
+    }
+
+    void testLengths()
+    {
+        //covers the scalar tails after every block size of the
+        //vector versions, and lengths which aren't multiples of them
+        for (std::size_t count = 0; count < 140; ++count)
+        {
+            for (std::size_t offset = 0; offset < 4; ++offset)
+            {
+                compare(makeGIDs(count + offset, static_cast<std::uint32_t>(count * 4 + offset)), offset);
+            }
+        }
+
+        const std::size_t counts[] = { 255, 256, 257, 1021, 4096, 4099 };
+        for (auto count : counts)
+        {
+            compare(makeGIDs(count, static_cast<std::uint32_t>(count)), 0);
+            compare(makeGIDs(count + 1, static_cast<std::uint32_t>(count)), 1);
+        }
+    }
+}
+
+int main()
+{
+    testFlagCombinations();
+    testLengths();
+
+    return tmx::test::result("GidTests");
+}
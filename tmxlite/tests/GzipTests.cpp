@@ -0,0 +1,434 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#include "Test.hpp"
+
+#include "detail/DecompressionContext.hpp"
+#include "detail/Gzip.hpp"
+#include "detail/TileDataReader.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace tmx::detail;
+
+namespace
+{
+    enum Flags
+    {
+        HeaderCRC = 0x2,
+        Extra = 0x4,
+        Name = 0x8,
+        Comment = 0x10
+    };
+
+    //bytes of base64 which the reader decodes at a time
+    constexpr std::size_t InputWindow = 3072;
+
+    using Bytes = std::vector<unsigned char>;
+
+    struct Header final
+    {
+        int flags = 0;
+        std::size_t extraSize = 0;
+        std::size_t nameSize = 0;
+        std::size_t commentSize = 0;
+    };
+
+    std::uint32_t referenceCrc32(const unsigned char* data, std::size_t size)
+    {
+        std::uint32_t crc = 0xffffffff;
+        for (auto i = 0u; i < size; ++i)
+        {
+            crc ^= data[i];
+            for (auto j = 0; j < 8; ++j)
+            {
+                crc = (crc >> 1) ^ ((crc & 1) ? 0xedb88320u : 0u);
+            }
+        }
+        return ~crc;
+    }
+
+    void writeValue(Bytes& output, std::uint32_t value, std::size_t size)
+    {
+        for (auto i = 0u; i < size; ++i)
+        {
+            output.push_back(static_cast<unsigned char>(value >> (i * 8)));
+        }
+    }
+
+    Bytes makeHeader(const Header& header)
+    {
+        Bytes output = { 0x1f, 0x8b, 8, static_cast<unsigned char>(header.flags), 0, 0, 0, 0, 0, 3 };
+        if (header.flags & Extra)
+        {
+            writeValue(output, static_cast<std::uint32_t>(header.extraSize), 2);
+            for (auto i = 0u; i < header.extraSize; ++i)
+            {
+                output.push_back(static_cast<unsigned char>(i));
+            }
+        }
+
+        if (header.flags & Name)
+        {
+            output.insert(output.end(), header.nameSize, 'n');
+            output.push_back(0);
+        }
+
+        if (header.flags & Comment)
+        {
+            output.insert(output.end(), header.commentSize, 'c');
+            output.push_back(0);
+        }
+
+        if (header.flags & HeaderCRC)
+        {
+            writeValue(output, referenceCrc32(output.data(), output.size()) & 0xffff, 2);
+        }
+        return output;
+    }
+
+    Bytes deflateRaw(const Bytes& input)
+    {
+        z_stream stream = {};
+        deflateInit2(&stream, 6, Z_DEFLATED, -15, 9, Z_DEFAULT_STRATEGY);
+
+        Bytes output(deflateBound(&stream, static_cast<unsigned long>(input.size())));
+        stream.next_in = const_cast<unsigned char*>(input.data());
+        stream.avail_in = static_cast<unsigned int>(input.size());
+        stream.next_out = output.data();
+        stream.avail_out = static_cast<unsigned int>(output.size());
+        deflate(&stream, Z_FINISH);
+
+        output.resize(output.size() - stream.avail_out);
+        deflateEnd(&stream);
+        return output;
+    }
+
+    Bytes makeGzip(const Bytes& input, const Header& header = {})
+    {
+        auto output = makeHeader(header);
+        const auto data = deflateRaw(input);
+        output.insert(output.end(), data.begin(), data.end());
+        writeValue(output, referenceCrc32(input.data(), input.size()), 4);
+        writeValue(output, static_cast<std::uint32_t>(input.size()), 4);
+        return output;
+    }
+
+    std::string encodeBase64(const Bytes& input)
+    {
+        const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string output;
+        for (std::size_t i = 0; i < input.size(); i += 3)
+        {
+            std::uint32_t value = input[i] << 16;
+            if (i + 1 < input.size()) value |= input[i + 1] << 8;
+            if (i + 2 < input.size()) value |= input[i + 2];
+
+            output.push_back(alphabet[(value >> 18) & 63]);
+            output.push_back(alphabet[(value >> 12) & 63]);
+            output.push_back(i + 1 < input.size() ? alphabet[(value >> 6) & 63] : '=');
+            output.push_back(i + 2 < input.size() ? alphabet[value & 63] : '=');
+        }
+        return output;
+    }
+
+    std::vector<std::uint32_t> makeGIDs(std::size_t count)
+    {
+        std::vector<std::uint32_t> GIDs(count);
+        std::uint32_t seed = 1;
+        for (auto i = 0u; i < count; ++i)
+        {
+            //runs of repeated tiles, as in a real map, with the odd flipped tile
+            seed = seed * 1664525u + 1013904223u;
+            GIDs[i] = (i % 7 == 0) ? (seed >> 20) | ((seed & 7) << 29) : (i / 16) % 50;
+        }
+        return GIDs;
+    }
+
+    Bytes toBytes(const std::vector<std::uint32_t>& GIDs)
+    {
+        Bytes output;
+        for (auto GID : GIDs)
+        {
+            writeValue(output, GID, 4);
+        }
+        return output;
+    }
+
+    //reads the data as TileLayer does, in blocks until a read comes up short
+    std::vector<std::uint32_t> readGIDs(const std::string& data, std::size_t expectedCount, std::size_t blockSize, bool& failed)
+    {
+        TileDataReader reader(data.data(), data.size(), tmx::TileLayer::CompressionType::GZip, nullptr, expectedCount);
+
+        std::vector<std::uint32_t> output;
+        std::size_t count = 0;
+        do
+        {
+            output.resize(output.size() + blockSize);
+            count = reader.read(output.data() + output.size() - blockSize, blockSize);
+            output.resize(output.size() - blockSize + count);
+        } while (count == blockSize && !reader.failed());
+
+        failed = reader.failed();
+        return output;
+    }
+
+    //checks that the data is read correctly both whole and in small blocks
+    bool checkRead(const Bytes& gzip, const std::vector<std::uint32_t>& expected)
+    {
+        const auto data = encodeBase64(gzip);
+        for (auto blockSize : { expected.size() + 1, std::size_t(7), std::size_t(1024) })
+        {
+            bool failed = true;
+            const auto GIDs = readGIDs(data, expected.size(), blockSize, failed);
+            if (!TMX_CHECK(!failed) || !TMX_CHECK(GIDs == expected))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool checkFails(const Bytes& gzip, std::size_t expectedCount)
+    {
+        const auto data = encodeBase64(gzip);
+        for (auto blockSize : { expectedCount + 1, std::size_t(7) })
+        {
+            bool failed = false;
+            readGIDs(data, expectedCount, blockSize, failed);
+            if (!TMX_CHECK(failed))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void testCrc32()
+    {
+        const std::string check = "123456789";
+        TMX_CHECK(gzipCrc32(0, reinterpret_cast<const unsigned char*>(check.data()), check.size()) == 0xcbf43926);
+
+        const auto data = toBytes(makeGIDs(64));
+        for (std::size_t offset = 0; offset < 8; ++offset)
+        {
+            for (std::size_t size = 0; size + offset <= data.size(); ++size)
+            {
+                const auto* start = data.data() + offset;
+                const auto expected = referenceCrc32(start, size);
+                TMX_CHECK(gzipCrc32(0, start, size) == expected);
+
+                //checksums can be built up from any number of pieces
+                const auto split = size / 3;
+                TMX_CHECK(gzipCrc32(gzipCrc32(0, start, split), start + split, size - split) == expected);
+            }
+        }
+    }
+
+    void testHeaders()
+    {
+        for (int flags = 0; flags < 0x20; flags += 2)
+        {
+            Header header;
+            header.flags = flags;
+            header.extraSize = 5;
+            header.nameSize = 8;
+            header.commentSize = 12;
+
+            const auto bytes = makeHeader(header);
+            TMX_CHECK(checkGzipFixedHeader(bytes.data(), bytes.size()));
+            TMX_CHECK(readGzipHeader(bytes.data(), bytes.size()) == bytes.size());
+
+            //any trailing data is not part of the header
+            auto withData = bytes;
+            withData.insert(withData.end(), 16, 0);
+            TMX_CHECK(readGzipHeader(withData.data(), withData.size()) == bytes.size());
+
+            //incomplete headers are rejected, but the fixed part is still
+            //reported as valid so that more data can be read
+            for (std::size_t size = 0; size < bytes.size(); ++size)
+            {
+                TMX_CHECK(readGzipHeader(bytes.data(), size) == 0);
+                TMX_CHECK(checkGzipFixedHeader(bytes.data(), size) == (size >= GzipFixedHeaderSize));
+            }
+        }
+
+        const auto valid = makeHeader({});
+        auto method = valid;
+        method[2] = 7;
+        TMX_CHECK(!checkGzipFixedHeader(method.data(), method.size()));
+        TMX_CHECK(readGzipHeader(method.data(), method.size()) == 0);
+
+        auto reserved = valid;
+        reserved[3] = 0x20;
+        TMX_CHECK(!checkGzipFixedHeader(reserved.data(), reserved.size()));
+        TMX_CHECK(readGzipHeader(reserved.data(), reserved.size()) == 0);
+
+        auto magic = valid;
+        magic[1] = 0x8c;
+        TMX_CHECK(!isGzip(magic.data(), magic.size()));
+        TMX_CHECK(readGzipHeader(magic.data(), magic.size()) == 0);
+    }
+
+    void testTrailer()
+    {
+        const auto data = toBytes(makeGIDs(100));
+        Bytes trailer;
+        writeValue(trailer, referenceCrc32(data.data(), data.size()), 4);
+        writeValue(trailer, static_cast<std::uint32_t>(data.size()), 4);
+
+        const auto crc = gzipCrc32(0, data.data(), data.size());
+        TMX_CHECK(checkGzipTrailer(trailer.data(), crc, data.size()));
+        TMX_CHECK(!checkGzipTrailer(trailer.data(), crc ^ 1, data.size()));
+        TMX_CHECK(!checkGzipTrailer(trailer.data(), crc, data.size() + 1));
+
+        //sizes are stored modulo 2^32
+        TMX_CHECK(checkGzipTrailer(trailer.data(), crc, data.size() + 0x100000000ull));
+    }
+
+    //all combinations of the optional header fields, with data
+    //which fits in one input window and data which needs several
+    void testReadHeaders()
+    {
+        for (auto count : { std::size_t(16), std::size_t(20000) })
+        {
+            const auto GIDs = makeGIDs(count);
+            const auto bytes = toBytes(GIDs);
+            for (int flags = 0; flags < 0x20; flags += 2)
+            {
+                Header header;
+                header.flags = flags;
+                header.extraSize = 20;
+                header.nameSize = 10;
+                header.commentSize = 30;
+                checkRead(makeGzip(bytes, header), GIDs);
+            }
+        }
+    }
+
+    //headers which don't fit in the first input window, including
+    //those where the deflate data starts at either edge of a window
+    void testReadLargeHeaders()
+    {
+        for (auto count : { std::size_t(16), std::size_t(20000) })
+        {
+            const auto GIDs = makeGIDs(count);
+            const auto bytes = toBytes(GIDs);
+
+            for (auto windows : { 1, 2, 3 })
+            {
+                //the fixed header and the extra field's size are 12 bytes
+                const auto base = InputWindow * windows - 12;
+                for (auto extraSize = base - 4; extraSize <= base + 4; ++extraSize)
+                {
+                    Header header;
+                    header.flags = Extra;
+                    header.extraSize = extraSize;
+                    checkRead(makeGzip(bytes, header), GIDs);
+                }
+            }
+
+            Header header;
+            header.flags = Name | Comment | HeaderCRC;
+            header.nameSize = 5000;
+            header.commentSize = 10000;
+            checkRead(makeGzip(bytes, header), GIDs);
+
+            header.flags = Extra | Name | Comment | HeaderCRC;
+            header.extraSize = 65535;
+            checkRead(makeGzip(bytes, header), GIDs);
+        }
+    }
+
+    void testReadErrors()
+    {
+        for (auto count : { std::size_t(16), std::size_t(20000) })
+        {
+            const auto bytes = toBytes(makeGIDs(count));
+            const auto gzip = makeGzip(bytes);
+
+            //each byte of the CRC32 then of the size
+            for (std::size_t i = 1; i <= GzipTrailerSize; ++i)
+            {
+                auto corrupt = gzip;
+                corrupt[corrupt.size() - i] ^= 0x10;
+                checkFails(corrupt, count);
+            }
+
+            for (std::size_t i = 1; i <= GzipTrailerSize; ++i)
+            {
+                checkFails(Bytes(gzip.begin(), gzip.end() - i), count);
+            }
+
+            for (auto junkSize : { 1, 4, 8, 9, 5000 })
+            {
+                auto junk = gzip;
+                junk.insert(junk.end(), junkSize, 0x55);
+                checkFails(junk, count);
+            }
+
+            //a second member is not supported, so is also reported
+            auto second = gzip;
+            second.insert(second.end(), gzip.begin(), gzip.end());
+            checkFails(second, count);
+
+            //headers which are invalid or run to the end of the data
+            auto method = gzip;
+            method[2] = 7;
+            checkFails(method, count);
+
+            auto reserved = gzip;
+            reserved[3] |= 0x80;
+            checkFails(reserved, count);
+
+            Header header;
+            header.flags = Name;
+            header.nameSize = 4000;
+            auto unterminated = makeHeader(header);
+            unterminated.pop_back();
+            checkFails(unterminated, count);
+
+            header.flags = Extra;
+            header.extraSize = 8000;
+            auto extra = makeHeader(header);
+            extra.resize(7000);
+            checkFails(extra, count);
+        }
+    }
+}
+
+int main()
+{
+    testCrc32();
+    testHeaders();
+    testTrailer();
+    testReadHeaders();
+    testReadLargeHeaders();
+    testReadErrors();
+
+    return tmx::test::result("GzipTests");
+}
@@ -0,0 +1,307 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#pragma once
+
+#include "Test.hpp"
+
+#include <tmxlite/Map.hpp>
+#include <tmxlite/ImageLayer.hpp>
+#include <tmxlite/LayerGroup.hpp>
+#include <tmxlite/ObjectGroup.hpp>
+#include <tmxlite/TileLayer.hpp>
+#include <tmxlite/Tileset.hpp>
+
+#include <algorithm>
+#include <vector>
+
+//checks that two maps hold the same data, for tests which load
+//the same map in different ways. The checks are made with TMX_CHECK
+//so that any differences are reported where they are found.
+namespace tmx
+{
+    namespace test
+    {
+        template <typename T>
+        bool operator == (const Vector2<T>& l, const Vector2<T>& r)
+        {
+            return l.x == r.x && l.y == r.y;
+        }
+
+        template <typename T>
+        bool operator == (const Rectangle<T>& l, const Rectangle<T>& r)
+        {
+            return l.left == r.left && l.top == r.top && l.width == r.width && l.height == r.height;
+        }
+
+        template <typename Tiles>
+        bool sameTiles(const Tiles& a, const Tiles& b)
+        {
+            if (a.size() != b.size())
+            {
+                return false;
+            }
+
+            for (auto i = 0u; i < a.size(); ++i)
+            {
+                if (a[i].ID != b[i].ID || a[i].flipFlags != b[i].flipFlags)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template <typename Properties>
+        void compareProperties(const Properties& a, const Properties& b)
+        {
+            if (!TMX_CHECK(a.size() == b.size()))
+            {
+                return;
+            }
+
+            for (auto i = 0u; i < a.size(); ++i)
+            {
+                TMX_CHECK(a[i].getName() == b[i].getName());
+                if (!TMX_CHECK(a[i].getType() == b[i].getType()))
+                {
+                    continue;
+                }
+
+                switch (a[i].getType())
+                {
+                default: break;
+                case Property::Type::Boolean:
+                    TMX_CHECK(a[i].getBoolValue() == b[i].getBoolValue());
+                    break;
+                case Property::Type::Float:
+                    TMX_CHECK(a[i].getFloatValue() == b[i].getFloatValue());
+                    break;
+                case Property::Type::Int:
+                case Property::Type::Object:
+                    TMX_CHECK(a[i].getIntValue() == b[i].getIntValue());
+                    break;
+                case Property::Type::String:
+                    TMX_CHECK(a[i].getStringValue() == b[i].getStringValue());
+                    break;
+                case Property::Type::Colour:
+                    TMX_CHECK(a[i].getColourValue() == b[i].getColourValue());
+                    break;
+                case Property::Type::File:
+                    TMX_CHECK(a[i].getFileValue() == b[i].getFileValue());
+                    break;
+                case Property::Type::Class:
+                    compareProperties(a[i].getClassValue(), b[i].getClassValue());
+                    break;
+                }
+            }
+        }
+
+        inline void compareObjects(const Object& a, const Object& b)
+        {
+            TMX_CHECK(a.getUID() == b.getUID());
+            TMX_CHECK(a.getName() == b.getName());
+            TMX_CHECK(a.getClass() == b.getClass());
+            TMX_CHECK(a.getPosition() == b.getPosition());
+            TMX_CHECK(a.getAABB() == b.getAABB());
+            TMX_CHECK(a.getRotation() == b.getRotation());
+            TMX_CHECK(a.getTileID() == b.getTileID());
+            TMX_CHECK(a.getFlipFlags() == b.getFlipFlags());
+            TMX_CHECK(a.visible() == b.visible());
+            TMX_CHECK(a.getShape() == b.getShape());
+            TMX_CHECK(a.getTilesetName() == b.getTilesetName());
+
+            if (TMX_CHECK(a.getPoints().size() == b.getPoints().size()))
+            {
+                for (auto i = 0u; i < a.getPoints().size(); ++i)
+                {
+                    TMX_CHECK(a.getPoints()[i] == b.getPoints()[i]);
+                }
+            }
+
+            const auto& textA = a.getText();
+            const auto& textB = b.getText();
+            TMX_CHECK(textA.content == textB.content);
+            TMX_CHECK(textA.fontFamily == textB.fontFamily);
+            TMX_CHECK(textA.pixelSize == textB.pixelSize);
+            TMX_CHECK(textA.colour == textB.colour);
+            TMX_CHECK(textA.wrap == textB.wrap && textA.bold == textB.bold && textA.italic == textB.italic);
+            TMX_CHECK(textA.kerning == textB.kerning && textA.strikethough == textB.strikethough && textA.underline == textB.underline);
+            TMX_CHECK(textA.hAlign == textB.hAlign && textA.vAlign == textB.vAlign);
+
+            compareProperties(a.getProperties(), b.getProperties());
+        }
+
+        template <typename Objects>
+        void compareObjects(const Objects& a, const Objects& b)
+        {
+            if (TMX_CHECK(a.size() == b.size()))
+            {
+                for (auto i = 0u; i < a.size(); ++i)
+                {
+                    compareObjects(a[i], b[i]);
+                }
+            }
+        }
+
+        inline void compareLayers(const std::vector<Layer::Ptr>& a, const std::vector<Layer::Ptr>& b)
+        {
+            if (!TMX_CHECK(a.size() == b.size()))
+            {
+                return;
+            }
+
+            for (auto i = 0u; i < a.size(); ++i)
+            {
+                const auto& layerA = *a[i];
+                const auto& layerB = *b[i];
+                TMX_CHECK(layerA.getName() == layerB.getName());
+                TMX_CHECK(layerA.getClass() == layerB.getClass());
+                TMX_CHECK(layerA.getOpacity() == layerB.getOpacity());
+                TMX_CHECK(layerA.getVisible() == layerB.getVisible());
+                TMX_CHECK(layerA.getOffset() == layerB.getOffset());
+                TMX_CHECK(layerA.getSize() == layerB.getSize());
+                compareProperties(layerA.getProperties(), layerB.getProperties());
+
+                if (!TMX_CHECK(layerA.getType() == layerB.getType()))
+                {
+                    continue;
+                }
+
+                switch (layerA.getType())
+                {
+                default: break;
+                case Layer::Type::Tile:
+                {
+                    const auto& tilesA = layerA.getLayerAs<TileLayer>();
+                    const auto& tilesB = layerB.getLayerAs<TileLayer>();
+                    TMX_CHECK(sameTiles(tilesA.getTiles(), tilesB.getTiles()));
+
+                    const auto& chunksA = tilesA.getChunks();
+                    const auto& chunksB = tilesB.getChunks();
+                    if (TMX_CHECK(chunksA.size() == chunksB.size()))
+                    {
+                        for (auto j = 0u; j < chunksA.size(); ++j)
+                        {
+                            TMX_CHECK(chunksA[j].position == chunksB[j].position);
+                            TMX_CHECK(chunksA[j].size == chunksB[j].size);
+                            TMX_CHECK(sameTiles(chunksA[j].tiles, chunksB[j].tiles));
+                        }
+                    }
+                }
+                    break;
+                case Layer::Type::Object:
+                {
+                    const auto& groupA = layerA.getLayerAs<ObjectGroup>();
+                    const auto& groupB = layerB.getLayerAs<ObjectGroup>();
+                    TMX_CHECK(groupA.getDrawOrder() == groupB.getDrawOrder());
+                    TMX_CHECK(groupA.getColour() == groupB.getColour());
+                    compareObjects(groupA.getObjects(), groupB.getObjects());
+                }
+                    break;
+                case Layer::Type::Image:
+                {
+                    const auto& imageA = layerA.getLayerAs<ImageLayer>();
+                    const auto& imageB = layerB.getLayerAs<ImageLayer>();
+                    TMX_CHECK(imageA.getImagePath() == imageB.getImagePath());
+                    TMX_CHECK(imageA.getImageSize() == imageB.getImageSize());
+                    TMX_CHECK(imageA.hasTransparency() == imageB.hasTransparency());
+                    TMX_CHECK(imageA.getTransparencyColour() == imageB.getTransparencyColour());
+                    TMX_CHECK(imageA.hasRepeatX() == imageB.hasRepeatX() && imageA.hasRepeatY() == imageB.hasRepeatY());
+                }
+                    break;
+                case Layer::Type::Group:
+                    compareLayers(layerA.getLayerAs<LayerGroup>().getLayers(), layerB.getLayerAs<LayerGroup>().getLayers());
+                    break;
+                }
+            }
+        }
+
+        inline void compareTilesets(const Tileset& a, const Tileset& b)
+        {
+            TMX_CHECK(a.getFirstGID() == b.getFirstGID());
+            TMX_CHECK(a.getLastGID() == b.getLastGID());
+            TMX_CHECK(a.getName() == b.getName());
+            TMX_CHECK(a.getTileSize() == b.getTileSize());
+            TMX_CHECK(a.getSpacing() == b.getSpacing() && a.getMargin() == b.getMargin());
+            TMX_CHECK(a.getTileCount() == b.getTileCount());
+            TMX_CHECK(a.getColumnCount() == b.getColumnCount());
+            TMX_CHECK(a.getImagePath() == b.getImagePath());
+            TMX_CHECK(a.getImageSize() == b.getImageSize());
+            compareProperties(a.getProperties(), b.getProperties());
+
+            const auto& tilesA = a.getTiles();
+            const auto& tilesB = b.getTiles();
+            if (!TMX_CHECK(tilesA.size() == tilesB.size()))
+            {
+                return;
+            }
+
+            for (auto i = 0u; i < tilesA.size(); ++i)
+            {
+                TMX_CHECK(tilesA[i].ID == tilesB[i].ID);
+                TMX_CHECK(tilesA[i].imagePath == tilesB[i].imagePath);
+                TMX_CHECK(tilesA[i].imagePosition == tilesB[i].imagePosition);
+                TMX_CHECK(tilesA[i].imageSize == tilesB[i].imageSize);
+                TMX_CHECK(tilesA[i].animation.frames.size() == tilesB[i].animation.frames.size()
+                    && std::equal(tilesA[i].animation.frames.begin(), tilesA[i].animation.frames.end(), tilesB[i].animation.frames.begin()));
+                compareProperties(tilesA[i].properties, tilesB[i].properties);
+                compareObjects(tilesA[i].objectGroup.getObjects(), tilesB[i].objectGroup.getObjects());
+            }
+
+            //lookups of tiles which declare nothing but their image
+            for (auto ID = 0u; ID < a.getTileCount(); ++ID)
+            {
+                const auto viewA = a.getTile(a.getFirstGID() + ID);
+                const auto viewB = b.getTile(b.getFirstGID() + ID);
+                TMX_CHECK(bool(viewA) == bool(viewB));
+                TMX_CHECK((viewA.getData() == nullptr) == (viewB.getData() == nullptr));
+                TMX_CHECK(viewA.getImagePosition() == viewB.getImagePosition());
+            }
+        }
+
+        inline void compareMaps(const Map& a, const Map& b)
+        {
+            TMX_CHECK(a.getOrientation() == b.getOrientation());
+            TMX_CHECK(a.getRenderOrder() == b.getRenderOrder());
+            TMX_CHECK(a.getTileCount() == b.getTileCount());
+            TMX_CHECK(a.getTileSize() == b.getTileSize());
+            TMX_CHECK(a.isInfinite() == b.isInfinite());
+            TMX_CHECK(a.getBackgroundColour() == b.getBackgroundColour());
+            compareProperties(a.getProperties(), b.getProperties());
+
+            if (TMX_CHECK(a.getTilesets().size() == b.getTilesets().size()))
+            {
+                for (auto i = 0u; i < a.getTilesets().size(); ++i)
+                {
+                    compareTilesets(a.getTilesets()[i], b.getTilesets()[i]);
+                }
+            }
+
+            TMX_CHECK(a.getAnimatedTiles().size() == b.getAnimatedTiles().size());
+            compareLayers(a.getLayers(), b.getLayers());
+        }
+    }
+}
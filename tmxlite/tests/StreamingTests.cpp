@@ -0,0 +1,162 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#include "MapComparison.hpp"
+
+#include <string>
+
+using namespace tmx;
+
+namespace
+{
+    const std::string AssetPath = TEST_ASSETS_PATH;
+    const std::string MapFiles[] = { "finite.json", "infinite.json" };
+
+    bool load(Map& map, const std::string& file, Map::ParseMode mode)
+    {
+        map.setParseMode(mode);
+        return map.load(AssetPath + file);
+    }
+
+    //a few values from the map files, so that the two modes
+    //can't pass by both reading something wrong in the same way
+    void checkContents(const Map& map)
+    {
+        const auto& properties = map.getProperties();
+        if (TMX_CHECK(properties.size() == 7))
+        {
+            TMX_CHECK(properties[0].getType() == Property::Type::Boolean && properties[0].getBoolValue());
+            TMX_CHECK(properties[4].getType() == Property::Type::Int && properties[4].getIntValue() == -12);
+            TMX_CHECK(properties[6].getType() == Property::Type::String && properties[6].getStringValue() == "text");
+        }
+
+        const auto& tilesets = map.getTilesets();
+        if (!TMX_CHECK(tilesets.size() == 2))
+        {
+            return;
+        }
+        TMX_CHECK(tilesets[0].getFirstGID() == 1 && tilesets[0].getTileCount() == 20);
+        TMX_CHECK(tilesets[1].getFirstGID() == 21 && tilesets[1].getMargin() == 1 && tilesets[1].getSpacing() == 2);
+
+        const Tileset::Tile* animated = nullptr;
+        for (const auto& tile : tilesets[0].getTiles())
+        {
+            animated = tile.ID == 5 ? &tile : animated;
+        }
+        if (TMX_CHECK(animated != nullptr) && TMX_CHECK(animated->animation.frames.size() == 3))
+        {
+            TMX_CHECK(animated->animation.frames[0].tileID == 6 && animated->animation.frames[0].duration == 100);
+            TMX_CHECK(animated->animation.frames[2].tileID == 8 && animated->animation.frames[2].duration == 50);
+        }
+
+        const auto& layers = map.getLayers();
+        if (!TMX_CHECK(layers.size() == 8))
+        {
+            return;
+        }
+
+        const auto& tileLayer = layers[1]->getLayerAs<TileLayer>();
+        if (map.isInfinite())
+        {
+            TMX_CHECK(tileLayer.getChunks().size() == 6);
+        }
+        else
+        {
+            TMX_CHECK(tileLayer.getTiles().size() == 120);
+        }
+
+        const auto& objects = layers[5]->getLayerAs<ObjectGroup>().getObjects();
+        if (TMX_CHECK(objects.size() == 8))
+        {
+            TMX_CHECK(!objects[2].visible() && objects[3].visible());
+            TMX_CHECK(objects[5].getText().bold && objects[5].getText().wrap && !objects[5].getText().italic);
+            TMX_CHECK(objects[6].getTileID() == 23 && objects[6].getFlipFlags() == TileLayer::FlipFlag::Horizontal);
+
+            //properties not set by the object come from its template
+            TMX_CHECK(objects[7].getName() == "template");
+            TMX_CHECK(objects[7].getProperties().size() == 1);
+        }
+
+        const auto& image = layers[7]->getLayerAs<ImageLayer>();
+        TMX_CHECK(image.hasRepeatX() && !image.hasRepeatY());
+    }
+
+    void compareTemplates(const Map& a, const Map& b)
+    {
+        const auto& objectsA = a.getTemplateObjects();
+        const auto& objectsB = b.getTemplateObjects();
+        if (TMX_CHECK(objectsA.size() == objectsB.size() && !objectsA.empty()))
+        {
+            for (const auto& object : objectsA)
+            {
+                const auto result = objectsB.find(object.first);
+                if (TMX_CHECK(result != objectsB.end()))
+                {
+                    test::compareObjects(object.second, result->second);
+                }
+            }
+        }
+
+        const auto& tilesetsA = a.getTemplateTilesets();
+        const auto& tilesetsB = b.getTemplateTilesets();
+        if (TMX_CHECK(tilesetsA.size() == tilesetsB.size()))
+        {
+            for (const auto& tileset : tilesetsA)
+            {
+                const auto result = tilesetsB.find(tileset.first);
+                if (TMX_CHECK(result != tilesetsB.end()))
+                {
+                    test::compareTilesets(tileset.second, result->second);
+                }
+            }
+        }
+    }
+
+    void testModes()
+    {
+        for (const auto& file : MapFiles)
+        {
+            Map document;
+            Map streamed;
+            if (!TMX_CHECK(load(document, file, Map::ParseMode::Document))
+                || !TMX_CHECK(load(streamed, file, Map::ParseMode::Streaming)))
+            {
+                continue;
+            }
+
+            checkContents(document);
+            checkContents(streamed);
+            test::compareMaps(document, streamed);
+            compareTemplates(document, streamed);
+        }
+    }
+}
+
+int main()
+{
+    testModes();
+
+    return tmx::test::result("StreamingTests");
+}
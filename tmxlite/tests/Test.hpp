@@ -0,0 +1,68 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#pragma once
+
+#include <iostream>
+
+//a minimal set of checks shared by the unit tests. Each test is a
+//separate executable which returns non-zero if any check fails.
+namespace tmx
+{
+    namespace test
+    {
+        inline int& failureCount()
+        {
+            static int count = 0;
+            return count;
+        }
+
+        inline bool check(bool result, const char* expression, const char* file, int line)
+        {
+            if (!result)
+            {
+                std::cerr << file << "(" << line << "): check failed: " << expression << std::endl;
+                failureCount()++;
+            }
+            return result;
+        }
+
+        /*!
+        \brief Prints a summary and returns the exit code for the test
+        */
+        inline int result(const char* name)
+        {
+            if (failureCount() == 0)
+            {
+                std::cout << name << ": passed" << std::endl;
+                return 0;
+            }
+            std::cerr << name << ": " << failureCount() << " checks failed" << std::endl;
+            return 1;
+        }
+    }
+}
+
+#define TMX_CHECK(x) tmx::test::check((x), #x, __FILE__, __LINE__)
@@ -0,0 +1,434 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#include "Test.hpp"
+
+#include <tmxlite/Map.hpp>
+#include <tmxlite/LayerGroup.hpp>
+#include <tmxlite/TileLayer.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace tmx;
+
+namespace
+{
+    const std::string AssetPath = TEST_ASSETS_PATH;
+    const std::string MapFiles[] = { "finite.json", "infinite.json" };
+
+    using Tile = TileLayer::Tile;
+
+    bool sameTile(const Tile& l, const Tile& r)
+    {
+        return l.ID == r.ID && l.flipFlags == r.flipFlags;
+    }
+
+    bool sameTiles(const std::vector<Tile>& l, const std::vector<Tile>& r)
+    {
+        return l.size() == r.size() && std::equal(l.begin(), l.end(), r.begin(), sameTile);
+    }
+
+    bool isEmpty(const Tile& tile)
+    {
+        return tile.ID == 0 && tile.flipFlags == 0;
+    }
+
+    std::uint32_t toGID(const Tile& tile)
+    {
+        return tile.ID | (std::uint32_t(tile.flipFlags) << 28);
+    }
+
+    void addTileLayers(const std::vector<Layer::Ptr>& layers, std::vector<const TileLayer*>& output)
+    {
+        for (const auto& layer : layers)
+        {
+            if (layer->getType() == Layer::Type::Tile)
+            {
+                output.push_back(&layer->getLayerAs<TileLayer>());
+            }
+            else if (layer->getType() == Layer::Type::Group)
+            {
+                addTileLayers(layer->getLayerAs<LayerGroup>().getLayers(), output);
+            }
+        }
+    }
+
+    std::vector<const TileLayer*> getTileLayers(const Map& map)
+    {
+        std::vector<const TileLayer*> output;
+        addTileLayers(map.getLayers(), output);
+        return output;
+    }
+
+    //the tiles of a layer loaded with TileStorage::Tiles, which
+    //the layers loaded with every other storage are compared to
+    struct Reference final
+    {
+        const TileLayer* layer = nullptr;
+        int left = 0;
+        int top = 0;
+        int right = 0;
+        int bottom = 0;
+        float filled = 0.f;
+
+        explicit Reference(const TileLayer& tileLayer)
+            : layer(&tileLayer)
+        {
+            std::size_t count = 0;
+            std::size_t nonEmpty = 0;
+            const auto countTiles = [&](const std::vector<Tile>& tiles)
+            {
+                for (const auto& tile : tiles)
+                {
+                    nonEmpty += isEmpty(tile) ? 0 : 1;
+                }
+                count += tiles.size();
+            };
+
+            const auto& chunks = layer->getChunks();
+            if (chunks.empty())
+            {
+                right = static_cast<int>(layer->getSize().x);
+                bottom = static_cast<int>(layer->getSize().y);
+                countTiles(layer->getTiles());
+            }
+            else
+            {
+                left = top = std::numeric_limits<int>::max();
+                right = bottom = std::numeric_limits<int>::min();
+                for (const auto& chunk : chunks)
+                {
+                    left = std::min(left, chunk.position.x);
+                    top = std::min(top, chunk.position.y);
+                    right = std::max(right, chunk.position.x + chunk.size.x);
+                    bottom = std::max(bottom, chunk.position.y + chunk.size.y);
+                    countTiles(chunk.tiles);
+                }
+            }
+            filled = count != 0 ? static_cast<float>(nonEmpty) / static_cast<float>(count) : 0.f;
+        }
+
+        //found without TileLayer::getTile() or the chunk index
+        Tile getTile(int x, int y) const
+        {
+            const auto& chunks = layer->getChunks();
+            if (chunks.empty())
+            {
+                if (x < 0 || y < 0 || x >= right || y >= bottom)
+                {
+                    return {};
+                }
+                return layer->getTiles()[std::size_t(y) * layer->getSize().x + std::size_t(x)];
+            }
+
+            for (const auto& chunk : chunks)
+            {
+                if (x >= chunk.position.x && x < chunk.position.x + chunk.size.x
+                    && y >= chunk.position.y && y < chunk.position.y + chunk.size.y)
+                {
+                    return chunk.tiles[std::size_t(y - chunk.position.y) * std::size_t(chunk.size.x) + std::size_t(x - chunk.position.x)];
+                }
+            }
+            return {};
+        }
+    };
+
+    //the tiles of a chunk in whichever form they are stored
+    std::vector<Tile> getChunkTiles(const TileLayer::Chunk& chunk, Map::TileStorage storage, bool sparse)
+    {
+        std::vector<Tile> output;
+        if (sparse)
+        {
+            for (auto i = 0u; i < chunk.sparse.size(); ++i)
+            {
+                output.push_back(chunk.sparse.getTile(i));
+            }
+            return output;
+        }
+
+        switch (storage)
+        {
+        default:
+        case Map::TileStorage::Tiles:
+            return chunk.tiles;
+        case Map::TileStorage::Arrays:
+            if (TMX_CHECK(chunk.tileIDs.size() == chunk.flipFlags.size()))
+            {
+                for (auto i = 0u; i < chunk.tileIDs.size(); ++i)
+                {
+                    Tile tile;
+                    tile.ID = chunk.tileIDs[i];
+                    tile.flipFlags = chunk.flipFlags[i];
+                    output.push_back(tile);
+                }
+            }
+            break;
+        case Map::TileStorage::GIDs:
+            for (auto GID : chunk.GIDs)
+            {
+                Tile tile;
+                tile.ID = GID & 0x0fffffff;
+                tile.flipFlags = static_cast<std::uint8_t>(GID >> 28);
+                output.push_back(tile);
+            }
+            break;
+        case Map::TileStorage::Palette:
+            for (auto i = 0u; i < chunk.palette.size(); ++i)
+            {
+                output.push_back(chunk.palette[i]);
+            }
+            break;
+        }
+        return output;
+    }
+
+    //every form of the tiles of a finite layer, which are created
+    //on request from whichever form is stored
+    void checkForms(const TileLayer& layer, const std::vector<Tile>& expected)
+    {
+        TMX_CHECK(sameTiles(layer.getTiles(), expected));
+
+        const auto IDs = layer.getTileIDs();
+        const auto flipFlags = layer.getFlipFlags();
+        const auto GIDs = layer.getGIDs();
+        const auto& palette = layer.getPalette();
+        const auto& sparse = layer.getSparseTiles();
+        if (!TMX_CHECK(IDs.size() == expected.size() && flipFlags.size() == expected.size()
+            && GIDs.size() == expected.size() && palette.size() == expected.size()
+            && sparse.size() == expected.size()))
+        {
+            return;
+        }
+
+        bool arraysMatch = true;
+        bool GIDsMatch = true;
+        bool paletteMatches = true;
+        bool sparseMatches = true;
+        for (auto i = 0u; i < expected.size(); ++i)
+        {
+            arraysMatch = arraysMatch && IDs[i] == expected[i].ID && flipFlags[i] == expected[i].flipFlags;
+            GIDsMatch = GIDsMatch && GIDs[i] == toGID(expected[i]);
+            paletteMatches = paletteMatches && sameTile(palette[i], expected[i]);
+            sparseMatches = sparseMatches && sameTile(sparse.getTile(i), expected[i]);
+        }
+        TMX_CHECK(arraysMatch);
+        TMX_CHECK(GIDsMatch);
+        TMX_CHECK(paletteMatches);
+        TMX_CHECK(sparseMatches);
+
+        //the palette and sparse tiles can also be walked in order
+        std::size_t position = 0;
+        palette.forEach([&](const Tile& tile)
+            {
+                paletteMatches = paletteMatches && sameTile(tile, expected[position++]);
+            });
+        TMX_CHECK(paletteMatches && position == expected.size());
+
+        std::size_t nonEmpty = 0;
+        sparse.forEach([&](std::size_t index, const Tile& tile)
+            {
+                sparseMatches = sparseMatches && !isEmpty(tile) && sameTile(tile, expected[index]);
+                nonEmpty++;
+            });
+        std::size_t expectedNonEmpty = 0;
+        for (const auto& tile : expected)
+        {
+            expectedNonEmpty += isEmpty(tile) ? 0 : 1;
+        }
+        TMX_CHECK(sparseMatches && nonEmpty == expectedNonEmpty);
+
+        std::vector<std::uint32_t> decoded(expected.size() + 1);
+        TMX_CHECK(layer.decodeGIDs(decoded.data(), decoded.size()) == expected.size());
+        decoded.pop_back();
+        TMX_CHECK(std::vector<std::uint32_t>(GIDs.begin(), GIDs.end()) == decoded);
+    }
+
+    void checkLayer(const TileLayer& layer, const Reference& reference, Map::TileStorage storage, float sparseThreshold)
+    {
+        //the tiles are looked up before any other form is requested,
+        //so that they are read from the stored form
+        bool tilesMatch = true;
+        for (auto y = reference.top - 2; y < reference.bottom + 2; ++y)
+        {
+            for (auto x = reference.left - 2; x < reference.right + 2; ++x)
+            {
+                tilesMatch = tilesMatch && sameTile(layer.getTile(x, y), reference.getTile(x, y));
+            }
+        }
+        TMX_CHECK(tilesMatch);
+
+        const bool sparse = reference.filled < sparseThreshold;
+        TMX_CHECK(layer.isSparse() == sparse);
+        TMX_CHECK(layer.hasTileArrays() == (!sparse && storage == Map::TileStorage::Arrays));
+        TMX_CHECK(layer.hasGIDs() == (!sparse && storage == Map::TileStorage::GIDs));
+        TMX_CHECK(layer.hasPalette() == (!sparse && storage == Map::TileStorage::Palette));
+
+        const auto& chunks = layer.getChunks();
+        const auto& referenceChunks = reference.layer->getChunks();
+        if (!TMX_CHECK(chunks.size() == referenceChunks.size()))
+        {
+            return;
+        }
+
+        for (auto i = 0u; i < chunks.size(); ++i)
+        {
+            TMX_CHECK(sameTiles(getChunkTiles(chunks[i], storage, sparse), referenceChunks[i].tiles));
+        }
+
+        if (chunks.empty())
+        {
+            checkForms(layer, reference.layer->getTiles());
+        }
+    }
+
+    void testStorage(const std::string& file, Map::TileDecoding decoding)
+    {
+        Map referenceMap;
+        if (!TMX_CHECK(referenceMap.load(AssetPath + file)))
+        {
+            return;
+        }
+
+        std::vector<Reference> references;
+        for (const auto* layer : getTileLayers(referenceMap))
+        {
+            references.emplace_back(*layer);
+        }
+
+        const Map::TileStorage storages[] =
+        {
+            Map::TileStorage::Tiles,
+            Map::TileStorage::Arrays,
+            Map::TileStorage::GIDs,
+            Map::TileStorage::Palette
+        };
+
+        //no sparse layers, only the mostly empty layer and every layer
+        const float thresholds[] = { 0.f, 0.25f, 1.1f };
+
+        for (auto storage : storages)
+        {
+            for (auto threshold : thresholds)
+            {
+                Map map;
+                map.setTileStorage(storage);
+                map.setSparseThreshold(threshold);
+                map.setTileDecoding(decoding);
+                if (!TMX_CHECK(map.load(AssetPath + file)))
+                {
+                    continue;
+                }
+
+                const auto layers = getTileLayers(map);
+                if (TMX_CHECK(layers.size() == references.size()))
+                {
+                    for (auto i = 0u; i < layers.size(); ++i)
+                    {
+                        checkLayer(*layers[i], references[i], storage, threshold);
+                    }
+                }
+            }
+        }
+    }
+
+    //chunks whose size is negative, or whose tile count doesn't fit
+    //in an int, are skipped rather than allocated
+    void testInvalidChunks(Map::ParseMode mode, Map::TileDecoding decoding)
+    {
+        const std::string chunks[] =
+        {
+            R"("width": 1, "height": 1, "x": 0, "y": 0)",
+            R"("width": -16, "height": 16, "x": 16, "y": 0)",
+            R"("width": 65536, "height": 65536, "x": 32, "y": 0)",
+            R"("width": 0, "height": 16, "x": 48, "y": 0)"
+        };
+
+        const std::string data[] = { "[ 1 ]", R"("AQAAAA==")" };
+        const std::string encodings[] = { "", R"("encoding": "base64",)" };
+
+        std::string layerNodes;
+        for (auto i = 0u; i < 2; ++i)
+        {
+            std::string layerChunks;
+            for (const auto& chunk : chunks)
+            {
+                layerChunks += (layerChunks.empty() ? "{ " : ", { ") + chunk + ", \"data\": " + data[i] + " }";
+            }
+            layerNodes += (i == 0 ? "{ " : ", { ") + encodings[i] + R"( "id": )" + std::to_string(i + 1)
+                + R"(, "name": "chunks", "type": "tilelayer", "width": 16, "height": 16, "x": 0, "y": 0,
+                "startx": 0, "starty": 0, "opacity": 1, "visible": true, "chunks": [ )" + layerChunks + " ] }";
+        }
+
+        const std::string json = R"({
+            "type": "map", "orientation": "orthogonal", "width": 16, "height": 16,
+            "tilewidth": 16, "tileheight": 16, "infinite": true, "tilesets": [],
+            "layers": [ )" + layerNodes + " ] }";
+
+        Map map;
+        map.setParseMode(mode);
+        map.setTileDecoding(decoding);
+        if (!TMX_CHECK(map.loadFromString(json, AssetPath)))
+        {
+            return;
+        }
+
+        const auto layers = getTileLayers(map);
+        if (!TMX_CHECK(layers.size() == 2))
+        {
+            return;
+        }
+
+        for (const auto* layer : layers)
+        {
+            const auto& layerChunks = layer->getChunks();
+            if (TMX_CHECK(layerChunks.size() == 1))
+            {
+                TMX_CHECK(layerChunks[0].tiles.size() == 1 && layerChunks[0].tiles[0].ID == 1);
+                TMX_CHECK(layer->getTile(0, 0).ID == 1);
+                TMX_CHECK(layer->getTile(16, 0).ID == 0);
+            }
+        }
+    }
+}
+
+int main()
+{
+    for (const auto& file : MapFiles)
+    {
+        testStorage(file, Map::TileDecoding::Eager);
+        testStorage(file, Map::TileDecoding::Lazy);
+    }
+
+    testInvalidChunks(Map::ParseMode::Document, Map::TileDecoding::Eager);
+    testInvalidChunks(Map::ParseMode::Document, Map::TileDecoding::Lazy);
+    testInvalidChunks(Map::ParseMode::Streaming, Map::TileDecoding::Eager);
+    testInvalidChunks(Map::ParseMode::Streaming, Map::TileDecoding::Lazy);
+
+    return tmx::test::result("TileStorageTests");
+}
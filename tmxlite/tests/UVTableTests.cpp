@@ -0,0 +1,160 @@
+/*********************************************************************
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#include "Test.hpp"
+
+#include <tmxlite/Map.hpp>
+#include <tmxlite/TileLayer.hpp>
+#include <tmxlite/UVTable.hpp>
+
+#include <cstdint>
+#include <string>
+
+using namespace tmx;
+
+namespace
+{
+    const std::string AssetPath = TEST_ASSETS_PATH;
+
+    //corners of the tile's area of the image
+    enum Corner
+    {
+        TopLeft, TopRight, BottomRight, BottomLeft
+    };
+
+    //the corner of the image shown at the top left, top right, bottom
+    //right and bottom left of the quad for each combination of flags
+    struct Variant final
+    {
+        std::uint8_t flags = 0;
+        Corner corners[4];
+    };
+
+    const std::uint8_t H = TileLayer::FlipFlag::Horizontal;
+    const std::uint8_t V = TileLayer::FlipFlag::Vertical;
+    const std::uint8_t D = TileLayer::FlipFlag::Diagonal;
+
+    const Variant Variants[] =
+    {
+        { 0, { TopLeft, TopRight, BottomRight, BottomLeft } },
+        { H, { TopRight, TopLeft, BottomLeft, BottomRight } },
+        { V, { BottomLeft, BottomRight, TopRight, TopLeft } },
+        { H | V, { BottomRight, BottomLeft, TopLeft, TopRight } }, //rotated 180
+        { D, { TopLeft, BottomLeft, BottomRight, TopRight } },
+        { D | H, { BottomLeft, TopLeft, TopRight, BottomRight } }, //rotated 90 clockwise
+        { D | V, { TopRight, BottomRight, BottomLeft, TopLeft } }, //rotated 90 anticlockwise
+        { D | H | V, { BottomRight, TopRight, TopLeft, BottomLeft } },
+    };
+
+    void checkQuad(const UVTable& table, std::uint32_t tileID, Vector2u position, Vector2u size, Vector2u imageSize)
+    {
+        const float u[2] =
+        {
+            static_cast<float>(position.x) / imageSize.x,
+            static_cast<float>(position.x + size.x) / imageSize.x
+        };
+        const float v[2] =
+        {
+            static_cast<float>(position.y) / imageSize.y,
+            static_cast<float>(position.y + size.y) / imageSize.y
+        };
+
+        for (const auto& variant : Variants)
+        {
+            //bits other than the flip flags are ignored
+            const std::uint8_t flagValues[] = { variant.flags, static_cast<std::uint8_t>(variant.flags | 0x1) };
+            for (auto flags : flagValues)
+            {
+                const auto* quad = table.getQuad(tileID, flags);
+                if (!TMX_CHECK(quad != nullptr)
+                    || !TMX_CHECK(quad == table.getData().data() + UVTable::getIndex(tileID, flags)))
+                {
+                    return;
+                }
+
+                bool matches = true;
+                for (auto i = 0u; i < 4; ++i)
+                {
+                    const auto corner = variant.corners[i];
+                    const auto x = (corner == TopRight || corner == BottomRight) ? 1 : 0;
+                    const auto y = (corner == BottomLeft || corner == BottomRight) ? 1 : 0;
+                    matches = matches && quad[i * 2] == u[x] && quad[i * 2 + 1] == v[y];
+                }
+
+                if (!TMX_CHECK(matches))
+                {
+                    std::cerr << "    tile: " << tileID << ", flags: " << int(flags) << std::endl;
+                }
+            }
+        }
+    }
+
+    void testMarginAndSpacing()
+    {
+        Map map;
+        if (!TMX_CHECK(map.load(AssetPath + "finite.json"))
+            || !TMX_CHECK(map.getTilesets().size() == 2))
+        {
+            return;
+        }
+
+        //30x20 tiles in 4 columns on a 128x64 image, with
+        //a margin of 1 and spacing of 2 between tiles
+        const auto& tileset = map.getTilesets()[1];
+        TMX_CHECK(tileset.getMargin() == 1 && tileset.getSpacing() == 2);
+
+        const UVTable table(tileset);
+        if (!TMX_CHECK(table.getTileCount() == 8)
+            || !TMX_CHECK(table.getData().size() == 8 * UVTable::VariantCount * UVTable::QuadSize))
+        {
+            return;
+        }
+
+        for (auto tileID = 0u; tileID < 8; ++tileID)
+        {
+            const Vector2u position(1 + (tileID % 4) * 32, 1 + (tileID / 4) * 22);
+            checkQuad(table, tileID, position, Vector2u(30, 20), Vector2u(128, 64));
+        }
+        TMX_CHECK(table.getQuad(8) == nullptr);
+
+        //16x16 tiles in 5 columns on an 80x64 image, with no margin or spacing
+        const UVTable external(map.getTilesets()[0]);
+        if (TMX_CHECK(external.getTileCount() == 20))
+        {
+            for (auto tileID = 0u; tileID < 20; ++tileID)
+            {
+                const Vector2u position((tileID % 5) * 16, (tileID / 5) * 16);
+                checkQuad(external, tileID, position, Vector2u(16, 16), Vector2u(80, 64));
+            }
+        }
+    }
+}
+
+int main()
+{
+    testMarginAndSpacing();
+
+    return tmx::test::result("UVTableTests");
+}